@@ -0,0 +1,193 @@
+
+// uinput loopback benchmark
+// Creates N virtual devices, injects MSC_SCAN + SYN_REPORT frames into each
+// at a controlled rate with UInputWriteEvent and reads them back through
+// the normal Device event path. Reports throughput, latency percentiles
+// and drops per run.
+//
+// usage: node dist/bench/uinput-loopback.js [--devices 4] [--rate 1000]
+//          [--duration 5] [--native] [--batched]
+//   --rate      frames per second per device
+//   --native    read with the native EventReader instead of fd streams
+//   --batched   inject the due frames of a device with writeEvents(), up to
+//               MAX_BATCH_FRAMES per write
+//
+// Needs read/write access to /dev/uinput and the created /dev/input nodes.
+// Latency is the time from an event's kernel timestamp (CLOCK_MONOTONIC)
+// to its 'event' listener.
+
+import { Device, Evdev, Event, InputCodes } from '../lib/index';
+import { UInput } from '../lib/uinput';
+import { openLoopback } from '../test/harness';
+
+const EV_SYN = InputCodes.getType('EV_SYN');
+const EV_MSC = InputCodes.getType('EV_MSC');
+const SYN_REPORT = InputCodes.getCode('SYN_REPORT');
+const MSC_SCAN = InputCodes.getCode('MSC_SCAN');
+const MAX_BATCH_FRAMES = 64;
+
+type Options = {
+  devices: number;
+  rate: number;
+  duration: number;
+  native: boolean;
+  batched: boolean;
+}
+
+type Loopback = {
+  uinput: UInput;
+  device: Device;
+  written: number;
+  received: number;
+  lost: number;
+  lastSeq: number;
+}
+
+function parseOptions(): Options {
+  const options: Options = {devices: 4, rate: 1000, duration: 5, native: false, batched: false};
+  const args = process.argv.slice(2);
+
+  for (let i = 0; i < args.length; i++) {
+    switch (args[i]) {
+      case '--devices': options.devices = parseInt(args[++i]); break;
+      case '--rate': options.rate = parseFloat(args[++i]); break;
+      case '--duration': options.duration = parseFloat(args[++i]); break;
+      case '--native': options.native = true; break;
+      case '--batched': options.batched = true; break;
+      default: throw new Error(`Unknown option ${args[i]}`);
+    }
+  }
+
+  return options;
+}
+
+function nowUs(): number {
+  return Number(process.hrtime.bigint() / BigInt(1000));
+}
+
+function percentile(sorted: Float64Array, q: number): number {
+  if (sorted.length === 0) return 0;
+  return sorted[Math.min(sorted.length - 1, Math.floor(q * sorted.length))];
+}
+
+async function createLoopbacks(evdev: Evdev, options: Options): Promise<Loopback[]> {
+  const loopbacks: Loopback[] = [];
+
+  for (let i = 0; i < options.devices; i++) {
+    const {uinput, device} = await openLoopback(evdev, `evdevjs loopback ${i}`);
+    loopbacks.push({uinput, device, written: 0, received: 0, lost: 0, lastSeq: 0});
+  }
+
+  return loopbacks;
+}
+
+function run(loopbacks: Loopback[], options: Options): Promise<Float64Array> {
+  const expected = Math.ceil(loopbacks.length * options.rate * options.duration);
+  const latencies = new Float64Array(expected);
+  let count = 0;
+
+  for (const loopback of loopbacks) {
+    loopback.device.useNativeReader(options.native);
+    loopback.device.on('event', (event: Event) => {
+      if (event.type !== EV_MSC || event.code !== MSC_SCAN) return;
+
+      const now = nowUs();
+      if (event.time && count < latencies.length) {
+        latencies[count++] = now - (event.time.tv_sec * 1e6 + event.time.tv_usec);
+      }
+
+      loopback.received++;
+      loopback.lost += event.value - loopback.lastSeq - 1;
+      loopback.lastSeq = event.value;
+    });
+    loopback.device.enableEvents(true);
+  }
+
+  const frames = new Int32Array(MAX_BATCH_FRAMES * 2 * UInput.EVENT_SIZE);
+  const scan = {type: EV_MSC, code: MSC_SCAN, value: 0};
+  const report = {type: EV_SYN, code: SYN_REPORT, value: 0};
+  const startUs = nowUs();
+  const endUs = startUs + options.duration * 1e6;
+
+  const writeBatched = (loopback: Loopback, due: number) => {
+    while (loopback.written < due) {
+      let length = 0;
+      for (let i = 0; i < MAX_BATCH_FRAMES && loopback.written < due; i++) {
+        frames.set([EV_MSC, MSC_SCAN, ++loopback.written, EV_SYN, SYN_REPORT, 0], length);
+        length += 2 * UInput.EVENT_SIZE;
+      }
+      loopback.uinput.writeEvents(frames.subarray(0, length));
+    }
+  };
+
+  return new Promise(resolve => {
+    const inject = () => {
+      const now = Math.min(nowUs(), endUs);
+      const due = Math.floor((now - startUs) * options.rate / 1e6);
+
+      for (const loopback of loopbacks) {
+        if (options.batched) {
+          writeBatched(loopback, due);
+          continue;
+        }
+
+        while (loopback.written < due) {
+          scan.value = ++loopback.written;
+          loopback.uinput.writeEvent(scan);
+          loopback.uinput.writeEvent(report);
+        }
+      }
+
+      if (now < endUs) {
+        setTimeout(inject, 1);
+      } else {
+        // let the last frames arrive
+        setTimeout(() => resolve(latencies.slice(0, count).sort()), 200);
+      }
+    };
+    inject();
+  });
+}
+
+function report(loopbacks: Loopback[], latencies: Float64Array, options: Options): void {
+  let written = 0, received = 0, lost = 0, dropped = 0, discarded = 0;
+  for (const loopback of loopbacks) {
+    const stats = loopback.device.getStats();
+    written += loopback.written;
+    received += loopback.received;
+    lost += loopback.lost + (loopback.written - loopback.lastSeq);
+    dropped += stats.dropped;
+    discarded += stats.discarded;
+  }
+
+  const reader = options.native ? 'native reader' : 'fd streams';
+  const write = options.batched ? 'writeEvents' : 'writeEvent';
+  console.log(`${loopbacks.length} devices x ${options.rate} frames/s for ${options.duration}s, ${reader}, ${write}`);
+  console.log(`  frames:      ${written} written, ${received} received, ${lost} lost`);
+  console.log(`  throughput:  ${(received / options.duration).toFixed(0)} frames/s`);
+  console.log(`  latency us:  p50 ${percentile(latencies, 0.5).toFixed(0)}` +
+    `  p99 ${percentile(latencies, 0.99).toFixed(0)}` +
+    `  p99.9 ${percentile(latencies, 0.999).toFixed(0)}` +
+    `  max ${percentile(latencies, 1).toFixed(0)}`);
+  console.log(`  SYN_DROPPED: ${dropped}, discarded: ${discarded}`);
+}
+
+async function main(): Promise<void> {
+  const options = parseOptions();
+  const evdev = new Evdev();
+
+  let loopbacks: Loopback[] = [];
+  try {
+    loopbacks = await createLoopbacks(evdev, options);
+    const latencies = await run(loopbacks, options);
+    report(loopbacks, latencies, options);
+  } finally {
+    loopbacks.forEach(loopback => loopback.uinput.close());
+    evdev.close();
+  }
+}
+
+main().catch(err => {
+  console.error(err);
+  process.exitCode = 1;
+});
@@ -2,7 +2,11 @@
   "targets": [
     {
       "target_name": "evdevjs",
-      "sources": [ "src/evdevjs.cc" ],
+      "sources": [ "src/evdevjs.cc", "src/event-reader.cc", "src/event-source.cc",
+                   "src/uinput-player.cc", "src/capture-writer.cc", "src/capture-reader.cc",
+                   "src/device-monitor.cc", "src/device-probe.cc", "src/probe-worker.cc",
+                   "src/touch-tracker.cc", "src/axis-pipeline.cc", "src/event-stats.cc",
+                   "src/event-remap.cc", "src/hotkey-matcher.cc", "src/event-coalescer.cc" ],
       'cflags': [
         '<!@(pkg-config --cflags libevdev)'
       ],
@@ -0,0 +1,133 @@
+// Axis state layout (int32 slots), shared with src/axis-pipeline.h
+const SEQUENCE = 0;
+const CHANGED = 1;
+const SEC = 2;
+const USEC = 3;
+const HEADER_SIZE = 8;
+const MAX_AXES = 32;
+
+/**
+ * Processing of one axis by the native pipeline, see Device.configureAxes().
+ * Values are normalized, i.e., fractions of the axis' half range, or of its
+ * whole range for unipolar axes. Unset options default to the absinfo.
+ */
+export type AxisOptions = {
+  // radius around the center reported as 0, default the absinfo flat
+  deadzone?: number;
+  // minimum change published, smaller changes never reach JS, default 0
+  hysteresis?: number;
+  // 0..1 weight of the previous value in an exponential average, default 0
+  smoothing?: number;
+  // calibrated raw range, default the absinfo minimum and maximum
+  min?: number;
+  max?: number;
+  // raw value normalized to 0, default the middle of the range
+  center?: number;
+  // normalize to [0, 1] from min, e.g., triggers, instead of [-1, 1]
+  unipolar?: boolean;
+  invert?: boolean;
+}
+
+/**
+ * Normalized float axes published by the native axis pipeline into a
+ * SharedArrayBuffer, one value per configured axis. The native reader
+ * updates the values in place once per SYN_REPORT in which an axis moved
+ * past its hysteresis; read them on 'axes' or poll them, e.g., per UI frame.
+ */
+export class AxisState {
+
+  readonly codes: number[];
+  readonly values: Float32Array;
+
+  private _header: Int32Array;
+  private _index: Map<number, number>;
+
+  constructor(codes: number[]) {
+    if (codes.length === 0 || codes.length > MAX_AXES) {
+      throw new Error(`Between 1 and ${MAX_AXES} axes can be processed`);
+    }
+
+    const buffer = new SharedArrayBuffer((HEADER_SIZE + codes.length) * Int32Array.BYTES_PER_ELEMENT);
+    this.codes = codes;
+    this.values = new Float32Array(buffer, HEADER_SIZE * Int32Array.BYTES_PER_ELEMENT, codes.length);
+    this._header = new Int32Array(buffer, 0, HEADER_SIZE);
+    this._index = new Map(codes.map((code, index) => [code, index]));
+  }
+
+  /**
+   * The whole state, header and values, as passed to the native pipeline.
+   */
+  get array(): Int32Array {
+    return new Int32Array(this._header.buffer);
+  }
+
+  /**
+   * Number of frames published, changes whenever values do.
+   */
+  get sequence(): number {
+    return Atomics.load(this._header, SEQUENCE) >>> 1;
+  }
+
+  /**
+   * Kernel timestamp of the last published frame.
+   */
+  get sec(): number {
+    return this.readHeader(SEC);
+  }
+
+  get usec(): number {
+    return this.readHeader(USEC);
+  }
+
+  /**
+   * The normalized value of an axis, NaN if it is not configured.
+   */
+  value(code: number): number {
+    const index = this._index.get(code);
+    if (index === undefined) return NaN;
+
+    for (;;) {
+      const sequence = this.beginRead();
+      const value = this.values[index];
+      if (Atomics.load(this._header, SEQUENCE) === sequence) return value;
+    }
+  }
+
+  /**
+   * True if the axis changed in the last published frame.
+   */
+  changed(code: number): boolean {
+    const index = this._index.get(code);
+    return index !== undefined && (this.readHeader(CHANGED) & (1 << index)) !== 0;
+  }
+
+  /**
+   * Copy the values of a single published frame, all axes consistent.
+   * @param values - optional array to reuse, of at least codes.length
+   * @returns the values, in configuration order
+   */
+  copyValues(values = new Float32Array(this.codes.length)): Float32Array {
+    for (;;) {
+      const sequence = this.beginRead();
+      values.set(this.values);
+      if (Atomics.load(this._header, SEQUENCE) === sequence) return values;
+    }
+  }
+
+  // The native reader writes a frame under a seqlock, the sequence being
+  // odd meanwhile: a read is retried until the sequence is even and
+  // unchanged across it.
+  private beginRead(): number {
+    let sequence: number;
+    while ((sequence = Atomics.load(this._header, SEQUENCE)) & 1) {}
+    return sequence;
+  }
+
+  private readHeader(slot: number): number {
+    for (;;) {
+      const sequence = this.beginRead();
+      const value = this._header[slot];
+      if (Atomics.load(this._header, SEQUENCE) === sequence) return value;
+    }
+  }
+}
@@ -0,0 +1,107 @@
+import { AbsInfo, Capability, EventDescriptor } from './device';
+
+/**
+ * Capabilities as returned natively by GetCapabilityBits().
+ */
+export type CapabilityBitsData = {
+  types: Uint8Array;
+  codes: (Uint8Array | null)[];
+  absInfo: Int32Array;
+}
+
+/**
+ * A device's capabilities as packed bitmaps, laid out like the kernel's
+ * EVIOCGBIT: a bitmap of the supported types and, per supported type,
+ * a bitmap of the supported codes. The absinfo of all EV_ABS codes is
+ * kept flat in a single Int32Array of ABS_INFO_SIZE records
+ *    [value, min, max, fuzz, flat, resolution]
+ * indexed by code. Lookups are bit tests; Capability objects are only
+ * built on demand by toCapabilities().
+ */
+export class CapabilityBits {
+  static readonly ABS_INFO_SIZE = 6;
+
+  private static readonly EV_ABS = 0x03;
+
+  readonly types: Uint8Array;
+  readonly codes: (Uint8Array | null)[];
+  readonly absInfo: Int32Array;
+
+  constructor(data: CapabilityBitsData) {
+    this.types = data.types;
+    this.codes = data.codes;
+    this.absInfo = data.absInfo;
+  }
+
+  hasType(type: number): boolean {
+    return testBit(this.types, type);
+  }
+
+  hasCode(type: number, code: number): boolean {
+    const codes = this.codes[type];
+    return codes ? testBit(codes, code) : false;
+  }
+
+  /**
+   * The absinfo of an EV_ABS code, undefined if the code is not supported.
+   */
+  getAbsInfo(code: number): AbsInfo | undefined {
+    if (!this.hasCode(CapabilityBits.EV_ABS, code)) return undefined;
+
+    const offset = code * CapabilityBits.ABS_INFO_SIZE;
+    const info = this.absInfo;
+    return {
+      value: info[offset],
+      min: info[offset + 1],
+      max: info[offset + 2],
+      fuzz: info[offset + 3],
+      flat: info[offset + 4],
+      resolution: info[offset + 5]
+    };
+  }
+
+  /**
+   * Call fn for each supported type, in ascending order.
+   */
+  forEachType(fn: (type: number) => void): void {
+    forEachBit(this.types, fn);
+  }
+
+  /**
+   * Call fn for each supported code of type, in ascending order.
+   */
+  forEachCode(type: number, fn: (code: number) => void): void {
+    const codes = this.codes[type];
+    if (codes) forEachBit(codes, fn);
+  }
+
+  toCapabilities(): Capability[] {
+    const capabilities: Capability[] = [];
+
+    this.forEachType(type => {
+      const events: EventDescriptor[] = [];
+      this.forEachCode(type, code => {
+        events.push(type === CapabilityBits.EV_ABS ? {code, absInfo: this.getAbsInfo(code)} : {code});
+      });
+      capabilities.push({type, events});
+    });
+
+    return capabilities;
+  }
+}
+
+function testBit(bits: Uint8Array, bit: number): boolean {
+  const byte = bit >> 3;
+  return bit >= 0 && byte < bits.length && (bits[byte] & (1 << (bit & 7))) !== 0;
+}
+
+function forEachBit(bits: Uint8Array, fn: (bit: number) => void): void {
+  for (let byte = 0; byte < bits.length; byte++) {
+    let value = bits[byte];
+    while (value !== 0) {
+      const low = value & -value;
+      fn(byte * 8 + 31 - Math.clz32(low));
+      value ^= low;
+    }
+  }
+}
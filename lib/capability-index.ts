@@ -0,0 +1,124 @@
+import { CapabilityBits } from './capability-bits';
+
+const TYPE_KEY = -1; // key of a type's own bitset, as opposed to its codes
+
+/**
+ * An inverted index from capabilities to items, e.g., devices. Each item
+ * gets a dense slot, reused once the item is removed; each type and each
+ * (type, code) gets a bitset of the slots of the items supporting it.
+ * Finding the items with a capability is then a scan of one bitset
+ * instead of a test of every item.
+ */
+export class CapabilityIndex<T> {
+  private _slots: Map<T, number>;
+  private _items: (T | undefined)[];
+  private _bits: (CapabilityBits | undefined)[];
+  private _free: number[];
+  private _words: number;
+  private _sets: Map<number, Uint32Array>;
+
+  constructor() {
+    this._slots = new Map();
+    this._items = [];
+    this._bits = [];
+    this._free = [];
+    this._words = 1;
+    this._sets = new Map();
+  }
+
+  get size(): number {
+    return this._slots.size;
+  }
+
+  has(item: T): boolean {
+    return this._slots.has(item);
+  }
+
+  /**
+   * Index item with capabilities bits, replacing any previous entry.
+   */
+  add(item: T, bits: CapabilityBits): void {
+    this.remove(item);
+
+    const slot = this._free.length > 0 ? this._free.pop()! : this._items.length;
+    while (slot >= this._words * 32) this.grow();
+
+    this._slots.set(item, slot);
+    this._items[slot] = item;
+    this._bits[slot] = bits;
+
+    bits.forEachType(type => {
+      this.set(key(type, TYPE_KEY), slot, true);
+      bits.forEachCode(type, code => this.set(key(type, code), slot, true));
+    });
+  }
+
+  remove(item: T): void {
+    const slot = this._slots.get(item);
+    if (slot === undefined) return;
+
+    const bits = this._bits[slot]!;
+    bits.forEachType(type => {
+      this.set(key(type, TYPE_KEY), slot, false);
+      bits.forEachCode(type, code => this.set(key(type, code), slot, false));
+    });
+
+    this._slots.delete(item);
+    this._items[slot] = undefined;
+    this._bits[slot] = undefined;
+    this._free.push(slot);
+  }
+
+  clear(): void {
+    this._slots.clear();
+    this._items = [];
+    this._bits = [];
+    this._free = [];
+    this._sets.clear();
+  }
+
+  /**
+   * The items supporting type, and code if given, in slot order.
+   */
+  find(type: number, code?: number): T[] {
+    const found: T[] = [];
+    const set = this._sets.get(key(type, code ?? TYPE_KEY));
+    if (!set) return found;
+
+    for (let word = 0; word < set.length; word++) {
+      let value = set[word];
+      while (value !== 0) {
+        const low = value & -value;
+        found.push(this._items[word * 32 + 31 - Math.clz32(low)]!);
+        value ^= low;
+      }
+    }
+    return found;
+  }
+
+  protected set(setKey: number, slot: number, value: boolean): void {
+    let set = this._sets.get(setKey);
+    if (!set) {
+      if (!value) return;
+      set = new Uint32Array(this._words);
+      this._sets.set(setKey, set);
+    }
+
+    const word = slot >>> 5;
+    const mask = 1 << (slot & 31);
+    set[word] = value ? set[word] | mask : set[word] & ~mask;
+  }
+
+  protected grow(): void {
+    this._words *= 2;
+    for (const [setKey, set] of this._sets) {
+      const grown = new Uint32Array(this._words);
+      grown.set(set);
+      this._sets.set(setKey, grown);
+    }
+  }
+}
+
+function key(type: number, code: number): number {
+  return type * 0x10000 + code + 1;
+}
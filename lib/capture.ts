@@ -0,0 +1,269 @@
+import { Device } from './device';
+import { Event } from './event';
+import { HandleIds } from './handle-ids';
+import { UInput } from './uinput';
+
+const evdevjs = require('bindings')('evdevjs.node')
+
+const READ_BATCH_SIZE = 1024;
+
+/**
+ * A device recorded in a capture file.
+ */
+export type CaptureDeviceInfo = {
+  index: number;
+  name: string;
+  bustype: number;
+  vendor: number;
+  product: number;
+  version: number;
+}
+
+export type CaptureInfo = {
+  devices: CaptureDeviceInfo[];
+  events: number;
+  // kernel timestamps of the first and last events, in microseconds
+  startUs: number;
+  endUs: number;
+}
+
+export type ReplayOptions = {
+  // playback rate relative to the recording, 0 or Infinity replays
+  // as fast as possible
+  speed?: number;
+  // capture time range to replay, in microseconds
+  fromUs?: number;
+  toUs?: number;
+}
+
+/**
+ * Records the raw events of devices, with a descriptor of each device
+ * (name, ids, capabilities, absinfo), to an append-only binary capture
+ * file. Events are captured in the native read path, whichever way the
+ * device is read, and written by a native thread with buffered I/O.
+ * A device's events are recorded while its events are being read.
+ */
+export class CaptureWriter {
+  private static IDS = new HandleIds();
+
+  private _id: number;
+  private _closed: boolean;
+
+  /**
+   * Create or truncate file and start recording.
+   * @param file - path of the capture file
+   */
+  constructor(file: string) {
+    this._id = CaptureWriter.IDS.allocate();
+
+    const result = evdevjs.NewCaptureWriter(this._id, file);
+    if (result < 0) {
+      CaptureWriter.IDS.release(this._id);
+      throw new Error(`Unable to create capture file ${file}, errno ${-result}`);
+    }
+    this._closed = false;
+  }
+
+  get id(): number {
+    return this._id;
+  }
+
+  /**
+   * Record the descriptor and, from now on, the events of device.
+   * @returns the device's index in the capture
+   */
+  add(device: Device): number {
+    return evdevjs.CaptureWriterAdd(this._id, device.id);
+  }
+
+  remove(device: Device): void {
+    evdevjs.CaptureWriterRemove(this._id, device.id);
+  }
+
+  /**
+   * Stop recording and flush all events to the file.
+   */
+  close(): void {
+    if (this._closed) return;
+
+    this._closed = true;
+    const result = evdevjs.ReleaseCaptureWriter(this._id);
+    CaptureWriter.IDS.release(this._id);
+    if (result < 0) throw new Error(`Unable to write capture file, errno ${-result}`);
+  }
+}
+
+/**
+ * Reads a capture file written by CaptureWriter. The file is memory-mapped
+ * and indexed by time on open, so any point of a long capture can be
+ * sought to directly.
+ *
+ * Events are read as tagged records (Event.TAGGED_RECORD_SIZE) whose tag
+ * is the capture index of the device, or replayed to Device listeners or
+ * uinput devices, e.g., a uinput cloned from a device set up with
+ * initDevice().
+ */
+export class CaptureReader {
+  private static IDS = new HandleIds();
+
+  private _id: number;
+  private _info: CaptureInfo;
+  private _records: Int32Array;
+  private _events: Int32Array;
+  private _replaying: boolean;
+  private _closed: boolean;
+
+  constructor(file: string) {
+    this._id = CaptureReader.IDS.allocate();
+
+    const result = evdevjs.NewCaptureReader(this._id, file);
+    if (result < 0) {
+      CaptureReader.IDS.release(this._id);
+      throw new Error(`Unable to read capture file ${file}, errno ${-result}`);
+    }
+
+    this._info = evdevjs.GetCaptureInfo(this._id);
+    this._records = new Int32Array(READ_BATCH_SIZE * Event.TAGGED_RECORD_SIZE);
+    this._events = new Int32Array(READ_BATCH_SIZE * UInput.EVENT_SIZE);
+    this._replaying = false;
+    this._closed = false;
+  }
+
+  get id(): number {
+    return this._id;
+  }
+
+  get info(): CaptureInfo {
+    return this._info;
+  }
+
+  get devices(): CaptureDeviceInfo[] {
+    return this._info.devices;
+  }
+
+  /**
+   * Set up device, e.g., a new Device from Evdev.newDevice(), with the
+   * name, ids and capabilities of a recorded device.
+   * @param index - capture index of the recorded device
+   * @param device - the device to set up
+   */
+  initDevice(index: number, device: Device): boolean {
+    return evdevjs.CaptureReaderInitDevice(this._id, index, device.id);
+  }
+
+  /**
+   * Move the read position to the first event at or after timeUs.
+   */
+  seek(timeUs: number): void {
+    evdevjs.CaptureReaderSeek(this._id, timeUs);
+  }
+
+  /**
+   * Read events from the read position as tagged records.
+   * @param records - receives up to records.length / Event.TAGGED_RECORD_SIZE events
+   * @param untilUs - optional time of the last event to read
+   * @returns the number of events read
+   */
+  read(records: Int32Array, untilUs?: number): number {
+    return untilUs === undefined ?
+      evdevjs.CaptureReaderRead(this._id, records) :
+      evdevjs.CaptureReaderRead(this._id, records, untilUs);
+  }
+
+  /**
+   * Replay the captured events, keeping their timing scaled by speed.
+   * Events of a recorded device are published to the listeners of a
+   * target Device or written to a target UInput. Events of devices
+   * without a target are skipped.
+   * @param targets - replay target by capture device index
+   * @param options - speed and time range
+   * @returns the number of events replayed
+   */
+  replay(targets: Map<number, Device | UInput>, options: ReplayOptions = {}): Promise<number> {
+    const speed = options.speed ?? 1;
+    const realtime = speed > 0 && isFinite(speed);
+    const fromUs = options.fromUs ?? this._info.startUs;
+    const toUs = Math.min(options.toUs ?? this._info.endUs, this._info.endUs);
+
+    this.seek(fromUs);
+    this._replaying = true;
+    const startUs = nowUs();
+    let replayed = 0;
+
+    return new Promise(resolve => {
+      const step = () => {
+        if (!this._replaying || this._closed) {
+          resolve(replayed);
+          return;
+        }
+
+        const untilUs = realtime ? Math.min(fromUs + (nowUs() - startUs) * speed, toUs) : toUs;
+        let count: number;
+        do {
+          count = this.read(this._records, untilUs);
+          this.dispatch(this._records, count, targets);
+          replayed += count;
+        } while (count === READ_BATCH_SIZE && realtime);
+
+        if (untilUs >= toUs && count < READ_BATCH_SIZE) {
+          this._replaying = false;
+          resolve(replayed);
+        } else if (realtime) {
+          setTimeout(step, 1);
+        } else {
+          setImmediate(step);
+        }
+      };
+      step();
+    });
+  }
+
+  /**
+   * Stop a replay in progress.
+   */
+  stop(): void {
+    this._replaying = false;
+  }
+
+  close(): void {
+    if (this._closed) return;
+
+    this._closed = true;
+    this._replaying = false;
+    evdevjs.ReleaseCaptureReader(this._id);
+    CaptureReader.IDS.release(this._id);
+  }
+
+  protected dispatch(records: Int32Array, count: number, targets: Map<number, Device | UInput>): void {
+    // consecutive events of a uinput target are written together
+    let uinput: UInput | undefined;
+    let length = 0;
+    const flush = () => {
+      if (uinput && length > 0) uinput.writeEvents(this._events.subarray(0, length));
+      length = 0;
+    };
+
+    for (let i = 0; i < count; i++) {
+      const offset = i * Event.TAGGED_RECORD_SIZE;
+      const target = targets.get(records[offset]);
+      if (!target) continue;
+
+      if ('writeEvents' in target) {
+        if (target !== uinput) {
+          flush();
+          uinput = target;
+        }
+        this._events[length++] = records[offset + 3];
+        this._events[length++] = records[offset + 4];
+        this._events[length++] = records[offset + 5];
+      } else {
+        target.publishEvent(Event.fromTaggedRecord(records, i));
+      }
+    }
+    flush();
+  }
+}
+
+function nowUs(): number {
+  return Number(process.hrtime.bigint() / BigInt(1000));
+}
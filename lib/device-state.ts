@@ -0,0 +1,78 @@
+import { InputCodes } from './input-codes';
+
+// State snapshot layout, shared with src/event-source.h
+const KEY_CNT = 0x300;
+const ABS_CNT = 0x40;
+const ABS_MT_TOUCH_MAJOR = 0x30;
+const MT_CODE_COUNT = 14; // ABS_MT_TOUCH_MAJOR..ABS_MT_TOOL_Y
+const MAX_SLOTS = 64;
+const DIRTY_ABS_OFFSET = KEY_CNT;
+const DIRTY_SLOT_OFFSET = KEY_CNT + ABS_CNT;
+const DIRTY_BITS = KEY_CNT + ABS_CNT + MAX_SLOTS;
+
+function testBit(bitmap: Uint8Array, bit: number): boolean {
+  return (bitmap[bit >> 3] & (1 << (bit & 7))) !== 0;
+}
+
+/**
+ * A snapshot of a device's key, axis and multi-touch slot state as
+ * tracked by libevdev, see Device.getState(). The arrays are reused by
+ * every snapshot so polling, e.g., once per UI frame, allocates nothing.
+ */
+export class DeviceState {
+  // bitmap of pressed keys, indexed by key code
+  readonly keys: Uint8Array;
+  // current value per abs code
+  readonly abs: Int32Array;
+  // MT values, slot-major, for codes ABS_MT_TOUCH_MAJOR..ABS_MT_TOOL_Y
+  readonly slots: Int32Array;
+  // bitmap of the keys, axes and slots changed since the previous snapshot
+  readonly dirty: Uint8Array;
+
+  numSlots: number;
+
+  constructor() {
+    this.keys = new Uint8Array(KEY_CNT / 8);
+    this.abs = new Int32Array(ABS_CNT);
+    this.slots = new Int32Array(MAX_SLOTS * MT_CODE_COUNT);
+    this.dirty = new Uint8Array(Math.ceil(DIRTY_BITS / 8));
+    this.numSlots = 0;
+  }
+
+  isKeyDown(code: InputCodes.EV_KEY_CODE): boolean {
+    return code < KEY_CNT && testBit(this.keys, code);
+  }
+
+  getAbsValue(code: InputCodes.EV_ABS_CODE): number {
+    return code < ABS_CNT ? this.abs[code] : 0;
+  }
+
+  /**
+   * Value of an ABS_MT_* code (other than ABS_MT_SLOT) in a slot.
+   */
+  getSlotValue(slot: number, code: InputCodes.EV_ABS_CODE): number {
+    const idx = code - ABS_MT_TOUCH_MAJOR;
+    if (slot < 0 || slot >= this.numSlots || idx < 0 || idx >= MT_CODE_COUNT) return 0;
+
+    return this.slots[slot * MT_CODE_COUNT + idx];
+  }
+
+  isKeyChanged(code: InputCodes.EV_KEY_CODE): boolean {
+    return code < KEY_CNT && testBit(this.dirty, code);
+  }
+
+  isAbsChanged(code: InputCodes.EV_ABS_CODE): boolean {
+    return code < ABS_CNT && testBit(this.dirty, DIRTY_ABS_OFFSET + code);
+  }
+
+  isSlotChanged(slot: number): boolean {
+    return slot >= 0 && slot < MAX_SLOTS && testBit(this.dirty, DIRTY_SLOT_OFFSET + slot);
+  }
+
+  /**
+   * True if anything changed since the previous snapshot.
+   */
+  isChanged(): boolean {
+    return this.dirty.some(byte => byte !== 0);
+  }
+}
@@ -0,0 +1,106 @@
+// Stats snapshot layout, shared with src/event-stats.h
+const EVENTS = 0;
+const FRAMES = 1;
+const DROPPED = 2;
+const SYNC_EVENTS = 3;
+const DISCARDED = 4;
+const CONSUMED = 5;
+const READS = 6;
+const LATENCY_COUNT = 7;
+const LATENCY_SUM_US = 8;
+const LATENCY_MAX_US = 9;
+const COUNTERS = 10;
+const BUCKETS = 24;
+
+/**
+ * A snapshot of the counters of a device's native read path, see
+ * Device.getStats(). Counters are totals since the device was opened.
+ *
+ * Batch sizes and latencies are kept as log2 histograms: bucket i counts
+ * values in [2^i, 2^(i+1)), bucket 0 also counts 0 and the last bucket
+ * everything above. Latency is the time in microseconds from an event's
+ * kernel timestamp (CLOCK_MONOTONIC) to its delivery to JS; events read
+ * through an EventRing are not measured.
+ */
+export class DeviceStats {
+  static readonly BUCKETS = BUCKETS;
+
+  // the raw snapshot, reused by every Device.getStats(stats)
+  readonly data: Float64Array;
+
+  constructor() {
+    this.data = new Float64Array(COUNTERS + 2 * BUCKETS);
+  }
+
+  // events read from the kernel, sync diffs included
+  get events(): number {
+    return this.data[EVENTS];
+  }
+
+  // SYN_REPORTs read
+  get frames(): number {
+    return this.data[FRAMES];
+  }
+
+  // SYN_DROPPED occurrences, i.e., kernel buffer overruns
+  get dropped(): number {
+    return this.data[DROPPED];
+  }
+
+  // events of the state diffs read after a SYN_DROPPED
+  get syncEvents(): number {
+    return this.data[SYNC_EVENTS];
+  }
+
+  // events read but rejected by the event filter
+  get discarded(): number {
+    return this.data[DISCARDED];
+  }
+
+  // events consumed natively, by forwarding, coalescing or the axis
+  // pipeline, see Device.forward(), Device.coalesce() and
+  // Device.configureAxes()
+  get consumed(): number {
+    return this.data[CONSUMED];
+  }
+
+  // drains of the device, each reading a batch of events
+  get reads(): number {
+    return this.data[READS];
+  }
+
+  get latencyCount(): number {
+    return this.data[LATENCY_COUNT];
+  }
+
+  get latencyMeanUs(): number {
+    return this.latencyCount > 0 ? this.data[LATENCY_SUM_US] / this.latencyCount : 0;
+  }
+
+  get latencyMaxUs(): number {
+    return this.data[LATENCY_MAX_US];
+  }
+
+  get batchSizes(): Float64Array {
+    return this.data.subarray(COUNTERS, COUNTERS + BUCKETS);
+  }
+
+  get latencies(): Float64Array {
+    return this.data.subarray(COUNTERS + BUCKETS, COUNTERS + 2 * BUCKETS);
+  }
+
+  /**
+   * Upper bound in microseconds of the latency at quantile q (0..1),
+   * as resolved by the histogram.
+   */
+  latencyQuantileUs(q: number): number {
+    const latencies = this.latencies;
+    const rank = q * this.latencyCount;
+    let count = 0;
+    for (let i = 0; i < BUCKETS - 1; i++) {
+      count += latencies[i];
+      if (count >= rank && count > 0) return 2 ** (i + 1);
+    }
+    return this.latencyMaxUs;
+  }
+}
@@ -2,13 +2,32 @@
 import {EventEmitter} from 'events';
 import * as fs from 'fs';
 import * as path from 'path';
+import { AxisOptions, AxisState } from './axis-state';
+import { CapabilityBits, CapabilityBitsData } from './capability-bits';
+import { DeviceState } from './device-state';
+import { DeviceStats } from './device-stats';
 import { Event } from './event';
+import { EventReader } from './event-reader';
+import { RemapRule } from './event-remap';
+import { EventRing } from './event-ring';
+import { EventStream, EventStreamOptions } from './event-stream';
+import { EventBatch } from './event-view';
+import { Frame } from './frame';
+import { Hotkey, HotkeyMatch, HotkeyOptions } from './hotkeys';
+import { TouchFrame } from './touch-frame';
+import { UInput } from './uinput';
 import {InputCodes} from "./input-codes";
 
 const evdevjs = require('bindings')('evdevjs.node') 
 
 const DEVICE_FILE_ACCESS_MODE = fs.constants.R_OK;
 const ARCH = process.arch.indexOf('64') >= 0 ? 64 : 32;
+const EVENT_BATCH_SIZE = 64; // max events drained per native call
+const DEFAULT_EVENT_RING_CAPACITY = 1024;
+const FRAME_BUFFER_SIZE = 4096; // int32 elements of packed frames per native call
+const TOUCH_FRAME_BUFFER_SIZE = 4096; // int32 elements of packed touch frames per native call
+const HOTKEY_BUFFER_SIZE = 1024; // int32 elements of packed hotkey matches per native call
+const DEFAULT_COALESCE_WINDOW_MS = 4;
 
 export const DEVICE_PROP = {
   "INPUT_PROP_POINTER": 0x00, /* needs a pointer */
@@ -43,6 +62,38 @@ export declare interface Capability {
   events: EventDescriptor[];
 }
 
+/**
+ * A device node opened and probed natively, see Evdev.loadDevicesAsync()
+ * and Evdev.watchDevices(). The descriptions, when present, are cached by
+ * the adopting Device.
+ */
+export type DeviceProbe = {
+  token: number;
+  info?: any;
+  capabilityBits?: CapabilityBitsData;
+  properties?: number[];
+}
+
+/**
+ * An open device handed over to another thread, see Device.detach()
+ * and Evdev.adoptDevice(). A plain object that can be posted to a
+ * worker_thread.
+ */
+export type DeviceTransfer = {
+  file: string;
+  token: number;
+}
+
+/**
+ * How a device's axis frames are coalesced, see Device.coalesce().
+ */
+export type CoalesceOptions = {
+  // time from the first frame merged to the frame passed on, in ms
+  windowMs?: number;
+  // frames merged into one at most, 0 for no limit
+  maxFrames?: number;
+}
+
 export declare interface Device {
   readonly id: number;
   readonly file: string;
@@ -59,6 +110,7 @@ export declare interface Device {
   hasProperty(property: DEVICE_PROP_CODE | DEVICE_PROP_NAME): boolean;
   
   readonly capabilities: Capability[];
+  readonly capabilityBits: CapabilityBits;
   hasCapability(type: InputCodes.EV_TYPE_CODE | InputCodes.EV_TYPE_NAME, code?: InputCodes.EV_CODE | InputCodes.EV_CODE_NAME): boolean;
   
   readonly grabbed: boolean;
@@ -71,15 +123,50 @@ export declare interface Device {
   areEventsEnabled(): boolean;
   publishTypedEvents(enabled: boolean): void;
   isPublishTypedEvents(): boolean;
+  useNativeReader(enabled: boolean): void;
+  isUsingNativeReader(): boolean;
+  publishFrames(enabled: boolean): void;
+  isPublishFrames(): boolean;
+  publishTouchFrames(enabled: boolean): void;
+  isPublishTouchFrames(): boolean;
+  setHotkeys(hotkeys: Map<string, Hotkey>, options?: HotkeyOptions): void;
+  clearHotkeys(): void;
+  openEventRing(capacity?: number): EventRing;
+  closeEventRing(): void;
+  events(options?: EventStreamOptions): EventStream;
+  getState(state?: DeviceState): DeviceState;
+  getStats(stats?: DeviceStats): DeviceStats;
+  forward(uinput: UInput, rules?: RemapRule[]): void;
+  stopForwarding(): void;
+  isForwarding(): boolean;
+  coalesce(options?: CoalesceOptions): void;
+  clearCoalescing(): void;
+  isCoalescing(): boolean;
+  setMultiplexed(multiplexed: boolean): boolean;
+  isMultiplexed(): boolean;
+  configureAxes(axes: Map<number | InputCodes.EV_CODE_NAME, AxisOptions>): AxisState;
+  clearAxes(): void;
+  readonly axes: AxisState | undefined;
+  filterEventType(type: InputCodes.EV_TYPE_CODE | InputCodes.EV_TYPE_NAME, accepted?: boolean): void;
+  filterEventCode(type: InputCodes.EV_TYPE_CODE | InputCodes.EV_TYPE_NAME, code: InputCodes.EV_CODE | InputCodes.EV_CODE_NAME, accepted?: boolean): void;
+  clearEventFilter(): void;
+  publishEvent(event: Event): void;
+  detach(): DeviceTransfer;
 
   close(): void;
 
   on(event: 'close', callback: (dev: Device) => void): void;
+  on(event: 'capabilities', callback: (dev: Device) => void): void;
   on(event: 'error', callback: (error: Error) => void): void;
+  on(event: 'frame', callback: (frame: Frame) => void): void;
+  on(event: 'touch', callback: (frame: TouchFrame) => void): void;
+  on(event: 'hotkey', callback: (match: HotkeyMatch) => void): void;
+  on(event: 'axes', callback: (axes: AxisState) => void): void;
+  on(event: 'batch', callback: (batch: EventBatch) => void): void;
   on<T extends InputCodes.EV_TYPE_NAME | 'event'>(topic: T, callback: (event: Event) => void): void;
 
-  removeListener(topic: InputCodes.EV_TYPE_NAME | 'event' | 'close' | 'error', fn: any): void;
-  removeAllListeners(topic?: InputCodes.EV_TYPE_NAME | 'event' | 'close' | 'error'): void;
+  removeListener(topic: InputCodes.EV_TYPE_NAME | 'event' | 'batch' | 'frame' | 'touch' | 'hotkey' | 'axes' | 'close' | 'error' | 'capabilities', fn: any): void;
+  removeAllListeners(topic?: InputCodes.EV_TYPE_NAME | 'event' | 'batch' | 'frame' | 'touch' | 'hotkey' | 'axes' | 'close' | 'error' | 'capabilities'): void;
 }
 
 export namespace DeviceFactory {
@@ -88,6 +175,15 @@ export namespace DeviceFactory {
     return new DeviceImpl(path);
   }
 
+  /**
+   * Create a device for a node already opened and probed natively.
+   * @param path - the device node
+   * @param probe - the native probe result
+   */
+  export function adopt(path: string, probe: DeviceProbe): Device {
+    return new DeviceImpl(path, probe);
+  }
+
   export function isDeviceFile(path: string) {
     let result = false;
     try {
@@ -148,26 +244,74 @@ export class DeviceImpl extends DeviceLike implements Device {
   
   private _eventsEnabled: boolean;
   private _publishTypedEvents: boolean;
+  private _publishFrames: boolean;
+  private _publishTouchFrames: boolean;
+  private _explicitFilter: boolean;
+  private _filterUpdatePending: boolean;
+  private _released: boolean;
+  private _useNativeReader: boolean;
+  private _requiredReaderMode: boolean | undefined;
+  private _reader: EventReader | undefined;
+  private _ring: EventRing | undefined;
+  private _eventStream: EventStream | undefined;
+  private _axes: AxisState | undefined;
+  private _forwarding: boolean;
+  private _forwardGrabbed: boolean;
+  private _forwardEventsEnabled: boolean;
+  private _coalescing: boolean;
+  private _multiplexed: boolean;
+  private _multiplexEventsEnabled: boolean;
+  private _axesSequence: number;
   private _capabilities: Capability[] | undefined;
+  private _capabilityBits: CapabilityBits | undefined;
+  private _properties: number[] | undefined;
   private _deviceInfo: any;
   private _grabbed: boolean;
   private _file: string | undefined;
   private _stream: fs.ReadStream | undefined;
+  private _eventRecords: Int32Array;
+  private _eventBatch: EventBatch;
+  private _frames: Int32Array | undefined;
+  private _touchFrames: Int32Array | undefined;
+  private _hotkeys: string[] | undefined;
+  private _hotkeyMatches: Int32Array | undefined;
 
   public toString = () => `Device {name: ${this.name}, file: ${this.file}}`;
 
-  constructor(file?: string) {
+  constructor(file?: string, probe?: DeviceProbe) {
     super();
 
     this._grabbed = false;
     this._eventsEnabled = false;
     this._publishTypedEvents = false;
+    this._publishFrames = false;
+    this._publishTouchFrames = false;
+    this._explicitFilter = false;
+    this._filterUpdatePending = false;
+    this._released = false;
+    this._useNativeReader = false;
+    this._axesSequence = 0;
+    this._forwarding = false;
+    this._forwardGrabbed = false;
+    this._forwardEventsEnabled = false;
+    this._coalescing = false;
+    this._multiplexed = false;
+    this._multiplexEventsEnabled = false;
     this._deviceInfo = newDeviceInfo();
+    this._eventRecords = new Int32Array(EVENT_BATCH_SIZE * Event.RECORD_SIZE);
+    this._eventBatch = new EventBatch();
 
-    evdevjs.NewLibevdev(this.id);
+    // the native handle is also freed if the device is collected without close()
+    evdevjs.NewLibevdev(this.id, this);
+
+    // keep the native event filter in line with the typed event subscriptions
+    this.on('newListener', () => this.scheduleFilterUpdate());
+    this.on('removeListener', () => this.scheduleFilterUpdate());
     
     this._file = file;
-    if (file) {
+    if (file && probe) {
+      this.adopt(probe);
+    } else if (file) {
       this.update();
     }
   }
@@ -188,20 +332,6 @@ export class DeviceImpl extends DeviceLike implements Device {
 
   protected update(): void {
     this.fd = fs.openSync(this.file, 'r');
-
-    const options = {
-      fd: this.fd,
-      flags: 'r+',
-      autoClose: true
-    };
-    
-    try {
-      this._stream = fs.createReadStream(this.file, options);
-    } catch(err) {
-      options.flags = 'r';
-      this._stream =fs.createReadStream(this.file, options);
-    }
-    this._stream.on("error", (err) => this.handleError(err));
  
     evdevjs.SetFD(this.id, this.fd);
 
@@ -212,6 +342,17 @@ export class DeviceImpl extends DeviceLike implements Device {
     }
   }
 
+  protected adopt(probe: DeviceProbe): void {
+    // the node was opened and probed with libevdev off the main thread
+    const fd = evdevjs.AdoptProbedDevice(probe.token, this.id);
+    if (fd < 0) throw new Error(`Device ${this.file} is not available`);
+    this.fd = fd;
+
+    this._deviceInfo = probe.info ?? evdevjs.GetDeviceInfo(this.id);
+    if (probe.capabilityBits) this._capabilityBits = new CapabilityBits(probe.capabilityBits);
+    this._properties = probe.properties;
+  }
+
   get name(): string {
     return this._deviceInfo.name ?? '';  
   }
@@ -275,6 +416,7 @@ export class DeviceImpl extends DeviceLike implements Device {
     }
 
     evdevjs.EnableEventType(this.id, typeCode, enabled);
+    this.invalidateCapabilities();
   }
 
   enableEventCode(type: InputCodes.EV_TYPE_CODE | InputCodes.EV_TYPE_NAME, code: InputCodes.EV_CODE | InputCodes.EV_CODE_NAME, enabled=true): void {
@@ -287,10 +429,12 @@ export class DeviceImpl extends DeviceLike implements Device {
           InputCodes.getCode(code as InputCodes.EV_CODE_NAME) as InputCodes.EV_CODE : code;
 
     evdevjs.EnableEventCode(this.id, typeCode, codeNum, enabled);
-
+    this.invalidateCapabilities();
   }
 
   get properties(): number[] {
+    if (this._properties) return this._properties;
+
     return Object.values(DEVICE_PROP).filter(code => this.hasProperty(code));
   }
 
@@ -300,6 +444,7 @@ export class DeviceImpl extends DeviceLike implements Device {
       code = DEVICE_PROP[property];
     }
 
+    this._properties = undefined;
     evdevjs.EnableProperty(this.id, code, enabled);
   }
 
@@ -308,6 +453,7 @@ export class DeviceImpl extends DeviceLike implements Device {
     if (typeof propertyCode === 'string') {
       propertyCode = DEVICE_PROP[propertyCode];
     }
+    if (this._properties) return this._properties.includes(propertyCode);
     return evdevjs.HasProperty(this.id, propertyCode);
   }
 
@@ -318,18 +464,39 @@ export class DeviceImpl extends DeviceLike implements Device {
     return this._capabilities;
   }
 
+  /**
+   * The capabilities as packed bitmaps, loaded once and cached until
+   * an event type or code is enabled or disabled.
+   */
+  get capabilityBits(): CapabilityBits {
+    if (!this._capabilityBits) {
+      this._capabilityBits = new CapabilityBits(evdevjs.GetCapabilityBits(this.id));
+    }
+    return this._capabilityBits;
+  }
+
   hasCapability(type: InputCodes.EV_TYPE_CODE | InputCodes.EV_TYPE_NAME, code?: InputCodes.EV_CODE | InputCodes.EV_CODE_NAME): boolean {
     let typeCode = type;
     if (typeof type === 'string') {
       typeCode = InputCodes.getType(type);
     }
-    const hasType = evdevjs.HasType(this.id, typeCode);
-    if (!hasType || !code) return hasType;
+    const bits = this.capabilityBits;
+    if (code === undefined) return bits.hasType(typeCode);
     
     let codeNum = typeof code === 'string' ?
           InputCodes.getCode(code as InputCodes.EV_CODE_NAME) as InputCodes.EV_CODE : code;
 
-    return evdevjs.HasCode(this.id, typeCode, codeNum);
+    return bits.hasCode(typeCode, codeNum);
+  }
+
+  /**
+   * Drop the cached capabilities and notify 'capabilities' listeners,
+   * e.g., a capability index, of the change.
+   */
+  protected invalidateCapabilities(): void {
+    this._capabilities = undefined;
+    this._capabilityBits = undefined;
+    this.emit('capabilities', this);
   }
 
   get grabbed(): boolean {
@@ -355,8 +522,26 @@ export class DeviceImpl extends DeviceLike implements Device {
   enableEvents(enabled = true): void {
     // nop if enabled unchanged
     if (this._eventsEnabled === enabled) return;
+    if (enabled) this.checkNotMultiplexed();
 
     this._eventsEnabled = enabled;
+    if (enabled) {
+      this.closeEventRing();
+    }
+
+    if (this._useNativeReader) {
+      if (enabled) {
+        this.startNativeReader();
+      } else {
+        this.stopNativeReader();
+      }
+      return;
+    }
+
+    if (enabled) {
+      this.openStream();
+    }
+    
     if (this._stream) {
       if (enabled) {
         this._stream!.on('readable', () => this.readAndProcessEvents());
@@ -372,21 +557,508 @@ export class DeviceImpl extends DeviceLike implements Device {
 
   publishTypedEvents(enabled: boolean): void {
     this._publishTypedEvents = enabled;
+    this.scheduleFilterUpdate();
   }
 
   isPublishTypedEvents(): boolean {
     return this._publishTypedEvents;
   }
 
+  /**
+   * Publish whole frames, the events up to and including each SYN_REPORT,
+   * as 'frame' instead of individual events. After a kernel buffer overrun
+   * (SYN_DROPPED) the device state diff is published as a resync frame.
+   * @param enabled - true to publish frames
+   */
+  publishFrames(enabled: boolean): void {
+    if (this._publishFrames === enabled) return;
+
+    const eventsEnabled = this._eventsEnabled;
+    this.enableEvents(false);
+    this._publishFrames = enabled;
+    this.scheduleFilterUpdate();
+    this.enableEvents(eventsEnabled);
+  }
+
+  isPublishFrames(): boolean {
+    return this._publishFrames;
+  }
+
+  /**
+   * Publish the multi-touch contacts of each SYN_REPORT as one 'touch'
+   * TouchFrame, tracked natively from libevdev's slot state, instead of
+   * individual events or frames. Only frames with contacts are published.
+   * @param enabled - true to publish touch frames
+   */
+  publishTouchFrames(enabled: boolean): void {
+    if (this._publishTouchFrames === enabled) return;
+
+    const eventsEnabled = this._eventsEnabled;
+    this.enableEvents(false);
+    this._publishTouchFrames = enabled;
+    this.enableEvents(eventsEnabled);
+  }
+
+  isPublishTouchFrames(): boolean {
+    return this._publishTouchFrames;
+  }
+
+  /**
+   * Match key presses against hotkeys natively and publish only the
+   * matches, as 'hotkey' with the hotkey's name and the frame of the
+   * press, instead of events or frames. The device is switched to the
+   * native reader, so a keyboard typing no hotkey costs no JS callbacks.
+   * Replaces any previous hotkeys.
+   * @param hotkeys - hotkeys by name
+   * @param options - the step timeout of sequences
+   */
+  setHotkeys(hotkeys: Map<string, Hotkey>, options: HotkeyOptions = {}): void {
+    this.checkNotMultiplexed();
+    const names = [...hotkeys.keys()];
+    const patterns = [...hotkeys.values()].map((hotkey, id) => ({id, steps: Hotkey.resolve(hotkey)}));
+    const stepTimeoutMs = options.stepTimeoutMs ?? Hotkey.DEFAULT_STEP_TIMEOUT_MS;
+    if (!evdevjs.SetHotkeys(this.id, patterns, stepTimeoutMs)) {
+      throw new Error('Invalid hotkeys');
+    }
+
+    const eventsEnabled = this._eventsEnabled;
+    this.enableEvents(false);
+    this._hotkeys = names;
+    this.requireNativeReader();
+    this.enableEvents(eventsEnabled);
+  }
+
+  /**
+   * Stop matching hotkeys, events are published as before, by the reader
+   * in use before setHotkeys().
+   */
+  clearHotkeys(): void {
+    if (!this._hotkeys) return;
+
+    const eventsEnabled = this._eventsEnabled;
+    this.enableEvents(false);
+    this._hotkeys = undefined;
+    evdevjs.SetHotkeys(this.id, [], 0);
+    this.releaseNativeReader();
+    this.enableEvents(eventsEnabled);
+  }
+
+  /**
+   * Read events on a native epoll thread instead of a fs.ReadStream.
+   * Events are drained by libevdev only; no bytes are read by node streams.
+   * Takes effect immediately if events are enabled.
+   * @param enabled - true to use the native reader
+   */
+  useNativeReader(enabled: boolean): void {
+    if (this._useNativeReader === enabled) return;
+
+    const eventsEnabled = this._eventsEnabled;
+    this.enableEvents(false);
+    this._useNativeReader = enabled;
+    this.enableEvents(eventsEnabled);
+  }
+
+  isUsingNativeReader(): boolean {
+    return this._useNativeReader;
+  }
+
+  /**
+   * Switch to the native reader for hotkeys, forwarding or coalescing,
+   * which are implemented by it. The mode in use before the first of them
+   * is restored by releaseNativeReader() once none is left.
+   */
+  protected requireNativeReader(): void {
+    if (this._requiredReaderMode === undefined) {
+      this._requiredReaderMode = this._useNativeReader;
+    }
+    this.useNativeReader(true);
+  }
+
+  protected releaseNativeReader(): void {
+    if (this._requiredReaderMode === undefined ||
+        this._hotkeys || this._forwarding || this._coalescing) return;
+
+    const enabled = this._requiredReaderMode;
+    this._requiredReaderMode = undefined;
+    this.useNativeReader(enabled);
+  }
+
+  /**
+   * Route this device's events into a SharedArrayBuffer ring written by
+   * the native reader thread. Listeners receive no events while the ring
+   * is open; enableEvents(true) or closeEventRing() ends ring mode.
+   * @param capacity - ring size in events, rounded up to a power of 2
+   * @returns the ring to poll for events
+   */
+  openEventRing(capacity = DEFAULT_EVENT_RING_CAPACITY): EventRing {
+    if (this._ring && !this._eventStream) return this._ring;
+
+    this.checkNotMultiplexed();
+    this.closeEventRing();
+    this.enableEvents(false);
+
+    const ring = EventRing.create(capacity);
+    this._reader = new EventReader((devId, records) => {
+      if (!records) this.handleError(new Error(`Unable to read events from ${this.file}`));
+    });
+    if (!this._reader.add(this, {ring})) {
+      this.stopNativeReader();
+      throw new Error('Unable to open event ring');
+    }
+
+    this._ring = ring;
+    return ring;
+  }
+
+  closeEventRing(): void {
+    if (!this._ring) return;
+
+    const stream = this._eventStream;
+    this._ring = undefined;
+    this._eventStream = undefined;
+    this.stopNativeReader();
+    if (stream) stream.end();
+  }
+
+  /**
+   * Iterate this device's events in batches, at the consumer's pace:
+   *
+   *    for await (const events of device.events()) ...
+   *
+   * The native reader thread queues the events in a bounded ring, like
+   * openEventRing(), and wakes the consumer only while it awaits events.
+   * Once highWaterMark events are queued, the overflow policy applies:
+   * by default the device is not read until the consumer catches up,
+   * dropOldest and dropNewest drop events, counted by the stream's
+   * dropped, and coalesce merges axis frames. Listeners receive no
+   * events while the stream is open; breaking out of the loop,
+   * enableEvents(true) or closeEventRing() end it.
+   * @param options - batch size, queue size and overflow policy
+   * @returns the stream, replacing any open stream or event ring
+   */
+  events(options: EventStreamOptions = {}): EventStream {
+    this.checkNotMultiplexed();
+    this.closeEventRing();
+    this.enableEvents(false);
+
+    const ring = EventRing.create(
+      options.highWaterMark ?? EventStream.DEFAULT_HIGH_WATER_MARK, options.overflow ?? 'block');
+    const stream = new EventStream(ring, options.batch ?? EventStream.DEFAULT_BATCH,
+      () => this._reader?.resume(this),
+      () => {
+        if (this._eventStream === stream) this.closeEventRing();
+      });
+
+    this._reader = new EventReader((devId, records) => {
+      if (records) {
+        stream.wake();
+      } else {
+        stream.fail(new Error(`Unable to read events from ${this.file}`));
+      }
+    });
+    if (!this._reader.add(this, {ring})) {
+      this.stopNativeReader();
+      throw new Error('Unable to open event stream');
+    }
+
+    this._ring = ring;
+    this._eventStream = stream;
+    return stream;
+  }
+
+  /**
+   * Snapshot the device's key, axis and MT slot state as tracked by libevdev,
+   * with a dirty bitmap of what changed since the previous snapshot.
+   * When nothing reads the device's events, neither events enabled nor a
+   * native reader (Evdev, an event ring, forwarding, hotkeys, coalescing)
+   * holding it, pending events are consumed by this call so the state is
+   * current without any event processing. A device held by a native reader is snapshotted as of the
+   * events its reader has read, without consuming any.
+   * @param state - optional snapshot to update in place
+   * @returns the updated snapshot
+   */
+  getState(state = new DeviceState()): DeviceState {
+    const pump = !this._eventsEnabled && !this._ring;
+    state.numSlots = evdevjs.GetState(this.id, pump, state.keys, state.abs, state.slots, state.dirty);
+    return state;
+  }
+
+  /**
+   * Snapshot the counters of the device's native read path: events,
+   * frames, SYN_DROPPED and discarded events, drains and delivery latency.
+   * Cheap enough to poll; pass stats to reuse its array.
+   */
+  getStats(stats = new DeviceStats()): DeviceStats {
+    evdevjs.GetStats(this.id, stats.data);
+    return stats;
+  }
+
+  /**
+   * Forward this device's events to a uinput device natively: the device
+   * is grabbed and read by the native reader thread, which remaps each
+   * frame by rules and writes it to uinput with a single write, without
+   * waking JS. Only the events of notify rules are still published.
+   * Replaces any previous forwarding.
+   * @param uinput - the uinput device to write to, e.g., one created with
+   *    Evdev.newUInputFromDevice(), closing it stops forwarding
+   * @param rules - the remap table, at most one rule per input code
+   */
+  forward(uinput: UInput, rules: RemapRule[] = []): void {
+    this.checkNotMultiplexed();
+    const resolved = rules.map(rule => RemapRule.resolve(rule));
+    if (!evdevjs.SetEventRemap(this.id, uinput.id, resolved)) {
+      throw new Error('Invalid remap rules');
+    }
+
+    if (!this._forwarding) {
+      this._forwardGrabbed = !this._grabbed && this.grab();
+      this._forwardEventsEnabled = this._eventsEnabled;
+    }
+    this._forwarding = true;
+    this.requireNativeReader();
+    this.enableEvents(true);
+  }
+
+  /**
+   * Stop forwarding; a grab taken by forward() is released and events and
+   * the reader are restored to what they were before forward().
+   */
+  stopForwarding(): void {
+    if (!this._forwarding) return;
+
+    this._forwarding = false;
+    evdevjs.SetEventRemap(this.id, null, []);
+    if (this._forwardGrabbed) this.ungrab();
+    this._forwardGrabbed = false;
+    this.enableEvents(this._forwardEventsEnabled);
+    this.releaseNativeReader();
+  }
+
+  isForwarding(): boolean {
+    return this._forwarding;
+  }
+
+  /**
+   * Coalesce high-rate axis frames, e.g., of an 8 kHz mouse, in the native
+   * read path: EV_REL deltas are summed and the latest value of each EV_ABS
+   * code (but the MT codes) is kept, one frame being published per window
+   * or maxFrames frames. Key, switch and other events are never merged,
+   * the motion so far is published ahead of them in their frame. The
+   * device is read by the native reader, which publishes the last frame
+   * of a burst once its window has passed. Replaces any previous options.
+   * @param options - window and frame limit, by default 4 ms
+   */
+  coalesce(options: CoalesceOptions = {}): void {
+    this.checkNotMultiplexed();
+    const windowMs = options.windowMs ?? DEFAULT_COALESCE_WINDOW_MS;
+    if (!evdevjs.SetCoalescing(this.id, Math.round(windowMs * 1000), options.maxFrames ?? 0)) {
+      throw new Error(`Invalid coalescing window ${windowMs}`);
+    }
+
+    this._coalescing = true;
+    this.requireNativeReader();
+  }
+
+  /**
+   * Stop coalescing, frames held are discarded. The reader in use before
+   * coalesce() is restored.
+   */
+  clearCoalescing(): void {
+    if (!this._coalescing) return;
+
+    this._coalescing = false;
+    evdevjs.SetCoalescing(this.id, null, 0);
+    this.releaseNativeReader();
+  }
+
+  isCoalescing(): boolean {
+    return this._coalescing;
+  }
+
+  /**
+   * Hand this device's events over to Evdev's multiplexed reader, or take
+   * them back, see Evdev.enableEvents(). A device has a single read path:
+   * while multiplexed, its event ring or stream is closed, its events are
+   * disabled and starting any other read path throws. Taking the events
+   * back restores them to what they were before. A device forwarding,
+   * matching hotkeys or coalescing keeps its own reader.
+   * @param multiplexed - true to hand the events over
+   * @returns false if the device keeps its own reader
+   */
+  setMultiplexed(multiplexed: boolean): boolean {
+    if (this._multiplexed === multiplexed) return true;
+
+    if (!multiplexed) {
+      this._multiplexed = false;
+      this.enableEvents(this._multiplexEventsEnabled);
+      return true;
+    }
+
+    if (this._forwarding || this._hotkeys || this._coalescing) return false;
+    this._multiplexEventsEnabled = this._eventsEnabled;
+    this.closeEventRing();
+    this.enableEvents(false);
+    this._multiplexed = true;
+    return true;
+  }
+
+  isMultiplexed(): boolean {
+    return this._multiplexed;
+  }
+
+  protected checkNotMultiplexed(): void {
+    if (this._multiplexed) {
+      throw new Error(`Events of ${this.file} are multiplexed by Evdev, see Evdev.enableEvents()`);
+    }
+  }
+
+  /**
+   * Process axes in the native read path into normalized floats: the
+   * events of the configured EV_ABS codes are consumed natively and their
+   * values published to the returned AxisState, with 'axes' emitted once
+   * per batch of published frames. Frames whose axis changes stay under
+   * the hysteresis are dropped natively; with the native reader they
+   * never wake JS. Replaces any previous configuration.
+   * @param axes - options by EV_ABS code
+   * @returns the state the values are published to
+   */
+  configureAxes(axes: Map<number | InputCodes.EV_CODE_NAME, AxisOptions>): AxisState {
+    const configs = [...axes].map(([code, options]) => ({
+      ...options,
+      code: typeof code === 'string' ? InputCodes.getCode(code) : code
+    }));
+
+    const state = new AxisState(configs.map(config => config.code));
+    if (!evdevjs.SetAxisPipeline(this.id, state.array, configs)) {
+      throw new Error(`Unable to process axes of ${this.file}`);
+    }
+
+    this._axes = state;
+    this._axesSequence = state.sequence;
+    return state;
+  }
+
+  /**
+   * Stop processing axes, their events are published as before.
+   */
+  clearAxes(): void {
+    if (!this._axes) return;
+
+    this._axes = undefined;
+    evdevjs.SetAxisPipeline(this.id, null, []);
+  }
+
+  get axes(): AxisState | undefined {
+    return this._axes;
+  }
+
+  protected publishAxes(): void {
+    if (!this._axes || !this._eventsEnabled) return;
+
+    const sequence = this._axes.sequence;
+    if (sequence === this._axesSequence) return;
+
+    this._axesSequence = sequence;
+    this.emit('axes', this._axes);
+  }
+
+  /**
+   * Accept or discard all events of a type in the native read path.
+   * The first call replaces the filter derived from typed event
+   * subscriptions with an explicit filter that initially accepts nothing.
+   * @param type - event type
+   * @param accepted - true to deliver the type's events
+   */
+  filterEventType(type: InputCodes.EV_TYPE_CODE | InputCodes.EV_TYPE_NAME, accepted = true): void {
+    let typeCode = type;
+    if (typeof type === 'string') {
+      typeCode = InputCodes.getType(type);
+    }
+
+    this.useExplicitFilter();
+    evdevjs.FilterEventType(this.id, typeCode, accepted);
+  }
+
+  /**
+   * Accept or discard a single event code in the native read path,
+   * see filterEventType().
+   * @param type - event type
+   * @param code - event code
+   * @param accepted - true to deliver the code's events
+   */
+  filterEventCode(type: InputCodes.EV_TYPE_CODE | InputCodes.EV_TYPE_NAME, code: InputCodes.EV_CODE | InputCodes.EV_CODE_NAME, accepted = true): void {
+    let typeCode = type;
+    if (typeof type === 'string') {
+      typeCode = InputCodes.getType(type);
+    }
+    
+    let codeNum = typeof code === 'string' ?
+          InputCodes.getCode(code as InputCodes.EV_CODE_NAME) as InputCodes.EV_CODE : code;
+
+    this.useExplicitFilter();
+    evdevjs.FilterEventCode(this.id, typeCode, codeNum, accepted);
+  }
+
+  /**
+   * Remove an explicit event filter, reverting to the filter derived
+   * from typed event subscriptions.
+   */
+  clearEventFilter(): void {
+    this._explicitFilter = false;
+    this.updateFilter();
+  }
+
+  protected useExplicitFilter(): void {
+    if (this._explicitFilter) return;
+
+    this._explicitFilter = true;
+    evdevjs.SetEventFilter(this.id, true);
+  }
+
+  protected scheduleFilterUpdate(): void {
+    if (this._filterUpdatePending || this._explicitFilter) return;
+
+    // listeners are added after 'newListener' is emitted
+    this._filterUpdatePending = true;
+    queueMicrotask(() => {
+      this._filterUpdatePending = false;
+      this.updateFilter();
+    });
+  }
+
+  /**
+   * When only typed events are published, no frames and no batches,
+   * discard natively the events of every type without a listener.
+   */
+  protected updateFilter(): void {
+    if (this._explicitFilter || this._released) return;
+
+    const filtered = this._publishTypedEvents && !this._publishFrames && this.listenerCount('batch') === 0;
+    evdevjs.SetEventFilter(this.id, filtered);
+    if (!filtered) return;
+
+    for (const typeName of Object.values(InputCodes.EV_TYPE)) {
+      if (this.listenerCount(typeName) > 0) {
+        evdevjs.FilterEventType(this.id, InputCodes.getType(typeName), true);
+      }
+    }
+  }
+
   close(): void {
     this.enableEvents(false);
+    this.closeEventRing();
+    this._released = true;
     evdevjs.ReleaseLibevdev(this.id);
     
-    if (this._stream) {
+    if (this._stream || this.hasFd()) {
       try {
-        this._stream.close();
-        this._stream.removeAllListeners();
-        this._stream = undefined;
+        if (this._stream) {
+          this._stream.close();
+          this._stream.removeAllListeners();
+          this._stream = undefined;
+        } else {
+          fs.closeSync(this.fd);
+        }
         this._fd = -1;
       } catch(err) {
         // do nothing
@@ -397,9 +1069,211 @@ export class DeviceImpl extends DeviceLike implements Device {
     }
   }
 
+  /**
+   * Hand the open device node and its libevdev state over to another
+   * thread, e.g., a worker_thread adopting it with Evdev.adoptDevice(),
+   * and close this device. The node stays open, and grabbed if it was,
+   * until the adopting device is closed.
+   * @returns the transfer to post to the adopting thread
+   */
+  detach(): DeviceTransfer {
+    this.enableEvents(false);
+    this.closeEventRing();
+
+    const token = evdevjs.DetachDevice(this.id, this.file);
+    if (token < 0) throw new Error(`Unable to detach device ${this.file}, errno ${-token}`);
+
+    const transfer = {file: this.file, token};
+    this.close();
+    return transfer;
+  }
+
+  protected openStream(): void {
+    if (this._stream || !this.hasFd()) return;
+
+    const options = {
+      fd: this.fd,
+      flags: 'r+',
+      autoClose: true
+    };
+    
+    try {
+      this._stream = fs.createReadStream(this.file, options);
+    } catch(err) {
+      options.flags = 'r';
+      this._stream =fs.createReadStream(this.file, options);
+    }
+    this._stream.on("error", (err) => this.handleError(err));
+  }
+
+  protected startNativeReader(): void {
+    if (this._reader) return;
+
+    this._reader = new EventReader((devId, records) => this.processEventRecords(records));
+    const options = {frames: this._publishFrames, touchFrames: this._publishTouchFrames, hotkeys: !!this._hotkeys};
+    if (!this._reader.add(this, options)) {
+      this.stopNativeReader();
+      this.handleError(new Error('Unable to start native reader'));
+    }
+  }
+
+  protected stopNativeReader(): void {
+    if (!this._reader) return;
+
+    this._reader.close();
+    this._reader = undefined;
+  }
+
+  protected processEventRecords(records: Int32Array | null): void {
+    if (!this._eventsEnabled) return;
+
+    if (!records) {
+      this.handleError(new Error(`Unable to read events from ${this.file}`));
+      return;
+    }
+
+    if (this._hotkeys) {
+      Hotkey.forEachMatch(records, records.length, (id, frame) => this.publishHotkey(id, frame));
+      return;
+    }
+
+    if (this._publishTouchFrames) {
+      TouchFrame.forEach(records, records.length, frame => this.publishTouchFrame(frame));
+      return;
+    }
+
+    if (this._publishFrames) {
+      Frame.forEach(records, records.length, frame => this.publishFrame(frame));
+      this.publishAxes();
+      return;
+    }
+
+    this.publishEventRecords(records, records.length / Event.RECORD_SIZE);
+    this.publishAxes();
+  }
+
   protected readAndProcessEvents(): void {
-    // native call to retrieve the next event
-    this.publishEvent(evdevjs.NextEvent(this.id));
+    if (this._hotkeys) {
+      this.readAndProcessHotkeys();
+      return;
+    }
+
+    if (this._publishTouchFrames) {
+      this.readAndProcessTouchFrames();
+      return;
+    }
+
+    if (this._publishFrames) {
+      this.readAndProcessFrames();
+      return;
+    }
+
+    // native call drains all pending events into _eventRecords,
+    // repeat while the batch comes back full
+    let count: number;
+    do {
+      count = evdevjs.NextEvents(this.id, this._eventRecords);
+      this.publishEventRecords(this._eventRecords, count);
+    } while (count === EVENT_BATCH_SIZE && this._eventsEnabled);
+    this.publishAxes();
+  }
+
+  protected readAndProcessFrames(): void {
+    if (!this._frames) {
+      this._frames = new Int32Array(FRAME_BUFFER_SIZE);
+    }
+
+    // native call assembles complete frames into _frames,
+    // repeat while frames remain that did not fit
+    let length: number;
+    do {
+      length = evdevjs.NextFrames(this.id, this._frames);
+      if (length < 0) {
+        this.handleError(new Error(`Unable to read frames from ${this.file}, errno ${-length}`));
+        return;
+      }
+      Frame.forEach(this._frames, length, frame => this.publishFrame(frame));
+    } while (length > 0 && this._eventsEnabled);
+    this.publishAxes();
+  }
+
+  protected readAndProcessTouchFrames(): void {
+    if (!this._touchFrames) {
+      this._touchFrames = new Int32Array(TOUCH_FRAME_BUFFER_SIZE);
+    }
+
+    let length: number;
+    do {
+      length = evdevjs.NextTouchFrames(this.id, this._touchFrames);
+      if (length < 0) {
+        this.handleError(new Error(`Unable to read touch frames from ${this.file}, errno ${-length}`));
+        return;
+      }
+      TouchFrame.forEach(this._touchFrames, length, frame => this.publishTouchFrame(frame));
+    } while (length > 0 && this._eventsEnabled);
+  }
+
+  protected readAndProcessHotkeys(): void {
+    if (!this._hotkeyMatches) {
+      this._hotkeyMatches = new Int32Array(HOTKEY_BUFFER_SIZE);
+    }
+
+    let length: number;
+    do {
+      length = evdevjs.NextHotkeys(this.id, this._hotkeyMatches);
+      Hotkey.forEachMatch(this._hotkeyMatches, length, (id, frame) => this.publishHotkey(id, frame));
+    } while (length > 0 && this._eventsEnabled);
+  }
+
+  /**
+   * Publish a hotkey match via "hotkey".
+   */
+  protected publishHotkey(id: number, frame: Frame): void {
+    if (this._eventsEnabled && this._hotkeys) {
+      this.emit('hotkey', {name: this._hotkeys[id], frame});
+    }
+  }
+
+  /**
+   * Publish a touch frame via "touch".
+   * @param frame
+   */
+  publishTouchFrame(frame: TouchFrame): void {
+    if (this._eventsEnabled) {
+      this.emit('touch', frame);
+    }
+  }
+
+  /**
+   * Publish a frame via "frame".
+   * @param frame
+   */
+  publishFrame(frame: Frame): void {
+    if (this._eventsEnabled) {
+      this.emit('frame', frame);
+    }
+  }
+
+  /**
+   * Publish count packed event records: as one EventBatch of flyweight
+   * views via "batch", then each as an Event via publishEvent(). Events
+   * are only materialised for their "event" or typed listeners.
+   */
+  protected publishEventRecords(records: Int32Array, count: number): void {
+    if (this._eventsEnabled && this.listenerCount('batch') > 0) {
+      this.emit('batch', this._eventBatch.reset(records, count));
+    }
+
+    const typed = this.isPublishTypedEvents();
+    if (!typed && this.listenerCount('event') === 0) return;
+
+    for (let i = 0; i < count && this._eventsEnabled; i++) {
+      if (typed) {
+        const typeName = InputCodes.getTypeName(records[i * Event.RECORD_SIZE + 2] as InputCodes.EV_TYPE_CODE);
+        if (!typeName || this.listenerCount(typeName) === 0) continue;
+      }
+      this.publishEvent(Event.fromRecord(records, i));
+    }
   }
 
   /**
@@ -418,8 +1292,7 @@ export class DeviceImpl extends DeviceLike implements Device {
   };
 
   protected loadCapabilities(): Capability[] {
-    let capabilities: Capability[] = [];
-    return capabilities;
+    return this.capabilityBits.toCapabilities();
   }
 }
 
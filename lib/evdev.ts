@@ -1,35 +1,76 @@
 
+import {EventEmitter} from 'events';
 import * as fs from 'fs';
 import * as path from 'path';
-import {Device, DeviceFactory} from './device';
+import { CapabilityIndex } from './capability-index';
+import {Device, DeviceFactory, DeviceTransfer} from './device';
+import { DeviceStats } from './device-stats';
+import { Event } from './event';
+import { EventReader } from './event-reader';
 import {InputCodes} from './input-codes';
 import { UInput, UInputFactory } from './uinput';
 
+const evdevjs = require('bindings')('evdevjs.node')
+
 type CloseDeviceCallbackFn = (device: Device) => void;
 type CloseUInputCallbackFn = (uinput: UInput) => void;
 
-class Evdev {
+export type DeviceFileFilter = RegExp | ((file: string)=>boolean);
+
+// native DeviceMonitor notifications
+const MONITOR_DEVICE_ADDED = 1;
+const MONITOR_DEVICE_REMOVED = 2;
+
+export type MultiplexOptions = {
+  // deliver the events of each wakeup ordered by kernel timestamp
+  // across devices, rather than grouped per device
+  sortByTime?: boolean;
+}
+
+/**
+ * Evdev emits:
+ *   'event' (event: Event, device: Device) - multiplexed events from all devices,
+ *           see enableEvents()
+ *   'error' (error: Error, device: Device)
+ *   'device-added' (device: Device) - a device was plugged in, see watchDevices()
+ *   'device-removed' (device: Device) - a device was unplugged and closed
+ */
+class Evdev extends EventEmitter {
+  private static MONITOR_ID = 1;
 
   private _devices: Device[];
+  private _deviceIndex: Map<number, Device>;
+  private _capabilityIndex: CapabilityIndex<Device>;
+  private _capabilitiesFn: (device: Device) => void;
   private _uinputs: UInput[];
   private _closeDeviceFn: CloseDeviceCallbackFn;
   private _closeUInputFn: CloseUInputCallbackFn;
+  private _reader: EventReader | undefined;
+  private _monitorId: number;
+  private _monitorFilter: DeviceFileFilter | undefined;
 
 
   constructor() {
+    super();
+
     this._devices = [];
+    this._deviceIndex = new Map();
+    this._capabilityIndex = new CapabilityIndex();
+    this._capabilitiesFn = (device: Device) => this._capabilityIndex.add(device, device.capabilityBits);
     this._closeDeviceFn = (device: Device) => this.removeDevice(device);
 
     this._uinputs = [];
     this._closeUInputFn = (uinput: UInput) => this.removeUInput(uinput);
+    this._monitorId = 0;
   }
 
-  loadDevices(dirPath: string, filter?: RegExp | ((file: string)=>boolean)): Device[] {
+  loadDevices(dirPath: string, filter?: DeviceFileFilter): Device[] {
     const files = 
       fs
         .readdirSync(dirPath, {withFileTypes: true})
         .filter((entry: fs.Dirent) => entry.isCharacterDevice())
-        .map((entry: fs.Dirent) => path.join(dirPath, entry.name));
+        .map((entry: fs.Dirent) => path.join(dirPath, entry.name))
+        .filter(file => matchesFilter(file, filter));
 
     for (const file of files) {
       try {
@@ -41,17 +82,67 @@ class Evdev {
     return this.devices;
   }
 
+  /**
+   * Like loadDevices() but the device nodes are opened and probed in
+   * parallel on native worker threads. The devices resolved have their
+   * info, capabilities and properties already loaded.
+   * @param dirPath - directory of device nodes
+   * @param filter - device files to accept
+   */
+  async loadDevicesAsync(dirPath: string, filter?: DeviceFileFilter): Promise<Device[]> {
+    const files =
+      (await fs.promises.readdir(dirPath, {withFileTypes: true}))
+        .filter((entry: fs.Dirent) => entry.isCharacterDevice())
+        .map((entry: fs.Dirent) => path.join(dirPath, entry.name))
+        .filter(file => matchesFilter(file, filter));
+
+    const probes = await evdevjs.ProbeDevices(files);
+    let next = 0;
+    try {
+      for (; next < probes.length; next++) {
+        const probe = probes[next];
+        // not an evdev node or not accessible
+        if (probe.token === undefined) continue;
+
+        if (this.findDeviceByFile(probe.path)) {
+          evdevjs.ReleaseProbedDevice(probe.token);
+          continue;
+        }
+
+        this.addDevice(DeviceFactory.adopt(probe.path, probe));
+      }
+    } finally {
+      // a failed adopt leaves the remaining nodes open, release them;
+      // a token already adopted is ignored
+      for (; next < probes.length; next++) {
+        if (probes[next].token !== undefined) evdevjs.ReleaseProbedDevice(probes[next].token);
+      }
+    }
+
+    return this.devices;
+  }
+
   openDevice(filePath: string): Device {
     const device = DeviceFactory.create(filePath);
-    this._devices.push(device);
-    device.on('close', (device: Device) => this.removeDevice(device))
+    this.addDevice(device);
+    return device;
+  }
+
+  /**
+   * Resume a device detached by another thread with Device.detach(),
+   * e.g., in a worker_thread that owns a set of devices and processes
+   * their events in parallel with the main thread.
+   * @param transfer - the transfer posted by the detaching thread
+   */
+  adoptDevice(transfer: DeviceTransfer): Device {
+    const device = DeviceFactory.adopt(transfer.file, {token: transfer.token});
+    this.addDevice(device);
     return device;
   }
 
   newDevice(): Device {
     const device = DeviceFactory.create();
-    this._devices.push(device);
-    device.on('close', (device: Device) => this.removeDevice(device))
+    this.addDevice(device);
     return device;
   }
 
@@ -60,8 +151,29 @@ class Evdev {
     return this._devices.filter(device => typeof device.name === 'string' && device.name.length > 0);
   }
 
+  /**
+   * The named devices supporting an event type, and code if given.
+   * Answered from a capability index kept up to date as devices are
+   * added, removed or have their capabilities changed.
+   */
   findDevicesWithCapability(type: InputCodes.EV_TYPE_CODE | InputCodes.EV_TYPE_NAME, code?: InputCodes.EV_CODE | InputCodes.EV_CODE_NAME): Device[] {
-    return this.devices.filter(device => device.hasCapability(type,code));
+    const typeCode = typeof type === 'string' ? InputCodes.getType(type) : type;
+    const codeNum = typeof code === 'string' ? InputCodes.getCode(code) : code;
+    if (typeCode < 0 || (codeNum !== undefined && codeNum < 0)) return [];
+
+    return this._capabilityIndex.find(typeCode, codeNum)
+      .filter(device => typeof device.name === 'string' && device.name.length > 0);
+  }
+
+  /**
+   * Snapshot the read path counters of every device, by device file.
+   */
+  getStats(): Map<string, DeviceStats> {
+    const stats = new Map<string, DeviceStats>();
+    this._devices.forEach(device => {
+      if (device.file) stats.set(device.file, device.getStats());
+    });
+    return stats;
   }
 
   newUInputFromDevice(device: Device): UInput {
@@ -71,11 +183,121 @@ class Evdev {
     return uinput;
   }
 
+  /**
+   * Multiplex the events of all devices, current and later opened, through
+   * a single native epoll reader thread. Events are emitted as 'event' on
+   * this Evdev with their device; per-device event streams are disabled,
+   * see Device.setMultiplexed(), and restored once multiplexing stops.
+   * Devices forwarding, matching hotkeys or coalescing keep their reader.
+   * @param enabled - true to start, false to stop multiplexing
+   * @param options - merge options
+   */
+  enableEvents(enabled = true, options: MultiplexOptions = {}): void {
+    if (this._reader) {
+      this._reader.close();
+      this._reader = undefined;
+      this._devices.forEach(device => device.setMultiplexed(false));
+    }
+    if (!enabled) return;
+
+    this._reader = new EventReader(
+      (devId, records) => this.processEventRecords(devId, records),
+      {merge: true, sortByTime: options.sortByTime});
+
+    this._devices.forEach(device => this.multiplexDevice(device));
+  }
+
+  areEventsEnabled(): boolean {
+    return !!this._reader;
+  }
+
+  /**
+   * Watch a device directory for hotplug. Nodes plugged in are opened and
+   * probed off the main thread, added to devices and emitted as
+   * 'device-added'. Unplugged devices are closed and emitted as
+   * 'device-removed'. Devices already present are not opened,
+   * see loadDevices().
+   * @param dirPath - directory to watch
+   * @param filter - device files to accept
+   */
+  watchDevices(dirPath = '/dev/input', filter?: DeviceFileFilter): void {
+    this.unwatchDevices();
+
+    const monitorId = Evdev.MONITOR_ID++;
+    const result = evdevjs.NewDeviceMonitor(monitorId, dirPath,
+      (kind: number, file: string, token: number) => this.processMonitorEvent(monitorId, kind, file, token));
+    if (result < 0) throw new Error(`Unable to watch ${dirPath}, errno ${-result}`);
+
+    this._monitorId = monitorId;
+    this._monitorFilter = filter;
+  }
+
+  unwatchDevices(): void {
+    if (!this._monitorId) return;
+
+    evdevjs.ReleaseDeviceMonitor(this._monitorId);
+    this._monitorId = 0;
+    this._monitorFilter = undefined;
+  }
+
+  isWatchingDevices(): boolean {
+    return this._monitorId > 0;
+  }
+
   close(): void {
+    this.unwatchDevices();
+    this.enableEvents(false);
     this._devices.forEach(device => {
       device.close();
     });
     this._devices = [];
+    this._deviceIndex.clear();
+    this._capabilityIndex.clear();
+  }
+
+  protected addDevice(device: Device): void {
+    this._devices.push(device);
+    this._deviceIndex.set(device.id, device);
+    device.on('close', (device: Device) => this.removeDevice(device))
+    device.on('capabilities', this._capabilitiesFn);
+    this._capabilityIndex.add(device, device.capabilityBits);
+
+    if (this._reader) {
+      this.multiplexDevice(device);
+    }
+  }
+
+  protected multiplexDevice(device: Device): void {
+    if (device.fd <= 0) return;
+
+    if (!device.setMultiplexed(true)) return;
+    if (!this._reader!.add(device)) device.setMultiplexed(false);
+  }
+
+  protected processMonitorEvent(monitorId: number, kind: number, file: string, token: number): void {
+    if (kind === MONITOR_DEVICE_ADDED) {
+      if (monitorId !== this._monitorId || this.findDeviceByFile(file) ||
+          !matchesFilter(file, this._monitorFilter)) {
+        evdevjs.ReleaseProbedDevice(token);
+        return;
+      }
+
+      const device = DeviceFactory.adopt(file, {token});
+      this.addDevice(device);
+      this.emit('device-added', device);
+    } else if (kind === MONITOR_DEVICE_REMOVED) {
+      const device = this.findDeviceByFile(file);
+      if (device) this.unplugDevice(device);
+    }
+  }
+
+  protected unplugDevice(device: Device): void {
+    device.close();
+    this.emit('device-removed', device);
+  }
+
+  protected findDeviceByFile(file: string): Device | undefined {
+    return this._devices.find(device => device.file === file);
   }
 
   protected removeDevice(device: Device): void {
@@ -83,7 +305,33 @@ class Evdev {
     if (idx > -1) {
       this._devices.splice(idx, 1);
     }
+    this._deviceIndex.delete(device.id);
+    this._capabilityIndex.remove(device);
     device.removeListener('close', this._closeDeviceFn);
+    device.removeListener('capabilities', this._capabilitiesFn);
+  }
+
+  protected processEventRecords(devId: number, records: Int32Array | null): void {
+    if (!records) {
+      const device = this._deviceIndex.get(devId);
+      if (!device) return;
+
+      // ENODEV, while watching treat it as unplugged ahead of inotify
+      if (this.isWatchingDevices()) {
+        this.unplugDevice(device);
+      } else if (this.listenerCount('error') > 0) {
+        this.emit('error', new Error(`Unable to read events from ${device.file}`), device);
+      }
+      return;
+    }
+
+    const count = records.length / Event.TAGGED_RECORD_SIZE;
+    for (let i = 0; i < count && this._reader; i++) {
+      const device = this._deviceIndex.get(records[i * Event.TAGGED_RECORD_SIZE]);
+      if (device) {
+        this.emit('event', Event.fromTaggedRecord(records, i), device);
+      }
+    }
   }
 
   protected get deviceCloseCallback(): CloseDeviceCallbackFn {
@@ -104,5 +352,9 @@ class Evdev {
 }
 
 
+function matchesFilter(file: string, filter?: DeviceFileFilter): boolean {
+  if (!filter) return true;
+  return filter instanceof RegExp ? filter.test(file) : filter(file);
+}
 
 export {Evdev};
@@ -0,0 +1,105 @@
+import { Device } from './device';
+import { EventRing } from './event-ring';
+import { HandleIds } from './handle-ids';
+
+const evdevjs = require('bindings')('evdevjs.node') 
+
+/**
+ * Receives the packed event records read from a device in one wakeup,
+ * or null when the device could not be read (e.g., it was unplugged).
+ * A device added with a ring receives no records, only an empty batch
+ * when the ring's consumer waits for events, see EventRing.wait().
+ * A device added with frames, touchFrames or hotkeys receives its packed
+ * frames (see Frame), touch frames (see TouchFrame) or hotkey matches
+ * (see Hotkey) instead.
+ * A merging reader passes devId 0 and tagged records from all devices.
+ */
+export type EventReaderCallbackFn = (devId: number, records: Int32Array | null) => void;
+
+export type EventReaderOptions = {
+  // deliver a single batch of tagged records (Event.TAGGED_RECORD_SIZE)
+  // for all devices read in a wakeup
+  merge?: boolean;
+  // merge-sort a merged batch by kernel timestamp
+  sortByTime?: boolean;
+}
+
+export type EventReaderSourceOptions = {
+  // write the device's events to this ring instead of the callback
+  ring?: EventRing;
+  // deliver the device's events as packed frames
+  frames?: boolean;
+  // deliver the device's MT contacts as packed touch frames
+  touchFrames?: boolean;
+  // deliver only the device's hotkey matches, see Hotkey.forEachMatch()
+  hotkeys?: boolean;
+}
+
+// native EventReader flags
+const READER_MERGE = 1;
+const READER_SORT_BY_TIME = 2;
+
+// native read modes
+const READ_EVENTS = 0;
+const READ_FRAMES = 1;
+const READ_TOUCH_FRAMES = 2;
+const READ_HOTKEYS = 3;
+
+/**
+ * A native reader thread that epolls the fds of its devices and drains
+ * their events with libevdev, independent of the node event loop.
+ * Event batches are delivered to the callback on the main thread.
+ */
+export class EventReader {
+  private static IDS = new HandleIds();
+
+  private _id: number;
+  private _closed: boolean;
+
+  constructor(callback: EventReaderCallbackFn, options: EventReaderOptions = {}) {
+    this._id = EventReader.IDS.allocate();
+    this._closed = false;
+
+    let flags = 0;
+    if (options.merge) flags |= READER_MERGE;
+    if (options.merge && options.sortByTime) flags |= READER_SORT_BY_TIME;
+    evdevjs.NewEventReader(this._id, callback, flags);
+  }
+
+  get id(): number {
+    return this._id;
+  }
+
+  /**
+   * Start reading events from device.
+   * @param device - the device to read
+   * @param options - how the device's events are delivered
+   */
+  add(device: Device, options: EventReaderSourceOptions = {}): boolean {
+    if (options.ring) return evdevjs.EventReaderAdd(this._id, device.id, options.ring.array);
+
+    const mode = options.hotkeys ? READ_HOTKEYS :
+      options.touchFrames ? READ_TOUCH_FRAMES : options.frames ? READ_FRAMES : READ_EVENTS;
+    return evdevjs.EventReaderAdd(this._id, device.id, mode);
+  }
+
+  remove(device: Device): boolean {
+    return evdevjs.EventReaderRemove(this._id, device.id);
+  }
+
+  /**
+   * Resume reading device once room was made in its ring, after the
+   * ring reported blocked.
+   */
+  resume(device: Device): boolean {
+    return evdevjs.EventReaderResume(this._id, device.id);
+  }
+
+  close(): void {
+    if (this._closed) return;
+
+    this._closed = true;
+    evdevjs.ReleaseEventReader(this._id);
+    EventReader.IDS.release(this._id);
+  }
+}
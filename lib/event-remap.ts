@@ -0,0 +1,57 @@
+import { InputCodes } from './input-codes';
+
+/**
+ * Rule of a remap table, see Device.forward(). Applies to the events of
+ * one input type and code; events without a rule are forwarded unchanged.
+ *
+ * Examples:
+ *    {type: 'EV_KEY', code: 'KEY_CAPSLOCK', toCode: 'KEY_LEFTCTRL'}
+ *    {type: 'EV_ABS', code: 'ABS_Y', invert: true}
+ *    {type: 'EV_ABS', code: 'ABS_X', toCode: 'ABS_Y'} with its converse to swap axes
+ *    {type: 'EV_REL', code: 'REL_WHEEL', scale: 3}
+ *    {type: 'EV_KEY', code: 'KEY_F12', drop: true, notify: true}
+ */
+export type RemapRule = {
+  type: InputCodes.EV_TYPE_CODE | InputCodes.EV_TYPE_NAME;
+  code: InputCodes.EV_CODE | InputCodes.EV_CODE_NAME;
+  // output type and code, the input's by default
+  toType?: InputCodes.EV_TYPE_CODE | InputCodes.EV_TYPE_NAME;
+  toCode?: InputCodes.EV_CODE | InputCodes.EV_CODE_NAME;
+  // output value = round(value * scale + offset), default 1 and 0
+  scale?: number;
+  offset?: number;
+  // EV_ABS values are mirrored within the input axis' absinfo range,
+  // EV_KEY presses and releases swapped, other values negated
+  invert?: boolean;
+  // not forwarded
+  drop?: boolean;
+  // also published to the device's listeners, as read
+  notify?: boolean;
+}
+
+export namespace RemapRule {
+
+  /**
+   * Resolve the names and defaults of rule as expected natively.
+   */
+  export function resolve(rule: RemapRule): object {
+    const type = typeof rule.type === 'string' ? InputCodes.getType(rule.type) : rule.type;
+    const code = typeof rule.code === 'string' ? InputCodes.getCode(rule.code) : rule.code;
+    const toType = rule.toType === undefined ? type :
+      typeof rule.toType === 'string' ? InputCodes.getType(rule.toType) : rule.toType;
+    const toCode = rule.toCode === undefined ? code :
+      typeof rule.toCode === 'string' ? InputCodes.getCode(rule.toCode) : rule.toCode;
+
+    return {
+      type,
+      code,
+      toType,
+      toCode,
+      scale: rule.scale ?? 1,
+      offset: rule.offset ?? 0,
+      invert: rule.invert ?? false,
+      drop: rule.drop ?? false,
+      notify: rule.notify ?? false
+    };
+  }
+}
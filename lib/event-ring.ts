@@ -0,0 +1,192 @@
+import { Event } from './event';
+
+// Ring header layout (int32 slots), shared with src/event-ring.h
+const HEAD = 0;
+const TAIL = 1;
+const CAPACITY = 2;
+const OVERFLOW = 3;
+const POLICY = 4;
+const WAITING = 5;
+const BLOCKED = 6;
+const HEADER_SIZE = 8;
+
+/**
+ * What the native producer does when the ring is full:
+ *  - dropNewest: the events that do not fit are dropped
+ *  - dropOldest: the oldest events are overwritten
+ *  - block: the device is not read until the consumer makes room, the
+ *    kernel queue holds its events meanwhile (and drops them with
+ *    SYN_DROPPED if it overruns too)
+ *  - coalesce: relative and absolute axis frames are merged natively
+ *    until there is room, key and switch events are never merged
+ * Dropped events are counted by overflows.
+ */
+export type EventRingOverflow = 'dropNewest' | 'block' | 'dropOldest' | 'coalesce';
+
+// native policies, in the order of src/event-ring.h
+const POLICIES: EventRingOverflow[] = ['dropNewest', 'block', 'dropOldest', 'coalesce'];
+
+/**
+ * Called for each event in the ring. The event's packed record
+ * [tv_sec, tv_usec, type, code, value] starts at records[offset].
+ */
+export type EventRingVisitorFn = (records: Int32Array, offset: number) => void;
+
+/**
+ * A single-producer/single-consumer ring of packed event records in a
+ * SharedArrayBuffer. The native reader thread writes events for a device
+ * into the ring; JS polls it, e.g., once per frame, reading events in place
+ * without per-event allocation or native calls.
+ *
+ * The ring may be consumed from a worker by passing ring.buffer to it
+ * and constructing `new EventRing(buffer)` there. Only one consumer
+ * may read a ring.
+ */
+export class EventRing {
+
+  private _header: Int32Array;
+  private _records: Int32Array;
+  private _capacity: number;
+
+  /**
+   * Create a ring with room for capacity events, rounded up to a power of 2.
+   * @param capacity - number of events
+   * @param overflow - what happens to events when the ring is full
+   */
+  static create(capacity: number, overflow: EventRingOverflow = 'dropNewest'): EventRing {
+    let size = 1;
+    while (size < capacity) size *= 2;
+
+    const buffer = new SharedArrayBuffer(
+      (HEADER_SIZE + size * Event.RECORD_SIZE) * Int32Array.BYTES_PER_ELEMENT);
+    const header = new Int32Array(buffer, 0, HEADER_SIZE);
+    header[CAPACITY] = size;
+    header[POLICY] = POLICIES.indexOf(overflow);
+    if (header[POLICY] < 0) throw new Error(`Unknown overflow policy ${overflow}`);
+
+    return new EventRing(buffer);
+  }
+
+  constructor(buffer: SharedArrayBuffer) {
+    this._header = new Int32Array(buffer, 0, HEADER_SIZE);
+    this._capacity = this._header[CAPACITY];
+    this._records =
+      new Int32Array(buffer, HEADER_SIZE * Int32Array.BYTES_PER_ELEMENT, this._capacity * Event.RECORD_SIZE);
+  }
+
+  /**
+   * The whole ring, header and records, as passed to the native producer.
+   */
+  get array(): Int32Array {
+    return new Int32Array(this.buffer);
+  }
+
+  get buffer(): SharedArrayBuffer {
+    return this._header.buffer as SharedArrayBuffer;
+  }
+
+  get capacity(): number {
+    return this._capacity;
+  }
+
+  /**
+   * Number of events written but not yet consumed.
+   */
+  get available(): number {
+    return (Atomics.load(this._header, HEAD) - Atomics.load(this._header, TAIL)) >>> 0;
+  }
+
+  /**
+   * Number of events dropped because the ring was full when the
+   * producer wrote them, i.e., the consumer lagged.
+   */
+  get overflows(): number {
+    return Atomics.load(this._header, OVERFLOW) >>> 0;
+  }
+
+  get overflow(): EventRingOverflow {
+    return POLICIES[this._header[POLICY]];
+  }
+
+  /**
+   * True while the reader holds events back until the consumer makes
+   * room, see EventReader.resume().
+   */
+  get blocked(): boolean {
+    return Atomics.load(this._header, BLOCKED) !== 0;
+  }
+
+  /**
+   * Ask the producer to wake the consumer, through its EventReader's
+   * callback, once it writes events.
+   * @returns false if events are available already, there is nothing to wait for
+   */
+  wait(): boolean {
+    Atomics.store(this._header, WAITING, 1);
+    if (this.available === 0) return true;
+
+    Atomics.store(this._header, WAITING, 0);
+    return false;
+  }
+
+  /**
+   * Visit every available event in place and mark them consumed.
+   * With the dropOldest policy, events overwritten during the visit may
+   * be visited torn; use read() instead.
+   * @param visitor - called with the records array and the offset of each event
+   * @param max - optional maximum number of events to consume
+   * @returns the number of events consumed
+   */
+  consume(visitor: EventRingVisitorFn, max = Number.MAX_SAFE_INTEGER): number {
+    const tail = Atomics.load(this._header, TAIL);
+    const head = Atomics.load(this._header, HEAD);
+    const count = Math.min((head - tail) >>> 0, max);
+    const mask = this._capacity - 1;
+
+    for (let i = 0; i < count; i++) {
+      visitor(this._records, ((tail + i) & mask) * Event.RECORD_SIZE);
+    }
+
+    this.commit(tail, count);
+    return count;
+  }
+
+  /**
+   * Copy up to records.length / Event.RECORD_SIZE available events into
+   * records and mark them consumed.
+   * @returns the number of events copied
+   */
+  read(records: Int32Array): number {
+    const mask = this._capacity - 1;
+
+    while (true) {
+      const tail = Atomics.load(this._header, TAIL);
+      const head = Atomics.load(this._header, HEAD);
+      const count = Math.min((head - tail) >>> 0, Math.floor(records.length / Event.RECORD_SIZE));
+
+      for (let i = 0; i < count; i++) {
+        const offset = ((tail + i) & mask) * Event.RECORD_SIZE;
+        for (let j = 0; j < Event.RECORD_SIZE; j++) {
+          records[i * Event.RECORD_SIZE + j] = this._records[offset + j];
+        }
+      }
+
+      // the producer moved tail, overwriting what was copied: copy again
+      if (Atomics.compareExchange(this._header, TAIL, tail, (tail + count) | 0) === tail) return count;
+    }
+  }
+
+  /**
+   * Mark count events from tail consumed. A dropOldest producer may have
+   * moved tail meanwhile, it is then only moved further.
+   */
+  protected commit(tail: number, count: number): void {
+    const end = (tail + count) | 0;
+    let expected = tail;
+    while (true) {
+      const seen = Atomics.compareExchange(this._header, TAIL, expected, end);
+      if (seen === expected || ((seen - end) | 0) >= 0) return;
+      expected = seen;
+    }
+  }
+}
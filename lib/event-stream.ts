@@ -0,0 +1,153 @@
+import { Event } from './event';
+import { EventRing, EventRingOverflow } from './event-ring';
+
+export type EventStreamOptions = {
+  // events per batch at most
+  batch?: number;
+  // events queued natively at most, rounded up to a power of 2
+  highWaterMark?: number;
+  // what happens to the device's events once highWaterMark are queued,
+  // by default the device is not read until the consumer catches up
+  overflow?: EventRingOverflow;
+}
+
+type PendingNext = {
+  resolve: (result: IteratorResult<Event[]>) => void;
+  reject: (error: Error) => void;
+}
+
+/**
+ * A device's events as an async iterable of batches, see Device.events().
+ * The native reader thread queues the events in a bounded EventRing; a
+ * consumer awaiting the next batch is woken once, when events arrive, and
+ * otherwise reads the ring without native calls. A slow consumer never
+ * grows the queue past its high water mark: the overflow policy applies
+ * and dropped counts the events lost to it.
+ *
+ *    for await (const events of device.events({overflow: 'coalesce'})) ...
+ *
+ * Breaking out of the loop, return() or Device.closeEventRing() end the
+ * stream; a read error rejects the pending next().
+ */
+export class EventStream implements AsyncIterableIterator<Event[]> {
+  static readonly DEFAULT_BATCH = 64;
+  static readonly DEFAULT_HIGH_WATER_MARK = 1024;
+
+  private _ring: EventRing;
+  private _records: Int32Array;
+  private _resume: () => void;
+  private _close: () => void;
+  private _waiting: PendingNext[];       // next() calls waiting for events, oldest first
+  private _error: Error | undefined;
+  private _done: boolean;
+
+  /**
+   * @param ring - the ring the device's events are queued to
+   * @param batch - events per batch at most
+   * @param resume - resumes the reader once the ring reports blocked
+   * @param close - stops queueing events to the ring
+   */
+  constructor(ring: EventRing, batch: number, resume: () => void, close: () => void) {
+    this._ring = ring;
+    this._records = new Int32Array(Math.max(1, batch) * Event.RECORD_SIZE);
+    this._resume = resume;
+    this._close = close;
+    this._waiting = [];
+    this._done = false;
+  }
+
+  get ring(): EventRing {
+    return this._ring;
+  }
+
+  /**
+   * Number of events dropped, or overwritten, because the queue was full.
+   */
+  get dropped(): number {
+    return this._ring.overflows;
+  }
+
+  get done(): boolean {
+    return this._done;
+  }
+
+  [Symbol.asyncIterator](): AsyncIterableIterator<Event[]> {
+    return this;
+  }
+
+  next(): Promise<IteratorResult<Event[]>> {
+    if (this._error) return Promise.reject(this._error);
+    if (this._done) return Promise.resolve({done: true, value: undefined});
+
+    // a consumer calling ahead waits its turn
+    const events = this._waiting.length === 0 ? this.read() : undefined;
+    if (events) return Promise.resolve({done: false, value: events});
+
+    return new Promise((resolve, reject) => {
+      this._waiting.push({resolve, reject});
+    });
+  }
+
+  return(): Promise<IteratorResult<Event[]>> {
+    this.end();
+    return Promise.resolve({done: true, value: undefined});
+  }
+
+  /**
+   * Called as the reader writes events for a waiting consumer.
+   */
+  wake(): void {
+    while (this._waiting.length > 0 && !this._done) {
+      const events = this.read();
+      if (!events) return;
+
+      this._waiting.shift()!.resolve({done: false, value: events});
+    }
+  }
+
+  /**
+   * End the stream with error, e.g., the device could not be read.
+   */
+  fail(error: Error): void {
+    if (this._done) return;
+
+    this._error = error;
+    const waiting = this._waiting;
+    this._waiting = [];
+    this.end();
+    waiting.forEach(pending => pending.reject(error));
+  }
+
+  /**
+   * Stop queueing events, pending next() calls resolve done.
+   */
+  end(): void {
+    if (this._done) return;
+
+    this._done = true;
+    this._close();
+
+    const waiting = this._waiting;
+    this._waiting = [];
+    waiting.forEach(pending => pending.resolve({done: true, value: undefined}));
+  }
+
+  /**
+   * The next batch from the ring, undefined once the reader is asked to
+   * wake the consumer as there are none.
+   */
+  protected read(): Event[] | undefined {
+    while (true) {
+      const count = this._ring.read(this._records);
+      if (this._ring.blocked) this._resume();
+
+      if (count > 0) {
+        const events = new Array<Event>(count);
+        for (let i = 0; i < count; i++) events[i] = Event.fromRecord(this._records, i);
+        return events;
+      }
+
+      if (this._ring.wait()) return undefined;
+    }
+  }
+}
@@ -0,0 +1,194 @@
+import { Event, EventTimestamp } from './event';
+import {InputCodes} from "./input-codes";
+
+const EMPTY = new Int32Array(0);
+
+/**
+ * A flyweight Event: a cursor over the packed event records of a batch
+ *    [tv_sec, tv_usec, type, code, value]
+ * (or, with a stride of Event.TAGGED_RECORD_SIZE, tagged records) that
+ * reads its fields in place. Moving the cursor allocates nothing; time is
+ * only materialised on access, timeUs is the kernel timestamp as a single
+ * microsecond count instead.
+ *
+ * A view is only valid until its batch is reused, e.g., once the 'batch'
+ * listener it was passed to returns; keep toEvent() to retain an event.
+ */
+export class EventView implements Event {
+  private _records: Int32Array;
+  private _offset: number;
+  private _stride: number;
+  private _first: number;
+
+  /**
+   * @param records - packed event records
+   * @param stride - elements per record, Event.RECORD_SIZE or Event.TAGGED_RECORD_SIZE
+   */
+  constructor(records: Int32Array = EMPTY, stride = Event.RECORD_SIZE) {
+    this._records = records;
+    this._stride = stride;
+    this._first = stride - Event.RECORD_SIZE;
+    this._offset = this._first;
+  }
+
+  get records(): Int32Array {
+    return this._records;
+  }
+
+  /**
+   * Element offset of the event's record, tag excluded.
+   */
+  get offset(): number {
+    return this._offset;
+  }
+
+  /**
+   * Move the cursor to the record at position idx of records.
+   * @param idx - record index (not element offset)
+   */
+  at(idx: number): this {
+    this._offset = idx * this._stride + this._first;
+    return this;
+  }
+
+  /**
+   * View other records, e.g., the next batch, from its first record.
+   */
+  reset(records: Int32Array): this {
+    this._records = records;
+    this._offset = this._first;
+    return this;
+  }
+
+  /**
+   * The device id of a tagged record, 0 for an untagged one.
+   */
+  get tag(): number {
+    return this._first > 0 ? this._records[this._offset - 1] : 0;
+  }
+
+  get type(): InputCodes.EV_TYPE_CODE {
+    return this._records[this._offset + 2] as InputCodes.EV_TYPE_CODE;
+  }
+
+  get code(): InputCodes.EV_CODE {
+    return this._records[this._offset + 3] as InputCodes.EV_CODE;
+  }
+
+  get value(): number {
+    return this._records[this._offset + 4];
+  }
+
+  /**
+   * Kernel timestamp in microseconds. The record's tv_sec is read as
+   * unsigned, exact in a double until long after 2038.
+   */
+  get timeUs(): number {
+    return (this._records[this._offset] >>> 0) * 1000000 + this._records[this._offset + 1];
+  }
+
+  /**
+   * The timestamp as a new EventTimestamp, prefer timeUs.
+   */
+  get time(): EventTimestamp {
+    return {
+      tv_sec: this._records[this._offset],
+      tv_usec: this._records[this._offset + 1]
+    };
+  }
+
+  /**
+   * A detached copy of the event, valid after its batch is reused.
+   */
+  toEvent(): Event {
+    return Event.fromRecordAt(this._records, this._offset);
+  }
+
+  toString(): string {
+    return Event.toString(this);
+  }
+}
+
+/**
+ * A batch of packed event records with a reusable cursor, as published by
+ * Device via 'batch'. Iterating it yields the same EventView, moved to
+ * each event in turn, through a single iterator result, so a loop
+ * allocates only its iterator:
+ *
+ *    device.on('batch', batch => {
+ *      for (const event of batch) total += event.value;
+ *    });
+ */
+export class EventBatch implements Iterable<EventView> {
+  private _records: Int32Array;
+  private _count: number;
+  private _view: EventView;
+
+  /**
+   * @param records - packed event records
+   * @param count - number of records in use
+   * @param stride - elements per record, Event.RECORD_SIZE or Event.TAGGED_RECORD_SIZE
+   */
+  constructor(records: Int32Array = EMPTY, count = 0, stride = Event.RECORD_SIZE) {
+    this._records = records;
+    this._count = count;
+    this._view = new EventView(records, stride);
+  }
+
+  get records(): Int32Array {
+    return this._records;
+  }
+
+  get count(): number {
+    return this._count;
+  }
+
+  /**
+   * Reuse the batch for count records of records.
+   */
+  reset(records: Int32Array, count: number): this {
+    this._records = records;
+    this._count = count;
+    this._view.reset(records);
+    return this;
+  }
+
+  /**
+   * The batch's cursor moved to event idx, the same view on every call.
+   */
+  at(idx: number): EventView {
+    return this._view.at(idx);
+  }
+
+  /**
+   * Visit each event with the batch's cursor.
+   */
+  forEach(visitor: (event: EventView, idx: number) => void): void {
+    for (let i = 0; i < this._count; i++) visitor(this._view.at(i), i);
+  }
+
+  /**
+   * Detached copies of the events, valid after the batch is reused.
+   */
+  toEvents(): Event[] {
+    const events = new Array<Event>(this._count);
+    for (let i = 0; i < this._count; i++) events[i] = this._view.at(i).toEvent();
+    return events;
+  }
+
+  [Symbol.iterator](): Iterator<EventView> {
+    let idx = 0;
+    const result: {done: boolean, value: EventView | undefined} = {done: false, value: undefined};
+    return {
+      next: (): IteratorResult<EventView> => {
+        if (idx < this._count) {
+          result.value = this._view.at(idx++);
+        } else {
+          result.done = true;
+          result.value = undefined;
+        }
+        return result as IteratorResult<EventView>;
+      }
+    };
+  }
+}
@@ -22,6 +22,18 @@ export interface Event {
 
 export namespace Event {
 
+  /**
+   * Number of int32 elements in a packed event record:
+   *    [tv_sec, tv_usec, type, code, value]
+   */
+  export const RECORD_SIZE = 5;
+
+  /**
+   * Number of int32 elements in a packed event record tagged with its device id:
+   *    [devId, tv_sec, tv_usec, type, code, value]
+   */
+  export const TAGGED_RECORD_SIZE = RECORD_SIZE + 1;
+
   export function createEvent(type: InputCodes.EV_TYPE_CODE | InputCodes.EV_TYPE_NAME, code: InputCodes.EV_CODE | InputCodes.EV_CODE_NAME, value: number): Event {
     let typeCode = type;
     if (typeof type === 'string') {
@@ -38,6 +50,40 @@ export namespace Event {
     }
   }
 
+  /**
+   * Create an event from the packed record at position idx of records.
+   * @param records - packed event records, e.g., filled by evdevjs.NextEvents()
+   * @param idx - record index (not element offset)
+   */
+  export function fromRecord(records: Int32Array, idx: number): Event {
+    return fromRecordAt(records, idx * RECORD_SIZE);
+  }
+
+  /**
+   * Create an event from the tagged record at position idx of records.
+   * Use tagged records[idx * TAGGED_RECORD_SIZE] for the device id.
+   * @param records - packed tagged event records
+   * @param idx - record index (not element offset)
+   */
+  export function fromTaggedRecord(records: Int32Array, idx: number): Event {
+    return fromRecordAt(records, idx * TAGGED_RECORD_SIZE + 1);
+  }
+
+  /**
+   * Create an event from the packed record starting at element offset of records.
+   */
+  export function fromRecordAt(records: Int32Array, offset: number): Event {
+    return {
+      time: {
+        tv_sec: records[offset],
+        tv_usec: records[offset + 1]
+      },
+      type: records[offset + 2] as InputCodes.EV_TYPE_CODE,
+      code: records[offset + 3] as InputCodes.EV_CODE,
+      value: records[offset + 4]
+    }
+  }
+
   export function toString(event: Event): string {
     return `Event{type: ${event.type} (${InputCodes.getTypeName(event.type)}), code: ${event.code} (${InputCodes.getCodeName(event.type, event.code)}), value: ${event.value}, time: {${event.time ? `${event.time.tv_sec},${event.time.tv_usec}` : ''}}}`;
   }
@@ -0,0 +1,46 @@
+import { Event } from './event';
+
+/**
+ * The events of a device up to and including their SYN_REPORT.
+ */
+export interface Frame {
+  // true if the frame is the state diff libevdev reported after a
+  // SYN_DROPPED, i.e., the kernel buffer overran and events were lost
+  readonly resync: boolean;
+  // number of events
+  readonly count: number;
+  // count packed event records [tv_sec, tv_usec, type, code, value]
+  readonly records: Int32Array;
+}
+
+export namespace Frame {
+
+  /**
+   * Number of int32 elements preceding the records of a packed frame:
+   *    [flags, count, count * Event.RECORD_SIZE records]
+   */
+  export const HEADER_SIZE = 2;
+
+  export const FLAG_RESYNC = 1;
+
+  /**
+   * Visit each packed frame in frames[0..length).
+   * Frame records are views of frames, copy them to keep them.
+   * @param frames - packed frames, e.g., filled by evdevjs.NextFrames()
+   * @param length - number of elements of frames in use
+   * @param visitor - called for each frame
+   */
+  export function forEach(frames: Int32Array, length: number, visitor: (frame: Frame) => void): void {
+    let offset = 0;
+    while (offset < length) {
+      const count = frames[offset + 1];
+      const start = offset + HEADER_SIZE;
+      visitor({
+        resync: (frames[offset] & FLAG_RESYNC) !== 0,
+        count: count,
+        records: frames.subarray(start, start + count * Event.RECORD_SIZE)
+      });
+      offset = start + count * Event.RECORD_SIZE;
+    }
+  }
+}
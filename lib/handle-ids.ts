@@ -0,0 +1,35 @@
+/**
+ * Allocates the ids native objects are registered under, lowest free id
+ * first. The native handle tables are indexed by id (see
+ * src/handle-table.h), so reusing released ids keeps a table as large as
+ * the most objects open at once, not the most ever opened, e.g., for
+ * readers or players created and released repeatedly.
+ *
+ * An id must only be released once the native object is, and nothing
+ * that still refers to it by id, like a tagged event record, can arrive.
+ */
+export class HandleIds {
+  private _next: number;
+  private _free: number[];    // released ids, highest first
+
+  constructor(first = 1) {
+    this._next = first;
+    this._free = [];
+  }
+
+  allocate(): number {
+    return this._free.length > 0 ? this._free.pop()! : this._next++;
+  }
+
+  release(id: number): void {
+    let lo = 0;
+    let hi = this._free.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >>> 1;
+      if (this._free[mid] > id) lo = mid + 1; else hi = mid;
+    }
+    if (this._free[lo] === id) return;
+
+    this._free.splice(lo, 0, id);
+  }
+}
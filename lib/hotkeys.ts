@@ -0,0 +1,70 @@
+import { Event } from './event';
+import { Frame } from './frame';
+import { InputCodes } from './input-codes';
+
+type KeyCode = InputCodes.EV_KEY_CODE | InputCodes.EV_CODE_NAME;
+
+/**
+ * A hotkey matched natively, see Device.setHotkeys(): a chord, i.e.,
+ * keys held together and completed by a key press that leaves exactly
+ * these keys pressed, or a sequence of chords (or single keys) pressed
+ * in turn within the step timeout of each other.
+ *
+ * Examples:
+ *    {chord: ['KEY_LEFTCTRL', 'KEY_LEFTSHIFT', 'KEY_P']}
+ *    {sequence: ['KEY_G', 'KEY_G']}
+ *    {sequence: [['KEY_LEFTCTRL', 'KEY_K'], ['KEY_LEFTCTRL', 'KEY_C']]}
+ */
+export type Hotkey =
+  { chord: KeyCode[] } |
+  { sequence: (KeyCode | KeyCode[])[] };
+
+export type HotkeyOptions = {
+  // maximum time between the steps of a sequence, default 1000 ms
+  stepTimeoutMs?: number;
+}
+
+/**
+ * A hotkey completed by a key press, with the frame of the press.
+ */
+export type HotkeyMatch = {
+  name: string;
+  frame: Frame;
+}
+
+export namespace Hotkey {
+
+  export const DEFAULT_STEP_TIMEOUT_MS = 1000;
+
+  /**
+   * Number of int32 elements preceding the records of a packed match,
+   * the hotkey id followed by the packed frame of the press:
+   *    [hotkeyId, flags, count, count * Event.RECORD_SIZE records]
+   */
+  export const MATCH_HEADER_SIZE = 1 + Frame.HEADER_SIZE;
+
+  /**
+   * The steps of hotkey as key codes, as expected natively.
+   */
+  export function resolve(hotkey: Hotkey): number[][] {
+    const steps: (KeyCode | KeyCode[])[] = 'chord' in hotkey ? [hotkey.chord] : hotkey.sequence;
+    return steps.map(step => (Array.isArray(step) ? step : [step]).map(code =>
+      typeof code === 'string' ? InputCodes.getCode(code) : code));
+  }
+
+  /**
+   * Visit each packed match in matches[0..length).
+   * Frame records are views of matches, copy them to keep them.
+   * @param matches - packed matches, e.g., filled by evdevjs.NextHotkeys()
+   * @param length - number of elements of matches in use
+   * @param visitor - called with the hotkey id and frame of each match
+   */
+  export function forEachMatch(matches: Int32Array, length: number, visitor: (id: number, frame: Frame) => void): void {
+    let offset = 0;
+    while (offset < length) {
+      const end = offset + MATCH_HEADER_SIZE + matches[offset + 2] * Event.RECORD_SIZE;
+      Frame.forEach(matches.subarray(offset + 1, end), end - offset - 1, frame => visitor(matches[offset], frame));
+      offset = end;
+    }
+  }
+}
@@ -1,14 +1,80 @@
 export {Event} from './event';
+export {Frame} from './frame';
+export {TouchFrame} from './touch-frame';
+
+export {
+  AxisOptions,
+  AxisState
+} from './axis-state';
+
+export {
+  CapabilityBits
+} from './capability-bits';
+
+export {
+  CapabilityIndex
+} from './capability-index';
+
+export {
+  CaptureInfo,
+  CaptureReader,
+  CaptureWriter,
+  ReplayOptions
+} from './capture';
 
 export {
   Capability,
-  Device
+  CoalesceOptions,
+  Device,
+  DeviceTransfer
 } from './device';
 
+export {
+  DeviceState
+} from './device-state';
+
+export {
+  DeviceStats
+} from './device-stats';
+
 export {
   Evdev
 } from './evdev';
 
+export {
+  EventReader
+} from './event-reader';
+
+export {
+  RemapRule
+} from './event-remap';
+
+export {
+  EventRing,
+  EventRingOverflow
+} from './event-ring';
+
+export {
+  EventBatch,
+  EventView
+} from './event-view';
+
+export {
+  EventStream,
+  EventStreamOptions
+} from './event-stream';
+
+export {
+  Hotkey,
+  HotkeyMatch,
+  HotkeyOptions
+} from './hotkeys';
+
 export {
   InputCodes
 } from './input-codes';
+
+export {
+  PlaybackResult,
+  UInputPlayer
+} from './uinput-player';
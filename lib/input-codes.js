@@ -4,7 +4,6 @@
  */
 exports.__esModule = true;
 exports.InputCodes = void 0;
-var evdevjs = require('bindings')('evdevjs.node');
 var InputCodes;
 (function (InputCodes) {
     // *** EV_TYPE *** 
@@ -722,20 +721,53 @@ var InputCodes;
     _InputCodeMap.set("EV_FF", InputCodes.EV_FF);
     InputCodes.INPUT_PROP_MAX = 0x1f;
     InputCodes.InputCodeMap = _InputCodeMap;
+    // name lookup tables, built once from the declarations above
+    var _TypeNames = new Array();
+    var _CodeNames = new Array();
+    var _Types = new Map();
+    var _Codes = new Map();
+    var _evdevjs = require('bindings')('evdevjs.node');
+    for (var _i = 0, _a = Object.entries(InputCodes.EV_TYPE); _i < _a.length; _i++) {
+        var _b = _a[_i], typeKey = _b[0], typeName = _b[1];
+        var type = Number(typeKey);
+        _TypeNames[type] = typeName;
+        _Types.set(typeName, type);
+        var codeNames = new Array();
+        var _c;
+        for (var _d = 0, _e = Object.entries((_c = _InputCodeMap.get(typeName)) !== null && _c !== void 0 ? _c : {}); _d < _e.length; _d++) {
+            var _f = _e[_d], codeKey = _f[0], codeName = _f[1];
+            var code = Number(codeKey);
+            codeNames[code] = codeName;
+            if (!_Codes.has(codeName))
+                _Codes.set(codeName, code);
+        }
+        _CodeNames[type] = codeNames;
+    }
     function getTypeName(type) {
-        return evdevjs.NameForType(type);
+        return _TypeNames[type];
     }
     InputCodes.getTypeName = getTypeName;
     function getType(typeName) {
-        return evdevjs.TypeForName(typeName);
+        var _a;
+        return ((_a = _Types.get(typeName)) !== null && _a !== void 0 ? _a : -1);
     }
     InputCodes.getType = getType;
+    // aliases, e.g., BTN_A or KEY_HANGUEL, are not declared above: libevdev
+    // resolves them, once per name
     function getCode(codeName) {
-        return evdevjs.CodeForName(codeName);
+        var code = _Codes.get(codeName);
+        if (code === undefined) {
+            code = _evdevjs.CodeForName(codeName);
+            if (code < 0)
+                return -1;
+            _Codes.set(codeName, code);
+        }
+        return code;
     }
     InputCodes.getCode = getCode;
     function getCodeName(type, code) {
-        return evdevjs.NameForCode(type, code);
+        var _a;
+        return (_a = _CodeNames[type]) === null || _a === void 0 ? void 0 : _a[code];
     }
     InputCodes.getCodeName = getCodeName;
 })(InputCodes = exports.InputCodes || (exports.InputCodes = {}));
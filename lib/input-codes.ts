@@ -3,8 +3,6 @@
  * InputCodes were enerated by the evdevjs generate-input-codes script.
  */
 
-const evdevjs = require('bindings')('evdevjs.node');
-
 
 export namespace InputCodes {
 
@@ -786,23 +784,51 @@ export const INPUT_PROP_MAX = 0x1f;
 
 
 export const InputCodeMap = _InputCodeMap;
+
+// name lookup tables, built once from the declarations above
+const _TypeNames = new Array<EV_TYPE_NAME | undefined>();
+const _CodeNames = new Array<Array<EV_CODE_NAME | undefined> | undefined>();
+const _Types = new Map<string, EV_TYPE_CODE>();
+const _Codes = new Map<string, EV_CODE>();
+const _evdevjs = require('bindings')('evdevjs.node');
+
+for (const [typeKey, typeName] of Object.entries(EV_TYPE)) {
+  const type = Number(typeKey) as EV_TYPE_CODE;
+  _TypeNames[type] = typeName;
+  _Types.set(typeName, type);
+
+  const codeNames = new Array<EV_CODE_NAME | undefined>();
+  for (const [codeKey, codeName] of Object.entries(_InputCodeMap.get(typeName) ?? {})) {
+    const code = Number(codeKey) as EV_CODE;
+    codeNames[code] = codeName as EV_CODE_NAME;
+    if (!_Codes.has(codeName)) _Codes.set(codeName, code);
+  }
+  _CodeNames[type] = codeNames;
+}
  
 export function getTypeName(type: EV_TYPE_CODE): EV_TYPE_NAME {
-  return evdevjs.NameForType(type);
+  return _TypeNames[type] as EV_TYPE_NAME;
 }
 
 export function getType(typeName: EV_TYPE_NAME): EV_TYPE_CODE {
-  return evdevjs.TypeForName(typeName);
+  return (_Types.get(typeName) ?? -1) as EV_TYPE_CODE;
 }
 
+// aliases, e.g., BTN_A or KEY_HANGUEL, are not declared above: libevdev
+// resolves them, once per name
 export function getCode(codeName: EV_CODE_NAME): EV_CODE {
-  return evdevjs.CodeForName(codeName);
+  let code = _Codes.get(codeName);
+  if (code === undefined) {
+    code = _evdevjs.CodeForName(codeName) as EV_CODE;
+    if (code < 0) return -1 as EV_CODE;
+    _Codes.set(codeName, code);
+  }
+  return code;
 }
 
 export function getCodeName(type: EV_TYPE_CODE, code: EV_CODE): EV_CODE_NAME {
-  return evdevjs.NameForCode(type, code);
+  return _CodeNames[type]?.[code] as EV_CODE_NAME;
 }
 
-
 }
 
@@ -0,0 +1,68 @@
+/**
+ * The multi-touch contacts of a device at one SYN_REPORT, tracked natively
+ * from libevdev's slot state. Contacts are packed in a typed array, see
+ * TouchFrame.CONTACT_SIZE and the field offsets.
+ */
+export interface TouchFrame {
+  // true for the first frame after a SYN_DROPPED, contacts may have
+  // begun and ended unseen
+  readonly resync: boolean;
+  // kernel timestamp of the SYN_REPORT
+  readonly sec: number;
+  readonly usec: number;
+  // number of contacts: every active contact, and once each contact that ended
+  readonly count: number;
+  // count packed contacts [slot, id, flags, x, y, pressure, touchMajor, touchMinor]
+  readonly contacts: Int32Array;
+}
+
+export namespace TouchFrame {
+
+  /**
+   * Number of int32 elements preceding the contacts of a packed touch frame:
+   *    [flags, count, tv_sec, tv_usec, count * CONTACT_SIZE contacts]
+   */
+  export const HEADER_SIZE = 4;
+
+  export const FLAG_RESYNC = 1;
+
+  export const CONTACT_SIZE = 8;
+
+  // contact field offsets
+  export const SLOT = 0;
+  export const ID = 1;
+  export const FLAGS = 2;
+  export const X = 3;
+  export const Y = 4;
+  export const PRESSURE = 5;
+  export const TOUCH_MAJOR = 6;
+  export const TOUCH_MINOR = 7;
+
+  // contact flags
+  export const BEGIN = 1;   // the contact is new in this frame
+  export const END = 2;     // the contact was lifted, its values are the last known
+  export const MOVED = 4;   // the contact's values changed since the previous frame
+
+  /**
+   * Visit each packed touch frame in frames[0..length).
+   * Frame contacts are views of frames, copy them to keep them.
+   * @param frames - packed touch frames, e.g., filled by evdevjs.NextTouchFrames()
+   * @param length - number of elements of frames in use
+   * @param visitor - called for each frame
+   */
+  export function forEach(frames: Int32Array, length: number, visitor: (frame: TouchFrame) => void): void {
+    let offset = 0;
+    while (offset < length) {
+      const count = frames[offset + 1];
+      const start = offset + HEADER_SIZE;
+      visitor({
+        resync: (frames[offset] & FLAG_RESYNC) !== 0,
+        sec: frames[offset + 2],
+        usec: frames[offset + 3],
+        count: count,
+        contacts: frames.subarray(start, start + count * CONTACT_SIZE)
+      });
+      offset = start + count * CONTACT_SIZE;
+    }
+  }
+}
@@ -0,0 +1,100 @@
+import { HandleIds } from './handle-ids';
+
+const evdevjs = require('bindings')('evdevjs.node') 
+
+/**
+ * Outcome of a playback. Timing error is how late each write reached
+ * the uinput device relative to its schedule.
+ */
+export type PlaybackResult = {
+  // false if the playback was cancelled or a write failed
+  completed: boolean;
+  // number of events written
+  events: number;
+  maxErrorUs: number;
+  meanErrorUs: number;
+  // errno of a failed write, 0 otherwise
+  errno: number;
+}
+
+export type PlaybackCallbackFn = (result: PlaybackResult) => void;
+
+/**
+ * Plays packed event records [tv_sec, tv_usec, type, code, value]
+ * (Event.RECORD_SIZE) to a uinput device from a native thread, keeping
+ * the intervals between the record timestamps. Records with the same
+ * timestamp are written together; include the recorded SYN_REPORT events.
+ * Scheduling uses a CLOCK_MONOTONIC timerfd and is independent of
+ * the node event loop.
+ *
+ * Playback starts immediately. The callback receives the result when
+ * playback completes or is cancelled.
+ */
+export class UInputPlayer {
+  private static IDS = new HandleIds();
+
+  private _id: number;
+  private _finished: boolean;
+  private _paused: boolean;
+  private _released: boolean;
+
+  constructor(uinputId: number, records: Int32Array, callback?: PlaybackCallbackFn) {
+    this._id = UInputPlayer.IDS.allocate();
+    this._finished = false;
+    this._paused = false;
+    this._released = false;
+
+    evdevjs.NewUInputPlayer(this._id, uinputId, records, (result: PlaybackResult) => {
+      this._finished = true;
+      this.release();
+      if (callback) callback(result);
+    });
+  }
+
+  get id(): number {
+    return this._id;
+  }
+
+  isFinished(): boolean {
+    return this._finished;
+  }
+
+  isPaused(): boolean {
+    return this._paused;
+  }
+
+  /**
+   * Suspend playback. The remaining events are rescheduled by the
+   * time spent paused.
+   */
+  pause(): void {
+    if (this._released) return;
+
+    this._paused = true;
+    evdevjs.PauseUInputPlayer(this._id, true);
+  }
+
+  resume(): void {
+    if (this._released) return;
+
+    this._paused = false;
+    evdevjs.PauseUInputPlayer(this._id, false);
+  }
+
+  /**
+   * Stop playback. The callback receives a result with completed = false.
+   */
+  cancel(): void {
+    this.release();
+  }
+
+  // the id may be reused once released, the result of a cancelled
+  // playback must not release it again
+  private release(): void {
+    if (this._released) return;
+
+    this._released = true;
+    evdevjs.ReleaseUInputPlayer(this._id);
+    UInputPlayer.IDS.release(this._id);
+  }
+}
@@ -4,6 +4,7 @@ import * as path from 'path';
 import { AbsInfo, Device, DeviceLike } from "./device";
 import { Event } from './event';
 import { InputCodes } from './input-codes';
+import { PlaybackCallbackFn, UInputPlayer } from './uinput-player';
 
 const evdevjs = require('bindings')('evdevjs.node') 
 
@@ -14,17 +15,28 @@ export interface UInput {
   readonly fd: number;
 
   writeEvent(event: Event): void;
+  writeEvents(events: Int32Array | Array<Event>, synReport?: boolean): number;
   writeSynReportEvent(): void;
 
+  play(records: Int32Array, callback?: PlaybackCallbackFn): UInputPlayer;
+
   close(): void;
 
   on(event: 'close', callback: (dev: Device) => void): void;
   on(event: 'error', callback: (error: Error) => void): void;
-    
+
   removeListener(topic: 'close' | 'error', fn: any): void;
   removeAllListeners(topic?: 'close' | 'error'): void;
 }
 
+export namespace UInput {
+  /**
+   * Number of int32 values per packed event passed to writeEvents():
+   *    [type, code, value]
+   */
+  export const EVENT_SIZE = 3;
+}
+
 export namespace UInputFactory {
 
   export function createUInputFromDevice(device: Device) {
@@ -34,12 +46,13 @@ export namespace UInputFactory {
 
 export class UInputImpl extends DeviceLike implements UInput {
   private _file: string | undefined;
+  private _events = new Int32Array(64 * UInput.EVENT_SIZE);
   public toString = () => `Uinput`;
 
   constructor(device: Device) {
     super();
   
-    let fd = evdevjs.CreateUInputFromDevice(device.id, this.id);
+    let fd = evdevjs.CreateUInputFromDevice(device.id, this.id, this);
     console.log('fd:', fd);
     // if (!fd || fd < 0) throw new Error('Unable to create uinput from device');
     this.fd = fd;
@@ -59,8 +72,43 @@ export class UInputImpl extends DeviceLike implements UInput {
     evdevjs.UInputWriteEvent(this.id, event);
   }
 
+  /**
+   * Write a batch of events with a single write to the uinput device.
+   * @param events - packed [type, code, value] events or Event objects
+   * @param synReport - append a SYN_REPORT event after the batch
+   * @returns the number of events written, including the SYN_REPORT,
+   *    or a negative errno if nothing could be written
+   */
+  writeEvents(events: Int32Array | Array<Event>, synReport = false): number {
+    if (events instanceof Int32Array) {
+      return evdevjs.UInputWriteEvents(this.id, events, synReport);
+    }
+
+    const length = events.length * UInput.EVENT_SIZE;
+    if (this._events.length < length) this._events = new Int32Array(length);
+
+    let offset = 0;
+    for (const event of events) {
+      this._events[offset++] = event.type;
+      this._events[offset++] = event.code;
+      this._events[offset++] = event.value;
+    }
+
+    return evdevjs.UInputWriteEvents(this.id, this._events.subarray(0, length), synReport);
+  }
+
   writeSynReportEvent(): void {
-    this.writeEvent(Event.createEvent('EV_SYN', 'SYN_REPORT', 0));
+    evdevjs.UInputWriteEvents(this.id, this._events.subarray(0, 0), true);
+  }
+
+  /**
+   * Replay timestamped event records to this device from a native
+   * thread with the original timing, see UInputPlayer.
+   * @param records - packed [tv_sec, tv_usec, type, code, value] records
+   * @param callback - receives the result when playback ends
+   */
+  play(records: Int32Array, callback?: PlaybackCallbackFn): UInputPlayer {
+    return new UInputPlayer(this.id, records, callback);
   }
 
   close(): void {
@@ -0,0 +1,43 @@
+#ifndef ADDON_DATA_H_
+#define ADDON_DATA_H_
+
+#include <vector>
+
+#include "napi.h"
+#include "capture-reader.h"
+#include "capture-writer.h"
+#include "device-handle.h"
+#include "device-monitor.h"
+#include "event-reader.h"
+#include "handle-table.h"
+#include "uinput-player.h"
+
+extern "C" {
+#include <linux/input.h>
+}
+
+// Per-environment state of the addon. The main thread and every
+// worker_thread loading the addon get their own instance, set up by Init
+// as the environment's instance data and deleted with the environment,
+// so the native objects of one environment are never reachable by the
+// ids of another. Only probed devices (device-probe.h) are shared.
+struct AddonData {
+  HandleTable<DeviceHandle> devices;
+  HandleTable<UInputHandle> uinputs;
+  HandleTable<EventReader> readers;
+  HandleTable<UInputPlayer> players;
+  HandleTable<CaptureWriter> captureWriters;
+  HandleTable<CaptureReader> captureReaders;
+  HandleTable<DeviceMonitor> monitors;
+
+  // JS strings of the generated type and code names, created on first use
+  std::vector<Napi::Reference<Napi::String>> names;
+
+  // staging buffer for UInputWriteEvents
+  std::vector<struct input_event> uinputEvents;
+
+  // Stops the threads and frees the objects still open.
+  ~AddonData();
+};
+
+#endif  // ADDON_DATA_H_
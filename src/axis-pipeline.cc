@@ -0,0 +1,147 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "axis-pipeline.h"
+
+AxisPipeline* AxisPipeline::New(const struct libevdev* evdev, Napi::Int32Array array,
+                                const std::vector<AxisConfig>& configs) {
+  if (configs.empty() || configs.size() > MAX_PIPELINE_AXES) return nullptr;
+  if (array.ElementLength() < AXES_HEADER_SIZE + configs.size()) return nullptr;
+
+  std::vector<Axis> axes;
+  for (const AxisConfig& config : configs) {
+    if (config.code >= ABS_CNT || !libevdev_has_event_code(evdev, EV_ABS, config.code)) return nullptr;
+
+    const struct input_absinfo* absInfo = libevdev_get_abs_info(evdev, config.code);
+    Axis axis = {config, absInfo->fuzz, absInfo->value, 0, 0};
+
+    if (std::isnan(axis.config.min) || std::isnan(axis.config.max) ||
+        axis.config.max <= axis.config.min) {
+      axis.config.min = absInfo->minimum;
+      axis.config.max = absInfo->maximum;
+    }
+    if (axis.config.max <= axis.config.min) return nullptr;
+    if (std::isnan(axis.config.center)) {
+      axis.config.center = (axis.config.min + axis.config.max) / 2;
+    }
+    if (std::isnan(axis.config.deadzone)) {
+      const float range = axis.config.unipolar ? axis.config.max - axis.config.min
+                                               : (axis.config.max - axis.config.min) / 2;
+      axis.config.deadzone = absInfo->flat / range;
+    }
+    if (std::isnan(axis.config.hysteresis)) axis.config.hysteresis = 0;
+    if (std::isnan(axis.config.smoothing)) axis.config.smoothing = 0;
+
+    axis.smoothed = axis.published = 0;
+    axes.push_back(axis);
+  }
+
+  AxisPipeline* pipeline = new AxisPipeline(array, axes);
+
+  // publish the current values so the state is valid before the first frame
+  for (Axis& axis : pipeline->axes_) {
+    axis.smoothed = axis.published = pipeline->Normalize(axis);
+  }
+  for (size_t i = 0; i < pipeline->axes_.size(); i++) {
+    pipeline->values_[i] = pipeline->axes_[i].published;
+  }
+  return pipeline;
+}
+
+AxisPipeline::AxisPipeline(Napi::Int32Array array, std::vector<Axis> axes)
+  : buffer_(Napi::Persistent(array.As<Napi::Object>())),
+    header_(array.Data()),
+    values_(reinterpret_cast<float*>(array.Data() + AXES_HEADER_SIZE)),
+    axes_(axes),
+    axisEvents_(false),
+    otherEvents_(false) {
+  memset(index_, -1, sizeof(index_));
+  for (size_t i = 0; i < axes_.size(); i++) {
+    index_[axes_[i].config.code] = (int8_t)i;
+  }
+}
+
+bool AxisPipeline::Process(const struct input_event& evdevEvent, bool syncing) {
+  if (evdevEvent.type == EV_ABS && evdevEvent.code < ABS_CNT && index_[evdevEvent.code] >= 0) {
+    Axis& axis = axes_[index_[evdevEvent.code]];
+
+    // like the kernel's defuzz, jitter within half the fuzz is ignored
+    if (std::abs(evdevEvent.value - axis.raw) * 2 >= axis.fuzz) axis.raw = evdevEvent.value;
+    axisEvents_ = true;
+    return true;
+  }
+
+  if (evdevEvent.type == EV_SYN && evdevEvent.code == SYN_REPORT) {
+    const bool published = Report(evdevEvent.time);
+    const bool dropped = axisEvents_ && !otherEvents_ && !published && !syncing;
+    axisEvents_ = false;
+    otherEvents_ = false;
+    return dropped;
+  }
+
+  if (evdevEvent.type != EV_SYN) otherEvents_ = true;
+  return false;
+}
+
+float AxisPipeline::Normalize(const Axis& axis) const {
+  const AxisConfig& config = axis.config;
+  const float raw = std::fmin(std::fmax((float)axis.raw, config.min), config.max);
+
+  float value;
+  if (config.unipolar) {
+    value = (raw - config.min) / (config.max - config.min);
+  } else if (raw < config.center) {
+    value = config.center > config.min ? (raw - config.center) / (config.center - config.min) : 0;
+  } else {
+    value = config.max > config.center ? (raw - config.center) / (config.max - config.center) : 0;
+  }
+
+  // rescale past the deadzone so the output still spans the whole range
+  const float magnitude = std::fabs(value);
+  if (magnitude <= config.deadzone) {
+    value = 0;
+  } else if (config.deadzone > 0 && config.deadzone < 1) {
+    value = std::copysign((magnitude - config.deadzone) / (1 - config.deadzone), value);
+  }
+
+  if (config.invert) value = config.unipolar ? 1 - value : -value;
+  return value;
+}
+
+bool AxisPipeline::Report(const struct timeval& time) {
+  uint32_t changed = 0;
+
+  for (size_t i = 0; i < axes_.size(); i++) {
+    Axis& axis = axes_[i];
+    const float target = Normalize(axis);
+    const float weight = axis.config.smoothing;
+    axis.smoothed = weight > 0 ? axis.smoothed * weight + target * (1 - weight) : target;
+    if (std::fabs(axis.smoothed - target) < 1e-4f) axis.smoothed = target;
+
+    // rests and limits are always published, they must not be missed
+    const float delta = std::fabs(axis.smoothed - axis.published);
+    const bool edge = axis.smoothed == 0 || std::fabs(axis.smoothed) == 1;
+    if (delta == 0 || (delta < axis.config.hysteresis && !edge)) continue;
+
+    axis.published = axis.smoothed;
+    changed |= 1u << i;
+  }
+
+  if (changed == 0) return false;
+
+  // seqlock: the sequence is odd while the frame is written, readers retry
+  // on an odd or changed sequence so they never see half a frame
+  const int32_t sequence = __atomic_load_n(&header_[AXES_SEQUENCE], __ATOMIC_RELAXED);
+  __atomic_store_n(&header_[AXES_SEQUENCE], sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  for (size_t i = 0; i < axes_.size(); i++) {
+    if (changed & (1u << i)) values_[i] = axes_[i].published;
+  }
+  header_[AXES_CHANGED] = (int32_t)changed;
+  header_[AXES_SEC] = (int32_t)time.tv_sec;
+  header_[AXES_USEC] = (int32_t)time.tv_usec;
+  __atomic_store_n(&header_[AXES_SEQUENCE], sequence + 2, __ATOMIC_RELEASE);
+  return true;
+}
@@ -0,0 +1,84 @@
+#ifndef AXIS_PIPELINE_H_
+#define AXIS_PIPELINE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "napi.h"
+
+extern "C" {
+#include <linux/input.h>
+#include <libevdev/libevdev.h>
+}
+
+// Axis state layout in a SharedArrayBuffer, shared with lib/axis-state.ts,
+// as int32 slots:
+//    [0] sequence - seqlock, twice the count of axis frames published,
+//                   odd while a frame is written (producer)
+//    [1] changed  - bitmap of the axes changed by the last published frame
+//    [2] tv_sec, [3] tv_usec of the last published frame
+//    [4..7] reserved
+//    [8..] one float32 value per axis, in configuration order
+static const size_t AXES_SEQUENCE = 0;
+static const size_t AXES_CHANGED = 1;
+static const size_t AXES_SEC = 2;
+static const size_t AXES_USEC = 3;
+static const size_t AXES_HEADER_SIZE = 8;
+static const size_t MAX_PIPELINE_AXES = 32;
+
+// Processing of one EV_ABS code. NaN leaves a setting to its default.
+struct AxisConfig {
+  unsigned int code;
+  float deadzone;     // normalized radius around the center reported as 0, default the absinfo flat
+  float hysteresis;   // minimum normalized change published, default 0
+  float smoothing;    // 0..1 weight of the previous value in an exponential average, default 0
+  float min;          // calibrated raw range, default the absinfo range
+  float max;
+  float center;       // raw value normalized to 0, default the middle of the range
+  bool unipolar;      // normalize to [0, 1] from min, e.g., triggers, instead of [-1, 1]
+  bool invert;
+};
+
+// AxisPipeline turns a device's raw EV_ABS values into normalized float
+// axes in the native read path. The configured axes' events are consumed:
+// fuzz, calibration, deadzone, smoothing and hysteresis are applied at
+// each SYN_REPORT, and only if an axis moved past its hysteresis is the
+// frame published to the shared axis state. A frame of nothing but axis
+// events that publishes nothing is dropped whole, so it never wakes JS.
+class AxisPipeline {
+ public:
+  // Validate the state layout of array and the configured codes.
+  // Returns nullptr if invalid.
+  static AxisPipeline* New(const struct libevdev* evdev, Napi::Int32Array array,
+                           const std::vector<AxisConfig>& configs);
+
+  // Observe an event read from the device, syncing if it is part of a
+  // SYN_DROPPED diff. Returns true if the event is consumed by the pipeline.
+  bool Process(const struct input_event& evdevEvent, bool syncing);
+
+ private:
+  struct Axis {
+    AxisConfig config;
+    int32_t fuzz;
+    int32_t raw;
+    float smoothed;
+    float published;
+  };
+
+  AxisPipeline(Napi::Int32Array array, std::vector<Axis> axes);
+
+  float Normalize(const Axis& axis) const;
+  bool Report(const struct timeval& time);
+
+  // keeps the SharedArrayBuffer alive while the reader writes to it
+  Napi::ObjectReference buffer_;
+  int32_t* header_;
+  float* values_;
+  std::vector<Axis> axes_;
+  int8_t index_[ABS_CNT];   // axis by code, -1 if not configured
+  bool axisEvents_;         // the frame in progress has consumed events
+  bool otherEvents_;        // or events passed on
+};
+
+#endif  // AXIS_PIPELINE_H_
@@ -0,0 +1,84 @@
+#ifndef CAPTURE_FORMAT_H_
+#define CAPTURE_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#include <linux/input.h>
+}
+
+// Capture file layout, in host byte order with the host's struct input_event:
+//
+//    file header   CaptureFileHeader
+//    blocks        CaptureBlockHeader, payload (size bytes, 8-byte aligned)
+//
+// Files are append-only: a block is only ever added at the end, so a file
+// cut short by a crash is read up to its last complete block.
+//
+// CAPTURE_BLOCK_DEVICE describes a recorded device, referenced by its
+// index in the events blocks that follow:
+//    CaptureDeviceHeader
+//    uint8_t codes[CAPTURE_CODE_BYTES] for each type set in header.types
+//    CaptureAbsInfo[header.absCount]
+//    char name[header.nameLength]
+//
+// CAPTURE_BLOCK_EVENTS holds consecutive events of one device:
+//    CaptureEventsHeader
+//    struct input_event[count]
+
+static const char CAPTURE_MAGIC[8] = {'E', 'V', 'J', 'S', 'C', 'A', 'P', '\0'};
+static const uint32_t CAPTURE_VERSION = 1;
+
+static const uint32_t CAPTURE_BLOCK_DEVICE = 1;
+static const uint32_t CAPTURE_BLOCK_EVENTS = 2;
+
+static const size_t CAPTURE_ALIGNMENT = 8;
+static const size_t CAPTURE_CODE_BYTES = KEY_CNT / 8;  // largest code space
+
+struct CaptureFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t eventSize;  // sizeof(struct input_event) of the writer
+};
+
+struct CaptureBlockHeader {
+  uint32_t kind;
+  uint32_t size;
+};
+
+struct CaptureDeviceHeader {
+  uint32_t device;
+  uint16_t bustype;
+  uint16_t vendor;
+  uint16_t product;
+  uint16_t version;
+  uint16_t nameLength;
+  uint16_t absCount;
+  uint8_t props[INPUT_PROP_CNT / 8];
+  uint8_t types[EV_CNT / 8];
+};
+
+struct CaptureAbsInfo {
+  uint32_t code;
+  struct input_absinfo info;
+};
+
+struct CaptureEventsHeader {
+  uint32_t device;
+  uint32_t count;
+};
+
+static inline size_t captureAlign(size_t size) {
+  return (size + CAPTURE_ALIGNMENT - 1) & ~(CAPTURE_ALIGNMENT - 1);
+}
+
+static inline bool captureTestBit(const uint8_t* bits, unsigned int bit) {
+  return (bits[bit / 8] & (1 << (bit % 8))) != 0;
+}
+
+static inline int64_t captureEventTimeUs(const struct input_event& evdevEvent) {
+  return (int64_t)evdevEvent.time.tv_sec * 1000000 + evdevEvent.time.tv_usec;
+}
+
+#endif  // CAPTURE_FORMAT_H_
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cstring>
+
+#include "capture-reader.h"
+#include "evdevjs.h"
+
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+CaptureReader::CaptureReader()
+  : map_(nullptr), size_(0), events_(0), startUs_(0), endUs_(0), block_(0), event_(0) {
+}
+
+CaptureReader::~CaptureReader() {
+  Close();
+}
+
+void CaptureReader::Close() {
+  if (map_ != nullptr) munmap(map_, size_);
+  map_ = nullptr;
+  size_ = 0;
+  devices_.clear();
+  blocks_.clear();
+}
+
+int CaptureReader::Open(const char* path) {
+  Close();
+
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return -errno;
+
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    int error = -errno;
+    close(fd);
+    return error;
+  }
+
+  if ((size_t)st.st_size < sizeof(CaptureFileHeader)) {
+    close(fd);
+    return -EINVAL;
+  }
+
+  void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return -errno;
+
+  map_ = static_cast<uint8_t*>(map);
+  size_ = st.st_size;
+  madvise(map_, size_, MADV_SEQUENTIAL);
+
+  const CaptureFileHeader* header = reinterpret_cast<const CaptureFileHeader*>(map_);
+  if (memcmp(header->magic, CAPTURE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != CAPTURE_VERSION ||
+      header->eventSize != sizeof(struct input_event)) {
+    Close();
+    return -EINVAL;
+  }
+
+  // index the complete blocks, a truncated last block is ignored
+  events_ = 0;
+  endUs_ = 0;
+  size_t offset = sizeof(CaptureFileHeader);
+  while (offset + sizeof(CaptureBlockHeader) <= size_) {
+    const CaptureBlockHeader* block = reinterpret_cast<const CaptureBlockHeader*>(map_ + offset);
+    const uint8_t* payload = map_ + offset + sizeof(CaptureBlockHeader);
+    if (block->size > size_ - offset - sizeof(CaptureBlockHeader)) break;
+
+    if (block->kind == CAPTURE_BLOCK_DEVICE) {
+      if (!IndexDevice(payload, block->size)) break;
+    } else if (block->kind == CAPTURE_BLOCK_EVENTS && block->size >= sizeof(CaptureEventsHeader)) {
+      const CaptureEventsHeader* events = reinterpret_cast<const CaptureEventsHeader*>(payload);
+      const struct input_event* first = reinterpret_cast<const struct input_event*>(events + 1);
+      if (events->count > 0 &&
+          events->count <= (block->size - sizeof(CaptureEventsHeader)) / sizeof(struct input_event)) {
+        int64_t timeUs = captureEventTimeUs(first[0]);
+        if (!blocks_.empty()) timeUs = std::max(timeUs, blocks_.back().timeUs);
+        blocks_.push_back(Block{timeUs, events->device, events->count, first});
+        events_ += events->count;
+        endUs_ = std::max(endUs_, captureEventTimeUs(first[events->count - 1]));
+      }
+    }
+
+    offset += sizeof(CaptureBlockHeader) + block->size;
+  }
+
+  startUs_ = blocks_.empty() ? 0 : blocks_.front().timeUs;
+  block_ = 0;
+  event_ = 0;
+  return 0;
+}
+
+bool CaptureReader::IndexDevice(const uint8_t* payload, size_t size) {
+  if (size < sizeof(CaptureDeviceHeader)) return false;
+
+  Device device = {};
+  device.header = reinterpret_cast<const CaptureDeviceHeader*>(payload);
+  size_t offset = sizeof(CaptureDeviceHeader);
+
+  for (unsigned int type = 0; type < EV_CNT; type++) {
+    if (!captureTestBit(device.header->types, type)) continue;
+    if (offset + CAPTURE_CODE_BYTES > size) return false;
+    device.codes[type] = payload + offset;
+    offset += CAPTURE_CODE_BYTES;
+  }
+
+  const size_t absSize = device.header->absCount * sizeof(CaptureAbsInfo);
+  if (offset + absSize + device.header->nameLength > size) return false;
+  device.absInfos = reinterpret_cast<const CaptureAbsInfo*>(payload + offset);
+  offset += absSize;
+  device.name.assign(reinterpret_cast<const char*>(payload + offset), device.header->nameLength);
+
+  // devices are indexed in capture order
+  if (device.header->device != devices_.size()) return false;
+  devices_.push_back(device);
+  return true;
+}
+
+bool CaptureReader::InitDevice(uint32_t index, struct libevdev* evdev) const {
+  if (index >= devices_.size()) return false;
+  const Device& device = devices_[index];
+
+  libevdev_set_name(evdev, device.name.c_str());
+  libevdev_set_id_bustype(evdev, device.header->bustype);
+  libevdev_set_id_vendor(evdev, device.header->vendor);
+  libevdev_set_id_product(evdev, device.header->product);
+  libevdev_set_id_version(evdev, device.header->version);
+
+  for (unsigned int prop = 0; prop < INPUT_PROP_CNT; prop++) {
+    if (captureTestBit(device.header->props, prop)) libevdev_enable_property(evdev, prop);
+  }
+
+  for (unsigned int type = 0; type < EV_CNT; type++) {
+    if (device.codes[type] == nullptr) continue;
+    libevdev_enable_event_type(evdev, type);
+    if (type == EV_ABS) continue;
+
+    for (unsigned int code = 0; code < KEY_CNT; code++) {
+      if (!captureTestBit(device.codes[type], code)) continue;
+
+      // EV_REP codes carry their value, as in libevdev
+      int repValue = 0;
+      const void* data = nullptr;
+      if (type == EV_REP) data = &repValue;
+      libevdev_enable_event_code(evdev, type, code, data);
+    }
+  }
+
+  for (size_t i = 0; i < device.header->absCount; i++) {
+    const CaptureAbsInfo& absInfo = device.absInfos[i];
+    libevdev_enable_event_code(evdev, EV_ABS, absInfo.code, &absInfo.info);
+  }
+
+  return true;
+}
+
+void CaptureReader::Seek(int64_t timeUs) {
+  // the last block starting at or before timeUs may hold the event
+  auto it = std::upper_bound(blocks_.begin(), blocks_.end(), timeUs,
+    [](int64_t t, const Block& block) { return t < block.timeUs; });
+  block_ = it == blocks_.begin() ? 0 : it - blocks_.begin() - 1;
+  event_ = 0;
+
+  while (block_ < blocks_.size()) {
+    const Block& block = blocks_[block_];
+    while (event_ < block.count && captureEventTimeUs(block.events[event_]) < timeUs) event_++;
+    if (event_ < block.count) return;
+
+    block_++;
+    event_ = 0;
+  }
+}
+
+size_t CaptureReader::Read(int32_t* records, size_t max, int64_t untilUs) {
+  size_t count = 0;
+
+  while (count < max && block_ < blocks_.size()) {
+    const Block& block = blocks_[block_];
+    if (event_ >= block.count) {
+      block_++;
+      event_ = 0;
+      continue;
+    }
+
+    const struct input_event& evdevEvent = block.events[event_];
+    if (captureEventTimeUs(evdevEvent) > untilUs) break;
+
+    int32_t* record = records + count * TAGGED_EVENT_RECORD_SIZE;
+    record[0] = (int32_t)block.device;
+    writeEventRecord(record + 1, evdevEvent);
+    event_++;
+    count++;
+  }
+
+  return count;
+}
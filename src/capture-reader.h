@@ -0,0 +1,73 @@
+#ifndef CAPTURE_READER_H_
+#define CAPTURE_READER_H_
+
+#include <string>
+#include <vector>
+
+#include "capture-format.h"
+
+extern "C" {
+#include <libevdev/libevdev.h>
+}
+
+// CaptureReader reads a capture file (see capture-format.h) through a
+// read-only memory map. Opening the file scans only the block headers to
+// collect the device descriptors and a time index of the events blocks;
+// events are then read in place from the map with a cursor that can be
+// moved to any point in time.
+class CaptureReader {
+ public:
+  struct Device {
+    const CaptureDeviceHeader* header;
+    const uint8_t* codes[EV_CNT];   // code bitmap per type, nullptr if unsupported
+    const CaptureAbsInfo* absInfos;
+    std::string name;
+  };
+
+  CaptureReader();
+  ~CaptureReader();
+
+  // Map path and index its blocks. Returns 0 or -errno,
+  // -EINVAL if the file is not a capture of this host's input_event.
+  int Open(const char* path);
+
+  const std::vector<Device>& devices() const { return devices_; }
+  uint64_t events() const { return events_; }
+  int64_t startUs() const { return startUs_; }
+  int64_t endUs() const { return endUs_; }
+
+  // Apply the capabilities and ids of a recorded device to evdev,
+  // e.g., to create a uinput clone of it.
+  bool InitDevice(uint32_t device, struct libevdev* evdev) const;
+
+  // Move the cursor to the first event at or after timeUs.
+  void Seek(int64_t timeUs);
+
+  // Read events from the cursor as tagged records
+  //    [device, tv_sec, tv_usec, type, code, value]
+  // at most max and none later than untilUs. Returns the number read.
+  size_t Read(int32_t* records, size_t max, int64_t untilUs = INT64_MAX);
+
+ private:
+  struct Block {
+    int64_t timeUs;     // first event time, non-decreasing across blocks
+    uint32_t device;
+    uint32_t count;
+    const struct input_event* events;
+  };
+
+  void Close();
+  bool IndexDevice(const uint8_t* payload, size_t size);
+
+  uint8_t* map_;
+  size_t size_;
+  std::vector<Device> devices_;
+  std::vector<Block> blocks_;
+  uint64_t events_;
+  int64_t startUs_;
+  int64_t endUs_;
+  size_t block_;    // cursor
+  size_t event_;
+};
+
+#endif  // CAPTURE_READER_H_
@@ -0,0 +1,198 @@
+#include <chrono>
+#include <cstring>
+
+#include "capture-writer.h"
+
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+}
+
+static const size_t FLUSH_SIZE = 64 * 1024;
+static const std::chrono::milliseconds FLUSH_INTERVAL(200);
+static const size_t NO_BLOCK = SIZE_MAX;
+
+static void setBit(uint8_t* bits, unsigned int bit) {
+  bits[bit / 8] |= 1 << (bit % 8);
+}
+
+template <typename T>
+static void appendBytes(std::vector<uint8_t>& buffer, const T* data, size_t count = 1) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+}
+
+static int writeAll(int fd, const uint8_t* data, size_t size) {
+  while (size > 0) {
+    ssize_t rc = write(fd, data, size);
+    if (rc < 0) {
+      if (errno == EINTR) continue;
+      return -errno;
+    }
+    data += rc;
+    size -= rc;
+  }
+  return 0;
+}
+
+CaptureWriter::CaptureWriter()
+  : fd_(-1), eventsBlock_(NO_BLOCK), nextDevice_(0), events_(0),
+    stopping_(false), error_(0) {
+}
+
+CaptureWriter::~CaptureWriter() {
+  Close();
+}
+
+int CaptureWriter::Open(const char* path) {
+  fd_ = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0) return -errno;
+
+  CaptureFileHeader header = {};
+  memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+  header.version = CAPTURE_VERSION;
+  header.eventSize = sizeof(struct input_event);
+
+  int result = writeAll(fd_, reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+  if (result < 0) {
+    close(fd_);
+    fd_ = -1;
+    return result;
+  }
+
+  thread_ = std::thread(&CaptureWriter::Run, this);
+  return 0;
+}
+
+uint32_t CaptureWriter::AddDevice(const struct libevdev* evdev) {
+  const char* name = libevdev_get_name(evdev);
+  const size_t nameLength = name != nullptr ? strnlen(name, UINT16_MAX) : 0;
+
+  CaptureDeviceHeader header = {};
+  header.bustype = libevdev_get_id_bustype(evdev);
+  header.vendor = libevdev_get_id_vendor(evdev);
+  header.product = libevdev_get_id_product(evdev);
+  header.version = libevdev_get_id_version(evdev);
+  header.nameLength = nameLength;
+
+  for (unsigned int prop = 0; prop < INPUT_PROP_CNT; prop++) {
+    if (libevdev_has_property(evdev, prop)) setBit(header.props, prop);
+  }
+
+  std::vector<uint8_t> codes;
+  std::vector<CaptureAbsInfo> absInfos;
+
+  for (unsigned int type = 0; type < EV_CNT; type++) {
+    if (!libevdev_has_event_type(evdev, type)) continue;
+    setBit(header.types, type);
+
+    uint8_t bits[CAPTURE_CODE_BYTES] = {};
+    const int max = libevdev_event_type_get_max(type);
+    for (int code = 0; code <= max && code < KEY_CNT; code++) {
+      if (!libevdev_has_event_code(evdev, type, code)) continue;
+      setBit(bits, code);
+
+      if (type == EV_ABS) {
+        CaptureAbsInfo absInfo = {};
+        absInfo.code = code;
+        absInfo.info = *libevdev_get_abs_info(evdev, code);
+        absInfos.push_back(absInfo);
+      }
+    }
+    appendBytes(codes, bits, sizeof(bits));
+  }
+  header.absCount = absInfos.size();
+
+  std::vector<uint8_t> payload;
+  std::lock_guard<std::mutex> lock(mutex_);
+  header.device = nextDevice_++;
+  appendBytes(payload, &header);
+  payload.insert(payload.end(), codes.begin(), codes.end());
+  appendBytes(payload, absInfos.data(), absInfos.size());
+  appendBytes(payload, name, nameLength);
+
+  AppendBlock(CAPTURE_BLOCK_DEVICE, payload);
+  return header.device;
+}
+
+// mutex_ must be held
+void CaptureWriter::AppendBlock(uint32_t kind, const std::vector<uint8_t>& payload) {
+  CaptureBlockHeader header = {kind, (uint32_t)captureAlign(payload.size())};
+  appendBytes(pending_, &header);
+  pending_.insert(pending_.end(), payload.begin(), payload.end());
+  pending_.resize(pending_.size() + header.size - payload.size(), 0);
+  eventsBlock_ = NO_BLOCK;
+}
+
+void CaptureWriter::Append(uint32_t device, const struct input_event* events, size_t count) {
+  static_assert(sizeof(struct input_event) % CAPTURE_ALIGNMENT == 0,
+                "input_event arrays must keep blocks aligned");
+  if (count == 0) return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fd_ < 0 || stopping_) return;
+
+  // extend the last block if it holds events of the same device
+  CaptureEventsHeader* header = nullptr;
+  if (eventsBlock_ != NO_BLOCK) {
+    header = reinterpret_cast<CaptureEventsHeader*>(
+      pending_.data() + eventsBlock_ + sizeof(CaptureBlockHeader));
+    if (header->device != device) header = nullptr;
+  }
+
+  if (header == nullptr) {
+    CaptureEventsHeader eventsHeader = {device, 0};
+    std::vector<uint8_t> payload;
+    appendBytes(payload, &eventsHeader);
+    AppendBlock(CAPTURE_BLOCK_EVENTS, payload);
+    eventsBlock_ = pending_.size() - sizeof(CaptureBlockHeader) - sizeof(CaptureEventsHeader);
+  }
+
+  appendBytes(pending_, events, count);
+  CaptureBlockHeader* block = reinterpret_cast<CaptureBlockHeader*>(pending_.data() + eventsBlock_);
+  header = reinterpret_cast<CaptureEventsHeader*>(block + 1);
+  block->size += count * sizeof(struct input_event);
+  header->count += count;
+  events_ += count;
+
+  if (pending_.size() >= FLUSH_SIZE) wake_.notify_one();
+}
+
+void CaptureWriter::Run() {
+  std::vector<uint8_t> writing;
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    wake_.wait_for(lock, FLUSH_INTERVAL,
+      [this] { return stopping_ || pending_.size() >= FLUSH_SIZE; });
+
+    if (!pending_.empty()) {
+      writing.swap(pending_);
+      eventsBlock_ = NO_BLOCK;
+
+      lock.unlock();
+      int result = error_ == 0 ? writeAll(fd_, writing.data(), writing.size()) : 0;
+      if (result < 0) error_ = result;
+      writing.clear();
+      lock.lock();
+    }
+
+    if (stopping_ && pending_.empty()) return;
+  }
+}
+
+int CaptureWriter::Close() {
+  if (fd_ < 0) return error_;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+
+  close(fd_);
+  fd_ = -1;
+  return error_;
+}
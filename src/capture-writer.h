@@ -0,0 +1,59 @@
+#ifndef CAPTURE_WRITER_H_
+#define CAPTURE_WRITER_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "capture-format.h"
+
+extern "C" {
+#include <libevdev/libevdev.h>
+}
+
+// CaptureWriter records device descriptors and raw input_events into a
+// capture file (see capture-format.h) on a dedicated thread.
+//
+// Blocks are serialized into a pending buffer under a mutex and written
+// by the writer thread once the buffer is large or has waited long enough,
+// so the threads reading devices never block on file I/O. Consecutive
+// events of one device are coalesced into a single events block.
+class CaptureWriter {
+ public:
+  CaptureWriter();
+  ~CaptureWriter();
+
+  // Create or truncate path, write the file header and start the
+  // writer thread. Returns 0 or -errno.
+  int Open(const char* path);
+
+  // Record the descriptor of evdev. Returns the device's capture index.
+  uint32_t AddDevice(const struct libevdev* evdev);
+
+  // Queue events of a device. Thread-safe.
+  void Append(uint32_t device, const struct input_event* events, size_t count);
+
+  // Flush all queued blocks, stop the writer thread and close the file.
+  // Returns 0 or the -errno of the first failed write.
+  int Close();
+
+  uint64_t events() const { return events_; }
+
+ private:
+  void Run();
+  void AppendBlock(uint32_t kind, const std::vector<uint8_t>& payload);
+
+  int fd_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::vector<uint8_t> pending_;    // guarded by mutex_
+  size_t eventsBlock_;              // offset of the last events block in pending_
+  uint32_t nextDevice_;
+  uint64_t events_;
+  bool stopping_;
+  int error_;
+};
+
+#endif  // CAPTURE_WRITER_H_
@@ -0,0 +1,32 @@
+#ifndef DEVICE_HANDLE_H_
+#define DEVICE_HANDLE_H_
+
+#include "event-source.h"
+
+extern "C" {
+#include <libevdev/libevdev.h>
+#include <libevdev/libevdev-uinput.h>
+}
+
+// Native state of a Device, resolved from its JS id by the bindings.
+// Handles created with a JS owner are freed by the owner's finalizer
+// once the owner is collected; releasing one explicitly frees its
+// resources right away and leaves only the handle to the finalizer.
+struct DeviceHandle {
+  int id;
+  int fd;                   // the device node passed to libevdev, -1 if none
+  struct libevdev* evdev;
+  EventSource* source;      // read path state over evdev
+  bool owned;               // freed by the JS owner's finalizer
+  bool released;
+};
+
+// Native state of a UInput, see DeviceHandle.
+struct UInputHandle {
+  int id;
+  struct libevdev_uinput* uinput;
+  bool owned;
+  bool released;
+};
+
+#endif  // DEVICE_HANDLE_H_
@@ -0,0 +1,148 @@
+#include "device-monitor.h"
+
+extern "C" {
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+using namespace Napi;
+
+static const uint32_t WATCH_MASK =
+  IN_CREATE | IN_ATTRIB | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM | IN_ONLYDIR;
+
+static void CallJs(Env env, Function callback, MonitorEvent* event) {
+  if (env != nullptr && callback != nullptr) {
+    int token = 0;
+    if (event->kind == MONITOR_DEVICE_ADDED) {
+      token = storeProbedDevice(event->probed);
+      event->probed.evdev = nullptr;
+      event->probed.fd = -1;
+    }
+
+    callback.Call({Number::New(env, event->kind),
+                   String::New(env, event->probed.path),
+                   Number::New(env, token)});
+  }
+
+  // not adopted if JS is gone
+  releaseProbedDevice(&event->probed);
+  delete event;
+}
+
+DeviceMonitor::DeviceMonitor(Env env, Function callback)
+  : inotifyFd_(-1), wakeFd_(-1) {
+  tsfn_ = ThreadSafeFunction::New(env, callback, "DeviceMonitor", 0, 1);
+}
+
+DeviceMonitor::~DeviceMonitor() {
+  Stop();
+  tsfn_.Release();
+}
+
+int DeviceMonitor::Start(const std::string& dir) {
+  dir_ = dir;
+  inotifyFd_ = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+  if (inotifyFd_ < 0) return -errno;
+
+  if (inotify_add_watch(inotifyFd_, dir.c_str(), WATCH_MASK) < 0) {
+    int error = -errno;
+    close(inotifyFd_);
+    inotifyFd_ = -1;
+    return error;
+  }
+
+  // nodes present before the watch are the caller's to load (loadDevices),
+  // they are known so that IN_ATTRIB does not report them as added
+  Scan();
+
+  wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  thread_ = std::thread(&DeviceMonitor::Run, this);
+  return 0;
+}
+
+void DeviceMonitor::Stop() {
+  if (thread_.joinable()) {
+    uint64_t one = 1;
+    if (write(wakeFd_, &one, sizeof(one)) < 0) {
+      // eventfd write only fails on counter overflow, the thread is awake anyway
+    }
+    thread_.join();
+  }
+
+  if (inotifyFd_ >= 0) close(inotifyFd_);
+  if (wakeFd_ >= 0) close(wakeFd_);
+  inotifyFd_ = -1;
+  wakeFd_ = -1;
+}
+
+void DeviceMonitor::Run() {
+  alignas(struct inotify_event) char buffer[4096];
+
+  while (true) {
+    struct pollfd fds[2] = {{inotifyFd_, POLLIN, 0}, {wakeFd_, POLLIN, 0}};
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+    if (fds[1].revents & POLLIN) return;
+
+    ssize_t length = read(inotifyFd_, buffer, sizeof(buffer));
+    if (length < 0) {
+      if (errno == EINTR || errno == EAGAIN) continue;
+      return;
+    }
+
+    for (char* ptr = buffer; ptr < buffer + length;) {
+      const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+      ptr += sizeof(struct inotify_event) + event->len;
+      if (event->len == 0 || (event->mask & IN_ISDIR)) continue;
+
+      const std::string path = dir_ + "/" + event->name;
+      if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        // the caller may hold nodes the monitor never probed, it filters
+        known_.erase(path);
+        Deliver(new MonitorEvent{MONITOR_DEVICE_REMOVED, ProbedDevice{path, -1, nullptr}});
+      } else if (known_.count(path) == 0) {
+        // IN_CREATE may come before udev grants access, retry on IN_ATTRIB
+        Probe(path);
+      }
+    }
+  }
+}
+
+void DeviceMonitor::Scan() {
+  DIR* dir = opendir(dir_.c_str());
+  if (dir == nullptr) return;
+
+  while (const struct dirent* entry = readdir(dir)) {
+    const std::string path = dir_ + "/" + entry->d_name;
+    struct stat st;
+    // a node not yet accessible is probed once IN_ATTRIB reports access
+    if (stat(path.c_str(), &st) == 0 && S_ISCHR(st.st_mode) &&
+        access(path.c_str(), R_OK) == 0) {
+      known_.insert(path);
+    }
+  }
+
+  closedir(dir);
+}
+
+void DeviceMonitor::Probe(const std::string& path) {
+  ProbedDevice probed;
+  if (probeDevice(path, &probed) < 0) return;
+
+  known_.insert(path);
+  Deliver(new MonitorEvent{MONITOR_DEVICE_ADDED, probed});
+}
+
+void DeviceMonitor::Deliver(MonitorEvent* event) {
+  if (tsfn_.NonBlockingCall(event, CallJs) != napi_ok) {
+    releaseProbedDevice(&event->probed);
+    delete event;
+  }
+}
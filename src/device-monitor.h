@@ -0,0 +1,51 @@
+#ifndef DEVICE_MONITOR_H_
+#define DEVICE_MONITOR_H_
+
+#include <set>
+#include <string>
+#include <thread>
+
+#include "napi.h"
+#include "device-probe.h"
+
+// DeviceMonitor notifications
+static const int MONITOR_DEVICE_ADDED = 1;
+static const int MONITOR_DEVICE_REMOVED = 2;
+
+struct MonitorEvent {
+  int kind;
+  ProbedDevice probed;  // path only for MONITOR_DEVICE_REMOVED
+};
+
+// DeviceMonitor watches a device directory, e.g., /dev/input, with inotify
+// on a dedicated thread. A node that appears, or becomes accessible once
+// udev has set its permissions, is opened and probed with libevdev on that
+// thread; the JS callback then receives a token to adopt it with:
+//    callback(MONITOR_DEVICE_ADDED, path, token)
+// A node that disappears, whether or not it was reported as added, is
+// reported as
+//    callback(MONITOR_DEVICE_REMOVED, path, 0)
+class DeviceMonitor {
+ public:
+  DeviceMonitor(Napi::Env env, Napi::Function callback);
+  ~DeviceMonitor();
+
+  // Start watching dir. Returns 0 or -errno.
+  int Start(const std::string& dir);
+  void Stop();
+
+ private:
+  void Run();
+  void Scan();
+  void Probe(const std::string& path);
+  void Deliver(MonitorEvent* event);
+
+  std::string dir_;
+  int inotifyFd_;
+  int wakeFd_;
+  std::thread thread_;
+  std::set<std::string> known_;  // present or probed paths, monitor thread only
+  Napi::ThreadSafeFunction tsfn_;
+};
+
+#endif  // DEVICE_MONITOR_H_
@@ -0,0 +1,57 @@
+#include <map>
+#include <mutex>
+
+#include "device-probe.h"
+
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+}
+
+// shared by all environments, guarded by PROBED_MUTEX
+static std::mutex PROBED_MUTEX;
+static std::map<int, ProbedDevice> PROBED_MAP;
+static int NEXT_PROBE_TOKEN = 1;
+
+int probeDevice(const std::string& path, ProbedDevice* probed) {
+  probed->path = path;
+  probed->evdev = nullptr;
+
+  // opened blocking like fs.openSync(file, 'r'), Device streams need it
+  probed->fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (probed->fd < 0) return -errno;
+
+  int result = libevdev_new_from_fd(probed->fd, &probed->evdev);
+  if (result < 0) {
+    close(probed->fd);
+    probed->fd = -1;
+    probed->evdev = nullptr;
+  }
+
+  return result;
+}
+
+void releaseProbedDevice(ProbedDevice* probed) {
+  if (probed->evdev != nullptr) libevdev_free(probed->evdev);
+  if (probed->fd >= 0) close(probed->fd);
+  probed->evdev = nullptr;
+  probed->fd = -1;
+}
+
+int storeProbedDevice(const ProbedDevice& probed) {
+  std::lock_guard<std::mutex> lock(PROBED_MUTEX);
+  const int token = NEXT_PROBE_TOKEN++;
+  PROBED_MAP.insert(std::pair<int,ProbedDevice>(token, probed));
+  return token;
+}
+
+bool takeProbedDevice(int token, ProbedDevice* probed) {
+  std::lock_guard<std::mutex> lock(PROBED_MUTEX);
+  auto it = PROBED_MAP.find(token);
+  if (it == PROBED_MAP.end()) return false;
+
+  *probed = it->second;
+  PROBED_MAP.erase(it);
+  return true;
+}
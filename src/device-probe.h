@@ -0,0 +1,34 @@
+#ifndef DEVICE_PROBE_H_
+#define DEVICE_PROBE_H_
+
+#include <string>
+
+extern "C" {
+#include <libevdev/libevdev.h>
+}
+
+// A device node opened and initialized with libevdev off the JS thread,
+// waiting to be adopted by a Device.
+struct ProbedDevice {
+  std::string path;
+  int fd;
+  struct libevdev* evdev;
+};
+
+// Open path and initialize a libevdev for it. May be called from any
+// thread. Returns 0 or -errno, e.g., -ENOTTY if path is not an evdev node.
+int probeDevice(const std::string& path, ProbedDevice* probed);
+
+// Close the fd and free the libevdev of probed.
+void releaseProbedDevice(ProbedDevice* probed);
+
+// Hold a probed device until it is adopted, returns its token.
+// The store is process-wide and thread-safe: a device stored by one
+// environment may be adopted by another, e.g., a worker_thread.
+int storeProbedDevice(const ProbedDevice& probed);
+
+// Remove the probed device of token from the store.
+// Returns false if there is none.
+bool takeProbedDevice(int token, ProbedDevice* probed);
+
+#endif  // DEVICE_PROBE_H_
@@ -1,13 +1,23 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
-#include <map>
 #include <string>
+#include <vector>
 
 #include "napi.h"
+#include "evdevjs.h"
+#include "addon-data.h"
+#include "device-probe.h"
+#include "probe-worker.h"
+#include "event-source.h"
+#include "input-code-names.h"
 
 extern "C" {
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
+#include <unistd.h>
 #include <linux/input.h>
 #include <libevdev/libevdev.h>
 #include <libevdev/libevdev-uinput.h>
@@ -17,8 +27,9 @@ using namespace Napi;
 using namespace std;
 
 
-static std::map<int, libevdev*> LIBEVDEV_MAP;
-static std::map<int, libevdev_uinput*> UINPUT_MAP;
+static inline AddonData* addonData(Env env) {
+  return env.GetInstanceData<AddonData>();
+}
 
 
 Object createDeviceInfo(Env env, libevdev *evdev) {
@@ -39,22 +50,70 @@ Object createDeviceInfo(Env env, libevdev *evdev) {
   return deviceInfo;
 }
 
+// Throw for an id without a native object, e.g., one already released.
+static Value unknownHandle(Env env, const char* kind) {
+  Error::New(env, std::string("Unknown ") + kind + " id").ThrowAsJavaScriptException();
+  return env.Null();
+}
+
+// Free the libevdev and read path state of device. The handle itself is
+// left to the JS owner's finalizer, if it has one.
+static void releaseDevice(AddonData* data, DeviceHandle* device) {
+  data->devices.Take(device->id);
+
+  // stop any reader thread from draining the device before it is freed
+  data->readers.ForEach([device](int, EventReader* reader) {
+    reader->Remove(device->id);
+  });
+
+  delete device->source;
+  libevdev_free(device->evdev);
+  device->source = nullptr;
+  device->evdev = nullptr;
+  device->released = true;
+
+  if (!device->owned) delete device;
+}
+
+static void finalizeDevice(Env env, DeviceHandle* device) {
+  if (device->released) {
+    delete device;
+    return;
+  }
+
+  // collected without close(), nothing in JS uses the device node either
+  if (device->fd >= 0) close(device->fd);
+  device->owned = false;
+  releaseDevice(addonData(env), device);
+}
+
 Value NewLibevdev(const CallbackInfo& info) {
   Env env = info.Env();
 
-  if (info.Length() != 1) {
+  if (info.Length() != 1 && info.Length() != 2) {
     TypeError::New(env, "Wrong number of arguments")
         .ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!info[0].IsNumber()) {
+  if (!info[0].IsNumber() || (info.Length() == 2 && !info[1].IsObject())) {
     TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
     return env.Null();
   }
 
+  AddonData* data = addonData(env);
   int devid = info[0].As<Number>().Uint32Value();
-  LIBEVDEV_MAP.insert(std::pair<int,libevdev*>(devid, libevdev_new()));
+  if (data->devices.Get(devid) != nullptr) return Boolean::New(env, false);
+
+  struct libevdev* evdev = libevdev_new();
+  DeviceHandle* device = new DeviceHandle{devid, -1, evdev, new EventSource(evdev), false, false};
+  data->devices.Put(devid, device);
+
+  // the optional owner, i.e., the JS Device, frees the handle once collected
+  if (info.Length() == 2) {
+    device->owned = true;
+    info[1].As<Object>().AddFinalizer(finalizeDevice, device);
+  }
 
   return Boolean::New(env,true);
 }
@@ -74,9 +133,187 @@ Value ReleaseLibevdev(const CallbackInfo& info) {
   }
 
   const int devid = info[0].As<Number>().Uint32Value();
-  struct libevdev* evdev = LIBEVDEV_MAP.at(devid);
-  LIBEVDEV_MAP.erase(devid);
-  libevdev_free(evdev);
+  AddonData* data = addonData(env);
+  DeviceHandle* device = data->devices.Get(devid);
+  if (device != nullptr) releaseDevice(data, device);
+
+  return env.Undefined();
+}
+
+Value AdoptProbedDevice(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 2) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsNumber()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int devid = info[1].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+
+  ProbedDevice probed;
+  const int token = info[0].As<Number>().Int32Value();
+  if (!takeProbedDevice(token, &probed)) return Number::New(env, -1);
+
+  // replace the empty libevdev created by NewLibevdev
+  delete device->source;
+  libevdev_free(device->evdev);
+
+  device->fd = probed.fd;
+  device->evdev = probed.evdev;
+  device->source = new EventSource(probed.evdev);
+  device->source->UseMonotonicClock();
+
+  return Number::New(env, probed.fd);
+}
+
+Value DetachDevice(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 2) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsString()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  AddonData* data = addonData(env);
+  const int devid = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = data->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  if (device->fd < 0) return Number::New(env, -EBADF);
+
+  // the stored duplicate shares the open file description, including a grab,
+  // and stays open when the detached Device closes its own fd
+  const int fd = fcntl(device->fd, F_DUPFD_CLOEXEC, 0);
+  if (fd < 0) return Number::New(env, -errno);
+
+  data->readers.ForEach([devid](int, EventReader* reader) {
+    reader->Remove(devid);
+  });
+
+  ProbedDevice detached;
+  detached.path = info[1].As<String>().Utf8Value();
+  detached.fd = fd;
+  detached.evdev = device->evdev;
+  libevdev_change_fd(detached.evdev, fd);
+
+  // the Device keeps an empty libevdev until it is closed
+  delete device->source;
+  device->evdev = libevdev_new();
+  device->source = new EventSource(device->evdev);
+
+  return Number::New(env, storeProbedDevice(detached));
+}
+
+Value ReleaseProbedDevice(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 1) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber()) {
+    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  ProbedDevice probed;
+  if (takeProbedDevice(info[0].As<Number>().Int32Value(), &probed)) {
+    releaseProbedDevice(&probed);
+  }
+
+  return env.Undefined();
+}
+
+Value ProbeDevices(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 1) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsArray()) {
+    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Array pathsJs = info[0].As<Array>();
+  std::vector<std::string> paths;
+  for (uint32_t i = 0; i < pathsJs.Length(); i++) {
+    Value path = pathsJs.Get(i);
+    if (!path.IsString()) {
+      TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    paths.push_back(path.As<String>().Utf8Value());
+  }
+
+  // the worker deletes itself once the promise is settled
+  ProbeWorker* worker = new ProbeWorker(env, paths);
+  worker->Queue();
+
+  return worker->Promise();
+}
+
+Value NewDeviceMonitor(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 3) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsString() || !info[2].IsFunction()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int monitorid = info[0].As<Number>().Uint32Value();
+  DeviceMonitor* monitor = new DeviceMonitor(env, info[2].As<Function>());
+
+  int result = monitor->Start(info[1].As<String>().Utf8Value());
+  if (result < 0) {
+    delete monitor;
+  } else {
+    addonData(env)->monitors.Put(monitorid, monitor);
+  }
+
+  return Number::New(env, result);
+}
+
+Value ReleaseDeviceMonitor(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 1) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber()) {
+    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int monitorid = info[0].As<Number>().Uint32Value();
+  delete addonData(env)->monitors.Take(monitorid);
 
   return env.Undefined();
 }
@@ -96,10 +333,16 @@ Value SetFD(const CallbackInfo& info) {
   }
 
   const int devid = info[0].As<Number>().Uint32Value();
-  struct libevdev* evdev = LIBEVDEV_MAP.at(devid);
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  struct libevdev* evdev = device->evdev;
   const int fd = info[1].As<Number>().Int32Value();
   
   bool result = libevdev_set_fd(evdev, fd) == 0 ? true : false;
+  if (result) {
+    device->fd = fd;
+    device->source->UseMonotonicClock();
+  }
 
   return Boolean::New(env, result);
 }
@@ -119,7 +362,9 @@ Value GetDeviceInfo(const CallbackInfo& info) {
   }
 
   int devid = info[0].As<Number>().Uint32Value();
-  struct libevdev *evdev = LIBEVDEV_MAP.at(devid);
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  struct libevdev *evdev = device->evdev;
 
   return createDeviceInfo(env, evdev);
 }
@@ -140,14 +385,76 @@ Value Grab(const CallbackInfo& info) {
 
   const int devid = info[0].As<Number>().Uint32Value();
   const bool enabled = info[1].As<Boolean>().Value();
-  struct libevdev* evdev = LIBEVDEV_MAP.at(devid);
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  struct libevdev* evdev = device->evdev;
 
   bool result = libevdev_grab(evdev, enabled ? LIBEVDEV_GRAB : LIBEVDEV_UNGRAB) == 0 ? true : false;
 
   return Boolean::New(env, result);
 }
 
-Value GetCapabilities(const CallbackInfo& info) {
+static void setBit(uint8_t* bits, unsigned int bit) {
+  bits[bit / 8] |= 1 << (bit % 8);
+}
+
+Object createCapabilityBits(Env env, const libevdev *evdev) {
+  Uint8Array types = Uint8Array::New(env, EV_CNT / 8);
+  Array codes = Array::New(env);
+  Int32Array absInfo = Int32Array::New(env, ABS_CNT * ABS_INFO_SIZE);
+  memset(types.Data(), 0, types.ByteLength());
+  memset(absInfo.Data(), 0, absInfo.ByteLength());
+
+  for (uint32_t typeCode = 0; typeCode < EV_CNT; typeCode++) {
+    const int max = libevdev_event_type_get_max(typeCode);
+    if (max < 0 || !libevdev_has_event_type(evdev, typeCode)) {
+      codes.Set(typeCode, env.Null());
+      continue;
+    }
+    setBit(types.Data(), typeCode);
+
+    Uint8Array typeCodes = Uint8Array::New(env, max / 8 + 1);
+    memset(typeCodes.Data(), 0, typeCodes.ByteLength());
+    for (int code = 0; code <= max; code++) {
+      if (libevdev_has_event_code(evdev, typeCode, code)) setBit(typeCodes.Data(), code);
+    }
+    codes.Set(typeCode, typeCodes);
+  }
+
+  // absinfo only exists for EV_ABS codes
+  for (uint32_t code = 0; code < ABS_CNT; code++) {
+    if (!libevdev_has_event_code(evdev, EV_ABS, code)) continue;
+
+    const struct input_absinfo* info = libevdev_get_abs_info(evdev, code);
+    int32_t* record = absInfo.Data() + code * ABS_INFO_SIZE;
+    record[0] = info->value;
+    record[1] = info->minimum;
+    record[2] = info->maximum;
+    record[3] = info->fuzz;
+    record[4] = info->flat;
+    record[5] = info->resolution;
+  }
+
+  Object capabilities = Object::New(env);
+  capabilities.Set("types", types);
+  capabilities.Set("codes", codes);
+  capabilities.Set("absInfo", absInfo);
+  return capabilities;
+}
+
+Array createProperties(Env env, const libevdev *evdev) {
+  Array properties = Array::New(env);
+
+  for (uint32_t prop = 0; prop < INPUT_PROP_CNT; prop++) {
+    if (libevdev_has_property(evdev, prop)) {
+      properties.Set(properties.Length(), Number::New(env, prop));
+    }
+  }
+
+  return properties;
+}
+
+Value GetCapabilityBits(const CallbackInfo& info) {
   Env env = info.Env();
 
   if (info.Length() != 1) {
@@ -162,54 +469,11 @@ Value GetCapabilities(const CallbackInfo& info) {
   }
 
   const int devid = info[0].As<Number>().Uint32Value();
-  const struct libevdev *evdev = LIBEVDEV_MAP.at(devid);
-  Array capabilities = Array::New(env);
-
-  for (uint32_t typeCode=1; typeCode < EV_MAX; typeCode++) {
-    if (!libevdev_has_event_type(evdev, typeCode)) continue;
-    if (strcmp("EV_SYN", libevdev_event_type_get_name(typeCode)) == 0) continue;
-    //cout << "type: " << libevdev_event_type_get_name(typeCode) << "\n";
-
-    uint32_t max_codes = libevdev_event_type_get_max(typeCode);
-    if (max_codes < 1) continue;
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  const struct libevdev *evdev = device->evdev;
 
-    Object capability = Object::New(env);
-    capability.Set("code", (double)typeCode);
-    Array events = Array::New(env);
-    capability.Set("events",events);
-
-    for (uint32_t code=0; code < max_codes; code++) {
-      if (!libevdev_has_event_code(evdev, typeCode, code)) continue;
-
-      Object eventDescriptor = Object::New(env);
-      eventDescriptor.Set("code", (double)code);
-
-      const struct input_absinfo* absinfo = libevdev_get_abs_info(evdev,code);
-      if (absinfo != nullptr) {
-          // cout << "found: " << typeCode << "," << libevdev_event_code_get_name(typeCode,code) << " has-absinfo\n";
-          // code
-          // min     -32768
-          // max      32767
-          // fuzz        16
-          // flat       128
-          // resolution   0
-          Object absinfoJs = Object::New(env);
-          absinfoJs.Set("min", (double)absinfo->minimum);
-          absinfoJs.Set("max", (double)absinfo->maximum);
-          absinfoJs.Set("fuzz", (double)absinfo->fuzz);
-          absinfoJs.Set("flat", (double)absinfo->flat);
-          absinfoJs.Set("resolution", (double)absinfo->resolution);
-
-          eventDescriptor.Set("absInfo", absinfoJs);
-      }
-
-      events.Set(events.Length(), eventDescriptor);
-    }
-
-     capabilities.Set(capabilities.Length(), capability);
-  }
-
-  return capabilities;
+  return createCapabilityBits(env, evdev);
 }
 
 Value HasProperty(const CallbackInfo& info) {
@@ -227,7 +491,9 @@ Value HasProperty(const CallbackInfo& info) {
   }
 
   const int devid = info[0].As<Number>().Uint32Value();
-  const struct libevdev *evdev = LIBEVDEV_MAP.at(devid);
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  const struct libevdev *evdev = device->evdev;
   const uint32_t propCode = info[1].As<Number>().Uint32Value() == 1 ? true : false;
 
   bool result = libevdev_has_property(evdev, propCode) == 1 ? true : false;
@@ -250,7 +516,9 @@ Value HasType(const CallbackInfo& info) {
   }
 
   const int devid = info[0].As<Number>().Uint32Value();
-  const struct libevdev *evdev = LIBEVDEV_MAP.at(devid);
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  const struct libevdev *evdev = device->evdev;
   const uint32_t typeCode = info[1].As<Number>().Uint32Value();
 
   bool result = libevdev_has_event_type(evdev, typeCode) == 1 ? true : false;
@@ -273,7 +541,9 @@ Value HasCode(const CallbackInfo& info) {
   }
 
   const int devid = info[0].As<Number>().Uint32Value();
-  const struct libevdev *evdev = LIBEVDEV_MAP.at(devid);
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  const struct libevdev *evdev = device->evdev;
   const uint32_t typeCode = info[1].As<Number>().Uint32Value();
   const uint32_t code = info[2].As<Number>().Uint32Value();
 
@@ -297,7 +567,9 @@ Value EnableEventType(const CallbackInfo& info) {
   }
 
   const int devid = info[0].As<Number>().Uint32Value();
-  struct libevdev *evdev = LIBEVDEV_MAP.at(devid);
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  struct libevdev *evdev = device->evdev;
   const uint32_t typeCode = info[1].As<Number>().Uint32Value();
   const bool enabled = info[2].As<Boolean>().Value();
 
@@ -324,7 +596,9 @@ Value EnableEventCode(const CallbackInfo& info) {
   }
 
   const int devid = info[0].As<Number>().Uint32Value();
-  struct libevdev *evdev = LIBEVDEV_MAP.at(devid);
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  struct libevdev *evdev = device->evdev;
   const uint32_t typeCode = info[1].As<Number>().Uint32Value();
   const uint32_t code = info[2].As<Number>().Uint32Value();
   const bool enabled = info[3].As<Boolean>().Value();
@@ -333,14 +607,16 @@ Value EnableEventCode(const CallbackInfo& info) {
 
   if (enabled) {
 
-    int refinfo;
-    struct input_absinfo absinfo;
+    // libevdev takes data only for EV_ABS (absinfo) and EV_REP (the
+    // delay or period), any other type is rejected with data set
+    int repValue = 0;
+    struct input_absinfo absinfo = {};
     void* data = nullptr;
 
     if (typeCode == EV_ABS) {
       data = &absinfo;
-    } else if (typeCode == EV_REL) {
-      data = &refinfo;
+    } else if (typeCode == EV_REP) {
+      data = &repValue;
     }
 
     result = libevdev_enable_event_code(evdev, typeCode, code, data) == 0 ? true : false;
@@ -366,7 +642,9 @@ Value EnableProperty(const CallbackInfo& info) {
   }
 
   const int devid = info[0].As<Number>().Uint32Value();
-  struct libevdev *evdev = LIBEVDEV_MAP.at(devid);
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  struct libevdev *evdev = device->evdev;
   const uint32_t propertyCode = info[1].As<Number>().Uint32Value();
   const bool enabled = info[2].As<Boolean>().Value();
 
@@ -378,6 +656,127 @@ Value EnableProperty(const CallbackInfo& info) {
   return Boolean::New(env, result);
 }
 
+void writeEventRecord(int32_t* record, const struct input_event& evdevEvent) {
+  record[0] = (int32_t)evdevEvent.time.tv_sec;
+  record[1] = (int32_t)evdevEvent.time.tv_usec;
+  record[2] = (int32_t)evdevEvent.type;
+  record[3] = (int32_t)evdevEvent.code;
+  record[4] = (int32_t)evdevEvent.value;
+}
+
+// Resolve an Int32Array or ArrayBuffer argument to its int32 storage.
+// Returns false if value is neither.
+bool getInt32Buffer(const Value& value, int32_t** data, size_t* length) {
+  if (value.IsTypedArray()) {
+    TypedArray array = value.As<TypedArray>();
+    if (array.TypedArrayType() != napi_int32_array) return false;
+
+    Int32Array int32Array = value.As<Int32Array>();
+    *data = int32Array.Data();
+    *length = int32Array.ElementLength();
+    return true;
+  }
+
+  if (value.IsArrayBuffer()) {
+    ArrayBuffer arrayBuffer = value.As<ArrayBuffer>();
+    *data = static_cast<int32_t*>(arrayBuffer.Data());
+    *length = arrayBuffer.ByteLength() / sizeof(int32_t);
+    return true;
+  }
+
+  return false;
+}
+
+// Resolve an optional typed array argument of the given type to its storage.
+// Returns false if value is neither null/undefined nor such an array.
+template <typename T>
+bool getOptionalTypedArray(const Value& value, napi_typedarray_type type, T** data, size_t* length) {
+  *data = nullptr;
+  *length = 0;
+  if (value.IsNull() || value.IsUndefined()) return true;
+  if (!value.IsTypedArray() || value.As<TypedArray>().TypedArrayType() != type) return false;
+
+  TypedArrayOf<T> array = value.As<TypedArrayOf<T>>();
+  *data = array.Data();
+  *length = array.ElementLength();
+  return true;
+}
+
+Value SetEventFilter(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 2) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsBoolean()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int devid = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  EventSource* source = device->source;
+  const bool enabled = info[1].As<Boolean>().Value();
+
+  // enabling starts from an empty mask, nothing passes until accepted
+  source->SetFilter(enabled);
+
+  return Boolean::New(env, true);
+}
+
+Value FilterEventType(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 3) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsBoolean()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int devid = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  EventSource* source = device->source;
+  const uint32_t typeCode = info[1].As<Number>().Uint32Value();
+  const bool accepted = info[2].As<Boolean>().Value();
+
+  return Boolean::New(env, source->SetFilterType(typeCode, accepted));
+}
+
+Value FilterEventCode(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 4) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsBoolean()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int devid = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  EventSource* source = device->source;
+  const uint32_t typeCode = info[1].As<Number>().Uint32Value();
+  const uint32_t code = info[2].As<Number>().Uint32Value();
+  const bool accepted = info[3].As<Boolean>().Value();
+
+  return Boolean::New(env, source->SetFilterCode(typeCode, code, accepted));
+}
+
 Value NextEvent(const CallbackInfo& info) {
   const Env env = info.Env();
 
@@ -393,23 +792,30 @@ Value NextEvent(const CallbackInfo& info) {
   }
 
   const int devId = info[0].As<Number>().Uint32Value();
-  struct libevdev *evdev = LIBEVDEV_MAP.at(devId);
+  DeviceHandle* device = addonData(env)->devices.Get(devId);
+  if (device == nullptr) return unknownHandle(env, "device");
+  EventSource* source = device->source;
   struct input_event evdevEvent;
 
-  int result = libevdev_next_event(evdev, LIBEVDEV_READ_FLAG_NORMAL, &evdevEvent);
-
-  if (result == LIBEVDEV_READ_STATUS_SYNC) {
-    // If a device needs to be synced by the caller but the caller does not call
-    // with the LIBEVDEV_READ_STATUS_SYNC flag set, all events from the diff are
-    // dropped and event processing continues as normal.
-    result = libevdev_next_event(evdev, LIBEVDEV_READ_FLAG_NORMAL, &evdevEvent);
+  // after SYN_DROPPED this returns the sync diff events, see EventSource::Next();
+  // skipping filtered events, Pending() keeps a blocking fd from stalling
+  // once the kernel queue is empty, as in NextEvents
+  bool read = false;
+  while (!read && source->Pending() > 0) {
+    if (source->Next(&evdevEvent) < 0) break;
+    read = source->Deliverable(evdevEvent);
   }
+  source->EndBatch();
 
-  if (result == -EAGAIN) {
+  if (!read) {
     // no event read
     return env.Null();
   }
 
+  int32_t record[EVENT_RECORD_SIZE];
+  writeEventRecord(record, evdevEvent);
+  source->Delivered(record, EVENT_RECORD_SIZE, READ_EVENTS);
+
   // input_event
   //    time: time {tv_sec, tv_usec}
   //    __u16 type
@@ -427,64 +833,920 @@ Value NextEvent(const CallbackInfo& info) {
   return event;
 }
 
-Value TypeForName(const CallbackInfo& info) {
-  Env env = info.Env();
+Value NextEvents(const CallbackInfo& info) {
+  const Env env = info.Env();
 
-  if (info.Length() != 1) {
+  if (info.Length() != 2) {
     TypeError::New(env, "Wrong number of arguments")
         .ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!info[0].IsString()) {
-    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+  int32_t* records;
+  size_t length;
+  if (!info[0].IsNumber() || !getInt32Buffer(info[1], &records, &length)) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  int type = libevdev_event_type_from_name(info[0].As<String>().Utf8Value().c_str());
+  const int devId = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devId);
+  if (device == nullptr) return unknownHandle(env, "device");
+  EventSource* source = device->source;
+  const size_t capacity = length / EVENT_RECORD_SIZE;
+  struct input_event evdevEvent;
+  size_t count = 0;
+
+  // drain every pending event, Pending() keeps a blocking fd
+  // from stalling once the kernel queue is empty; coalesced frames
+  // held are only passed on once due, with the next read
+  source->FlushCoalesced(EventStats::NowUs());
+  while (count < capacity && source->Pending() > 0) {
+    if (source->Next(&evdevEvent) < 0) break;
+    if (!source->Deliverable(evdevEvent)) continue;
+
+    writeEventRecord(records + count * EVENT_RECORD_SIZE, evdevEvent);
+    count++;
+  }
+  source->EndBatch();
+  source->Delivered(records, count * EVENT_RECORD_SIZE, READ_EVENTS);
 
-  return Number::New(env, (double)type);
+  return Number::New(env, (double)count);
 }
 
-Value NameForType(const CallbackInfo& info) {
-  Env env = info.Env();
+Value NextFrames(const CallbackInfo& info) {
+  const Env env = info.Env();
 
-  if (info.Length() != 1) {
+  if (info.Length() != 2) {
     TypeError::New(env, "Wrong number of arguments")
         .ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!info[0].IsNumber()) {
-    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+  int32_t* frames;
+  size_t length;
+  if (!info[0].IsNumber() || !getInt32Buffer(info[1], &frames, &length)) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int devId = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devId);
+  if (device == nullptr) return unknownHandle(env, "device");
+  EventSource* source = device->source;
+
+  // frames completed by an earlier call that did not fit are returned first
+  source->FlushCoalesced(EventStats::NowUs());
+  const int status = source->ReadFrames();
+  if (source->NextFrameSize() > length) {
+    RangeError::New(env, "Frame exceeds buffer length").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  const char* name = libevdev_event_type_get_name((unsigned int)info[0].As<Number>().Uint32Value() );
+  const size_t taken = source->TakeFrames(frames, length);
+  source->Delivered(frames, taken, READ_FRAMES);
+
+  // a read error, as a negative errno, once the frames read before it are taken
+  if (taken == 0 && status < 0) return Number::New(env, (double)status);
 
-  return String::New(env, name);
+  return Number::New(env, (double)taken);
 }
 
-Value CodeForName(const CallbackInfo& info) {
-  Env env = info.Env();
+Value NextTouchFrames(const CallbackInfo& info) {
+  const Env env = info.Env();
 
-  if (info.Length() != 1) {
+  if (info.Length() != 2) {
     TypeError::New(env, "Wrong number of arguments")
         .ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (!info[0].IsString()) {
-    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+  int32_t* frames;
+  size_t length;
+  if (!info[0].IsNumber() || !getInt32Buffer(info[1], &frames, &length)) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  int code = libevdev_event_code_from_code_name(info[0].As<String>().Utf8Value().c_str());
+  const int devId = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devId);
+  if (device == nullptr) return unknownHandle(env, "device");
+  EventSource* source = device->source;
+
+  // touch frames completed by an earlier call that did not fit are returned first
+  const int status = source->ReadTouchFrames();
+  if (source->touches().NextFrameSize() > length) {
+    RangeError::New(env, "Touch frame exceeds buffer length").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const size_t taken = source->touches().TakeFrames(frames, length);
+  source->Delivered(frames, taken, READ_TOUCH_FRAMES);
+
+  // a read error, as in NextFrames
+  if (taken == 0 && status < 0) return Number::New(env, (double)status);
+
+  return Number::New(env, (double)taken);
+}
+
+// SetHotkeys(devId, hotkeys, stepTimeoutMs)
+// Replace the hotkeys matched by NextHotkeys and READ_HOTKEYS readers:
+// [{id, steps: number[][]}], each step the key codes of a chord.
+// Returns false if a hotkey is invalid.
+Value SetHotkeys(const CallbackInfo& info) {
+  const Env env = info.Env();
+
+  if (info.Length() != 3) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsArray() || !info[2].IsNumber()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int devId = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devId);
+  if (device == nullptr) return unknownHandle(env, "device");
+
+  std::vector<HotkeyPattern> hotkeys;
+  const Array hotkeysJs = info[1].As<Array>();
+  for (uint32_t i = 0; i < hotkeysJs.Length(); i++) {
+    if (!hotkeysJs.Get(i).IsObject()) return Boolean::New(env, false);
+
+    const Object hotkeyJs = hotkeysJs.Get(i).As<Object>();
+    if (!hotkeyJs.Get("id").IsNumber() || !hotkeyJs.Get("steps").IsArray()) return Boolean::New(env, false);
+
+    HotkeyPattern hotkey{hotkeyJs.Get("id").As<Number>().Int32Value(), {}};
+    const Array stepsJs = hotkeyJs.Get("steps").As<Array>();
+    for (uint32_t j = 0; j < stepsJs.Length(); j++) {
+      if (!stepsJs.Get(j).IsArray()) return Boolean::New(env, false);
+
+      const Array keysJs = stepsJs.Get(j).As<Array>();
+      std::vector<unsigned int> keys;
+      for (uint32_t k = 0; k < keysJs.Length(); k++) {
+        if (!keysJs.Get(k).IsNumber()) return Boolean::New(env, false);
+        keys.push_back(keysJs.Get(k).As<Number>().Uint32Value());
+      }
+      hotkey.steps.push_back(keys);
+    }
+    hotkeys.push_back(hotkey);
+  }
+
+  const int64_t stepTimeoutUs = (int64_t)(info[2].As<Number>().DoubleValue() * 1000);
+  return Boolean::New(env, device->source->hotkeys().Set(hotkeys, stepTimeoutUs));
+}
+
+Value NextHotkeys(const CallbackInfo& info) {
+  const Env env = info.Env();
+
+  if (info.Length() != 2) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int32_t* matches;
+  size_t length;
+  if (!info[0].IsNumber() || !getInt32Buffer(info[1], &matches, &length)) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int devId = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devId);
+  if (device == nullptr) return unknownHandle(env, "device");
+  EventSource* source = device->source;
+
+  // matches of an earlier call that did not fit are returned first
+  source->ReadHotkeys();
+  if (source->hotkeys().NextMatchSize() > length) {
+    RangeError::New(env, "Hotkey match exceeds buffer length").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const size_t taken = source->hotkeys().TakeMatches(matches, length);
+  source->Delivered(matches, taken, READ_HOTKEYS);
+
+  return Number::New(env, (double)taken);
+}
+
+// GetStats(devId, stats)
+// Snapshot the counters of the device's read path into stats, a Float64Array
+// of at least STATS_SIZE slots laid out as in event-stats.h.
+Value GetStats(const CallbackInfo& info) {
+  const Env env = info.Env();
+
+  if (info.Length() != 2) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  double* stats;
+  size_t length;
+  if (!info[0].IsNumber() || !info[1].IsTypedArray() ||
+      !getOptionalTypedArray(info[1], napi_float64_array, &stats, &length) ||
+      length < STATS_SIZE) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int devId = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devId);
+  if (device == nullptr) return unknownHandle(env, "device");
+
+  device->source->stats().Snapshot(stats);
+  return env.Undefined();
+}
+
+// Copy libevdev's key, abs and MT slot state of evdev into the optional
+// arrays of GetState(). Returns the number of MT slots.
+static int snapshotState(const struct libevdev* evdev,
+                         uint8_t* keys, size_t keysLength,
+                         int32_t* abs, size_t absLength,
+                         int32_t* slots, size_t slotsLength) {
+  if (keys != nullptr) {
+    memset(keys, 0, keysLength);
+    const unsigned int maxCode = keysLength * 8 < KEY_CNT ? keysLength * 8 : KEY_CNT;
+    for (unsigned int code = 0; code < maxCode; code++) {
+      if (libevdev_get_event_value(evdev, EV_KEY, code)) {
+        keys[code / 8] |= 1 << (code % 8);
+      }
+    }
+  }
+
+  if (abs != nullptr) {
+    const unsigned int maxCode = absLength < ABS_CNT ? absLength : ABS_CNT;
+    for (unsigned int code = 0; code < maxCode; code++) {
+      abs[code] = libevdev_get_event_value(evdev, EV_ABS, code);
+    }
+  }
+
+  const int numSlots = libevdev_get_num_slots(evdev);
+  if (slots != nullptr && numSlots > 0) {
+    const unsigned int maxSlot = slotsLength / MT_CODE_COUNT;
+    for (unsigned int slot = 0; slot < (unsigned int)numSlots && slot < maxSlot; slot++) {
+      for (unsigned int i = 0; i < MT_CODE_COUNT; i++) {
+        int32_t* value = slots + slot * MT_CODE_COUNT + i;
+        if (libevdev_fetch_slot_value(evdev, slot, MT_CODE_FIRST + i, value) == 0) {
+          *value = 0;
+        }
+      }
+    }
+  }
+
+  return numSlots < 0 ? 0 : numSlots;
+}
+
+// GetState(devId, pump, keys, abs, slots, dirty)
+// Snapshot libevdev's device state into caller-owned arrays, each optional:
+//    keys:  Uint8Array, bitmap of pressed keys indexed by key code
+//    abs:   Int32Array, current value per abs code
+//    slots: Int32Array, MT values per slot (see MT_CODE_COUNT)
+//    dirty: Uint8Array, bitmap of state changed since the last snapshot
+// If pump is true pending events are read (and discarded) first so that
+// the state is current when no other reader consumes the device's events.
+// A device read by an EventReader is never pumped, its state is copied
+// holding the lock the reader thread reads it under.
+// Returns the number of MT slots of the device.
+Value GetState(const CallbackInfo& info) {
+  const Env env = info.Env();
+
+  if (info.Length() != 6) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  uint8_t* keys;
+  int32_t* abs;
+  int32_t* slots;
+  uint8_t* dirty;
+  size_t keysLength, absLength, slotsLength, dirtyLength;
+  if (!info[0].IsNumber() || !info[1].IsBoolean() ||
+      !getOptionalTypedArray(info[2], napi_uint8_array, &keys, &keysLength) ||
+      !getOptionalTypedArray(info[3], napi_int32_array, &abs, &absLength) ||
+      !getOptionalTypedArray(info[4], napi_int32_array, &slots, &slotsLength) ||
+      !getOptionalTypedArray(info[5], napi_uint8_array, &dirty, &dirtyLength)) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  AddonData* data = addonData(env);
+  const int devId = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = data->devices.Get(devId);
+  if (device == nullptr) return unknownHandle(env, "device");
+  EventSource* source = device->source;
+  const struct libevdev* evdev = source->evdev();
+
+  int numSlots = 0;
+  const auto snapshot = [&]() {
+    numSlots = snapshotState(evdev, keys, keysLength, abs, absLength, slots, slotsLength);
+  };
+
+  bool read = false;
+  data->readers.ForEach([&](int, EventReader* reader) {
+    if (!read) read = reader->WithDevice(devId, snapshot);
+  });
+
+  if (!read) {
+    if (info[1].As<Boolean>().Value()) source->Drain();
+    snapshot();
+  }
+
+  if (dirty != nullptr) {
+    source->TakeDirty(dirty, dirtyLength);
+  }
+
+  return Number::New(env, numSlots);
+}
+
+// Read the optional number config[name] into setting, NAN if undefined.
+// Returns false if it is neither.
+static bool axisSetting(const Object& config, const char* name, float* setting) {
+  const Value value = config.Get(name);
+  if (value.IsUndefined()) {
+    *setting = NAN;
+    return true;
+  }
+  if (!value.IsNumber()) return false;
+
+  *setting = value.As<Number>().FloatValue();
+  return true;
+}
+
+// Read the optional boolean config[name] into flag, false if undefined.
+// Returns false if it is neither.
+static bool axisFlag(const Object& config, const char* name, bool* flag) {
+  const Value value = config.Get(name);
+  if (value.IsUndefined()) {
+    *flag = false;
+    return true;
+  }
+  if (!value.IsBoolean()) return false;
+
+  *flag = value.As<Boolean>().Value();
+  return true;
+}
+
+// SetAxisPipeline(devId, state, configs)
+// Process the device's axes natively into state, an Int32Array over a
+// SharedArrayBuffer (see axis-pipeline.h), with one config object per axis:
+//    {code, deadzone?, hysteresis?, smoothing?, min?, max?, center?, unipolar?, invert?}
+// the optional settings being numbers, unipolar and invert booleans.
+// A null state stops processing. Returns false if state or a config is invalid.
+Value SetAxisPipeline(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 3) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !(info[1].IsTypedArray() || info[1].IsNull()) || !info[2].IsArray()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int devId = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devId);
+  if (device == nullptr) return unknownHandle(env, "device");
+
+  if (info[1].IsNull()) {
+    device->source->SetAxes(nullptr);
+    return Boolean::New(env, true);
+  }
+  if (info[1].As<TypedArray>().TypedArrayType() != napi_int32_array) return Boolean::New(env, false);
+
+  std::vector<AxisConfig> configs;
+  const Array configsJs = info[2].As<Array>();
+  for (uint32_t i = 0; i < configsJs.Length(); i++) {
+    if (!configsJs.Get(i).IsObject()) return Boolean::New(env, false);
+
+    const Object config = configsJs.Get(i).As<Object>();
+    if (!config.Get("code").IsNumber()) return Boolean::New(env, false);
+
+    AxisConfig axis;
+    axis.code = config.Get("code").As<Number>().Uint32Value();
+    if (!axisSetting(config, "deadzone", &axis.deadzone) ||
+        !axisSetting(config, "hysteresis", &axis.hysteresis) ||
+        !axisSetting(config, "smoothing", &axis.smoothing) ||
+        !axisSetting(config, "min", &axis.min) ||
+        !axisSetting(config, "max", &axis.max) ||
+        !axisSetting(config, "center", &axis.center) ||
+        !axisFlag(config, "unipolar", &axis.unipolar) ||
+        !axisFlag(config, "invert", &axis.invert)) {
+      return Boolean::New(env, false);
+    }
+    configs.push_back(axis);
+  }
+
+  AxisPipeline* pipeline = AxisPipeline::New(device->evdev, info[1].As<Int32Array>(), configs);
+  if (pipeline == nullptr) return Boolean::New(env, false);
+
+  device->source->SetAxes(pipeline);
+  return Boolean::New(env, true);
+}
+
+// SetCoalescing(devId, windowUs, maxFrames)
+// Coalesce the frames of the device's relative and absolute axes in the
+// native read path, passing on one frame per windowUs or maxFrames frames
+// (0 for no limit), see event-coalescer.h. A null windowUs stops
+// coalescing. Returns false if the window is negative.
+Value SetCoalescing(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 3) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !(info[1].IsNumber() || info[1].IsNull()) || !info[2].IsNumber()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int devId = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devId);
+  if (device == nullptr) return unknownHandle(env, "device");
+
+  if (info[1].IsNull()) {
+    device->source->SetCoalescer(nullptr);
+    return Boolean::New(env, true);
+  }
+
+  const int64_t windowUs = info[1].As<Number>().Int64Value();
+  if (windowUs < 0) return Boolean::New(env, false);
+
+  device->source->SetCoalescer(new EventCoalescer(windowUs, info[2].As<Number>().Uint32Value()));
+  return Boolean::New(env, true);
+}
+
+// SetEventRemap(devId, uinputId, rules)
+// Forward the device's events to a uinput in the native read path,
+// remapped by rules: [{type, code, toType, toCode, scale, offset, invert,
+// drop, notify}]. A null uinputId stops forwarding. Returns false if a rule
+// is invalid.
+Value SetEventRemap(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 3) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !(info[1].IsNumber() || info[1].IsNull()) || !info[2].IsArray()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  AddonData* data = addonData(env);
+  const int devId = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = data->devices.Get(devId);
+  if (device == nullptr) return unknownHandle(env, "device");
+
+  if (info[1].IsNull()) {
+    device->source->SetRemap(nullptr);
+    return Boolean::New(env, true);
+  }
+
+  const int uinputid = info[1].As<Number>().Uint32Value();
+  UInputHandle* handle = data->uinputs.Get(uinputid);
+  if (handle == nullptr) return unknownHandle(env, "uinput");
+
+  std::vector<RemapRule> rules;
+  const Array rulesJs = info[2].As<Array>();
+  for (uint32_t i = 0; i < rulesJs.Length(); i++) {
+    if (!rulesJs.Get(i).IsObject()) return Boolean::New(env, false);
+
+    const Object rule = rulesJs.Get(i).As<Object>();
+    if (!rule.Get("type").IsNumber() || !rule.Get("code").IsNumber() ||
+        !rule.Get("toType").IsNumber() || !rule.Get("toCode").IsNumber() ||
+        !rule.Get("scale").IsNumber() || !rule.Get("offset").IsNumber()) {
+      return Boolean::New(env, false);
+    }
+
+    rules.push_back(RemapRule{
+      rule.Get("type").As<Number>().Uint32Value(),
+      rule.Get("code").As<Number>().Uint32Value(),
+      rule.Get("toType").As<Number>().Uint32Value(),
+      rule.Get("toCode").As<Number>().Uint32Value(),
+      rule.Get("scale").As<Number>().FloatValue(),
+      rule.Get("offset").As<Number>().FloatValue(),
+      rule.Get("invert").ToBoolean().Value(),
+      rule.Get("drop").ToBoolean().Value(),
+      rule.Get("notify").ToBoolean().Value()
+    });
+  }
+
+  EventRemap* remap = EventRemap::New(device->evdev, uinputid,
+      libevdev_uinput_get_fd(handle->uinput), rules);
+  if (remap == nullptr) return Boolean::New(env, false);
+
+  device->source->SetRemap(remap);
+  return Boolean::New(env, true);
+}
+
+Value NewEventReader(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() < 2 || info.Length() > 3) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsFunction() ||
+      (info.Length() == 3 && !info[2].IsNumber())) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int readerid = info[0].As<Number>().Uint32Value();
+  const int flags = info.Length() == 3 ? info[2].As<Number>().Int32Value() : 0;
+  EventReader* reader = new EventReader(env, info[1].As<Function>(), flags);
+  addonData(env)->readers.Put(readerid, reader);
+
+  return Boolean::New(env, true);
+}
+
+Value ReleaseEventReader(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 1) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber()) {
+    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int readerid = info[0].As<Number>().Uint32Value();
+  delete addonData(env)->readers.Take(readerid);
+
+  return env.Undefined();
+}
+
+Value EventReaderAdd(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() < 2 || info.Length() > 3) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsNumber() ||
+      (info.Length() == 3 && !info[2].IsTypedArray() && !info[2].IsBoolean() &&
+       !info[2].IsNumber())) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int readerid = info[0].As<Number>().Uint32Value();
+  EventReader* reader = addonData(env)->readers.Get(readerid);
+  if (reader == nullptr) return unknownHandle(env, "reader");
+  const int devid = info[1].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  EventSource* source = device->source;
+
+  // optional 3rd argument, the read mode, or true to deliver frames
+  if (info.Length() == 3 && info[2].IsBoolean()) {
+    const int mode = info[2].As<Boolean>().Value() ? READ_FRAMES : READ_EVENTS;
+    return Boolean::New(env, reader->Add(devid, source, nullptr, mode));
+  }
+  if (info.Length() == 3 && info[2].IsNumber()) {
+    const int mode = info[2].As<Number>().Int32Value();
+    if (mode < READ_EVENTS || mode > READ_HOTKEYS) return Boolean::New(env, false);
+    return Boolean::New(env, reader->Add(devid, source, nullptr, mode));
+  }
+
+  // or an event ring, events are written to it instead of the callback
+  EventRing* ring = nullptr;
+  if (info.Length() == 3) {
+    if (info[2].As<TypedArray>().TypedArrayType() == napi_int32_array) {
+      ring = EventRing::New(info[2].As<Int32Array>());
+    }
+    if (ring == nullptr) {
+      TypeError::New(env, "Invalid event ring").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+
+  return Boolean::New(env, reader->Add(devid, source, ring));
+}
+
+Value EventReaderRemove(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 2) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsNumber()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int readerid = info[0].As<Number>().Uint32Value();
+  EventReader* reader = addonData(env)->readers.Get(readerid);
+  if (reader == nullptr) return unknownHandle(env, "reader");
+  const int devid = info[1].As<Number>().Uint32Value();
+
+  return Boolean::New(env, reader->Remove(devid));
+}
+
+// EventReaderResume(readerId, devId)
+// Resume a device whose event ring the consumer made room in after the
+// reader held records back for it (the ring's blocked flag).
+Value EventReaderResume(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 2) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsNumber()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int readerid = info[0].As<Number>().Uint32Value();
+  EventReader* reader = addonData(env)->readers.Get(readerid);
+  if (reader == nullptr) return unknownHandle(env, "reader");
+  const int devid = info[1].As<Number>().Uint32Value();
+
+  return Boolean::New(env, reader->Resume(devid));
+}
+
+Value TypeForName(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 1) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsString()) {
+    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int type = libevdev_event_type_from_name(info[0].As<String>().Utf8Value().c_str());
+
+  return Number::New(env, (double)type);
+}
+
+static const InputTypeNames* findTypeNames(uint32_t type) {
+  for (const InputTypeNames& typeNames : INPUT_TYPE_NAMES) {
+    if (typeNames.type == type) return &typeNames;
+  }
+  return nullptr;
+}
+
+static Value internedName(Napi::Env env, size_t idx, const char* name) {
+  std::vector<Reference<String>>& names = addonData(env)->names;
+  if (names.empty()) names.resize(INPUT_NAME_COUNT);
+
+  Reference<String>& ref = names[idx];
+  if (ref.IsEmpty()) {
+    ref = Persistent(String::New(env, name));
+  }
+  return ref.Value();
+}
+
+Value NameForType(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 1) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber()) {
+    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  uint32_t type = info[0].As<Number>().Uint32Value();
+  const InputTypeNames* typeNames = findTypeNames(type);
+  if (typeNames == nullptr) return env.Null();
+
+  return internedName(env, typeNames - INPUT_TYPE_NAMES, typeNames->name);
+}
+
+Value CodeForName(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 1) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsString()) {
+    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int code = libevdev_event_code_from_code_name(info[0].As<String>().Utf8Value().c_str());
 
   return Number::New(env, (double)code);
 }
 
-Value NameForCode(const CallbackInfo& info) {
+Value NameForCode(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 2) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsNumber()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const InputTypeNames* typeNames = findTypeNames(info[0].As<Number>().Uint32Value());
+  if (typeNames == nullptr) return env.Null();
+
+  uint32_t code = info[1].As<Number>().Uint32Value();
+  const InputCodeName* end = typeNames->codes + typeNames->count;
+  const InputCodeName* codeName = std::lower_bound(typeNames->codes, end, code,
+      [](const InputCodeName& entry, uint32_t c) { return entry.code < c; });
+  if (codeName == end || codeName->code != code) return env.Null();
+
+  return internedName(env, typeNames->first + (codeName - typeNames->codes), codeName->name);
+}
+
+Array GetTypesAndCodes(const CallbackInfo& info) {
+  const Env env = info.Env();
+  Array types = Array::New(env);
+
+  for (uint32_t typeCode=0; typeCode < EV_MAX; typeCode++) {
+    int max_codes = libevdev_event_type_get_max(typeCode);
+    if (max_codes < 1) continue;
+
+    Object type = Object::New(env);
+    type.Set("code", (double)typeCode);
+    type.Set("name", libevdev_event_type_get_name(typeCode));
+  
+    Array codes = Array::New(env);
+
+    for (uint32_t code=0; code < (uint32_t)max_codes; code++) {
+      const char* codeName = libevdev_event_code_get_name(typeCode, code);
+      if (codeName != nullptr) {
+        codes.Set(codes.Length(), code);
+        codes.Set(codes.Length(), codeName);
+      }
+    }
+
+    type.Set("codes", codes);
+    types.Set(types.Length(), type);
+  }
+
+  return types;
+}
+
+// Destroy the uinput device of handle, see releaseDevice().
+static void releaseUInput(AddonData* data, UInputHandle* handle) {
+  data->uinputs.Take(handle->id);
+
+  // stop forwarding and players writing to the uinput fd before it is closed
+  data->devices.ForEach([handle](int, DeviceHandle* device) {
+    device->source->RemoveRemap(handle->id);
+  });
+
+  std::vector<int> players;
+  data->players.ForEach([handle, &players](int playerid, UInputPlayer* player) {
+    if (player->uinputid() == handle->id) players.push_back(playerid);
+  });
+  for (int playerid : players) {
+    delete data->players.Take(playerid);
+  }
+
+  libevdev_uinput_destroy(handle->uinput);
+  handle->uinput = nullptr;
+  handle->released = true;
+
+  if (!handle->owned) delete handle;
+}
+
+static void finalizeUInput(Env env, UInputHandle* handle) {
+  if (handle->released) {
+    delete handle;
+    return;
+  }
+
+  handle->owned = false;
+  releaseUInput(addonData(env), handle);
+}
+
+Value CreateUInputFromDevice(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 2 && info.Length() != 3) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsNumber() ||
+      (info.Length() == 3 && !info[2].IsObject())) {
+    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int devid = info[0].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  struct libevdev* evdev = device->evdev;
+
+  const int uinputid = info[1].As<Number>().Uint32Value();
+  if (addonData(env)->uinputs.Get(uinputid) != nullptr) return env.Null();
+
+  struct libevdev_uinput* uinput;
+  int result = 
+    libevdev_uinput_create_from_device(evdev, LIBEVDEV_UINPUT_OPEN_MANAGED, &uinput);
+
+  if (result < 0) return env.Null();
+
+  UInputHandle* handle = new UInputHandle{uinputid, uinput, false, false};
+  addonData(env)->uinputs.Put(uinputid, handle);
+
+  // the optional owner, i.e., the JS UInput, frees the handle once collected
+  if (info.Length() == 3) {
+    handle->owned = true;
+    info[2].As<Object>().AddFinalizer(finalizeUInput, handle);
+  }
+
+  int uinput_fd = libevdev_uinput_get_fd(uinput);
+  return Number::New(env, uinput_fd);
+}
+
+Value ReleaseUInput(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 1) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber()) {
+    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int uinputid = info[0].As<Number>().Uint32Value();
+  AddonData* data = addonData(env);
+  UInputHandle* handle = data->uinputs.Get(uinputid);
+  if (handle != nullptr) releaseUInput(data, handle);
+
+  return env.Undefined();
+}
+
+Value GetDevNodeForUInput(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 1) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber()) {
+    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int uinputid = info[0].As<Number>().Uint32Value();
+  UInputHandle* handle = addonData(env)->uinputs.Get(uinputid);
+  if (handle == nullptr) return unknownHandle(env, "uinput");
+  struct libevdev_uinput* uinput = handle->uinput;
+  const char *devNode = libevdev_uinput_get_devnode(uinput);
+
+  return devNode != nullptr ? String::New(env, devNode) : env.Null();
+}
+
+Value UInputWriteEvent(const CallbackInfo& info) {
   Env env = info.Env();
 
   if (info.Length() != 2) {
@@ -493,48 +1755,125 @@ Value NameForCode(const CallbackInfo& info) {
     return env.Null();
   }
 
-  if (!info[0].IsNumber() || !info[1].IsNumber()) {
+  if (!info[0].IsNumber() || !info[1].IsObject()) {
     TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  const char* name = libevdev_event_code_get_name(
-                      (unsigned int)info[0].As<Number>().Uint32Value(),
-                      (unsigned int)info[1].As<Number>().Uint32Value());
+  const int uinputid = info[0].As<Number>().Uint32Value();
+  UInputHandle* handle = addonData(env)->uinputs.Get(uinputid);
+  if (handle == nullptr) return unknownHandle(env, "uinput");
+  struct libevdev_uinput* uinput = handle->uinput;
+  const Object event = info[1].As<Object>();
+  const uint32_t typeCode = event.Get("type").As<Number>().Uint32Value();
+  const uint32_t code = event.Get("code").As<Number>().Uint32Value();
+  const uint32_t value = event.Get("value").As<Number>().Int32Value();
 
-  return String::New(env, name);
-}
+  bool result = libevdev_uinput_write_event(uinput, typeCode, code, value) < 0 ? false : true;
 
-Array GetTypesAndCodes(const CallbackInfo& info) {
-  const Env env = info.Env();
-  Array types = Array::New(env);
+  return Boolean::New(env, result);
+}
 
-  for (uint32_t typeCode=0; typeCode < EV_MAX; typeCode++) {
-    int max_codes = libevdev_event_type_get_max(typeCode);
-    if (max_codes < 1) continue;
+ssize_t writeUInputEvents(int fd, const int32_t* events, size_t count,
+                          bool synReport, std::vector<struct input_event>& scratch) {
+  scratch.resize(count + (synReport ? 1 : 0));
+
+  // the kernel timestamps injected events, time is left zero
+  for (size_t i = 0; i < count; i++) {
+    const int32_t* event = events + i * UINPUT_EVENT_SIZE;
+    struct input_event& evdevEvent = scratch[i];
+    evdevEvent = {};
+    evdevEvent.type = event[0];
+    evdevEvent.code = event[1];
+    evdevEvent.value = event[2];
+  }
 
-    Object type = Object::New(env);
-    type.Set("code", (double)typeCode);
-    type.Set("name", libevdev_event_type_get_name(typeCode));
-  
-    Array codes = Array::New(env);
+  if (synReport) {
+    struct input_event& evdevEvent = scratch[count];
+    evdevEvent = {};
+    evdevEvent.type = EV_SYN;
+    evdevEvent.code = SYN_REPORT;
+  }
 
-    for (uint32_t code=0; code < (uint32_t)max_codes; code++) {
-      const char* codeName = libevdev_event_code_get_name(typeCode, code);
-      if (codeName != nullptr) {
-        codes.Set(codes.Length(), code);
-        codes.Set(codes.Length(), codeName);
-      }
+  const char* data = reinterpret_cast<const char*>(scratch.data());
+  const size_t size = scratch.size() * sizeof(struct input_event);
+  size_t written = 0;
+
+  // uinput accepts whole events, a short write resumes at the next one
+  while (written < size) {
+    ssize_t rc = write(fd, data + written, size - written);
+    if (rc < 0) {
+      if (errno == EINTR) continue;
+      if (written > 0) break;
+      return -errno;
     }
+    if (rc == 0) break;
+    written += rc;
+  }
 
-    type.Set("codes", codes);
-    types.Set(types.Length(), type);
+  return written / sizeof(struct input_event);
+}
+
+Value UInputWriteEvents(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() < 2 || info.Length() > 3) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  return types;
+  int32_t* events = nullptr;
+  size_t length = 0;
+  if (!info[0].IsNumber() || !getInt32Buffer(info[1], &events, &length) ||
+      (info.Length() == 3 && !info[2].IsBoolean())) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int uinputid = info[0].As<Number>().Uint32Value();
+  UInputHandle* handle = addonData(env)->uinputs.Get(uinputid);
+  if (handle == nullptr) return unknownHandle(env, "uinput");
+  struct libevdev_uinput* uinput = handle->uinput;
+  const bool synReport = info.Length() == 3 && info[2].As<Boolean>().Value();
+
+  ssize_t result = writeUInputEvents(libevdev_uinput_get_fd(uinput), events,
+                                     length / UINPUT_EVENT_SIZE, synReport, addonData(env)->uinputEvents);
+
+  return Number::New(env, result);
 }
 
-Value CreateUInputFromDevice(const CallbackInfo& info) {
+Value NewUInputPlayer(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 4) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int32_t* records = nullptr;
+  size_t length = 0;
+  if (!info[0].IsNumber() || !info[1].IsNumber() ||
+      !getInt32Buffer(info[2], &records, &length) || !info[3].IsFunction()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int playerid = info[0].As<Number>().Uint32Value();
+  const int uinputid = info[1].As<Number>().Uint32Value();
+  UInputHandle* handle = addonData(env)->uinputs.Get(uinputid);
+  if (handle == nullptr) return unknownHandle(env, "uinput");
+  struct libevdev_uinput* uinput = handle->uinput;
+
+  UInputPlayer* player = new UInputPlayer(env, info[3].As<Function>(), uinputid,
+      libevdev_uinput_get_fd(uinput), records, length / EVENT_RECORD_SIZE);
+  addonData(env)->players.Put(playerid, player);
+
+  return Boolean::New(env, true);
+}
+
+Value PauseUInputPlayer(const CallbackInfo& info) {
   Env env = info.Env();
 
   if (info.Length() != 2) {
@@ -543,28 +1882,74 @@ Value CreateUInputFromDevice(const CallbackInfo& info) {
     return env.Null();
   }
 
-  if (!info[0].IsNumber() || !info[1].IsNumber()) {
+  if (!info[0].IsNumber() || !info[1].IsBoolean()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int playerid = info[0].As<Number>().Uint32Value();
+  UInputPlayer* player = addonData(env)->players.Get(playerid);
+  if (player == nullptr) return Boolean::New(env, false);
+
+  if (info[1].As<Boolean>().Value()) {
+    player->Pause();
+  } else {
+    player->Resume();
+  }
+
+  return Boolean::New(env, true);
+}
+
+Value ReleaseUInputPlayer(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 1) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber()) {
     TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  const int devid = info[0].As<Number>().Uint32Value();
-  struct libevdev* evdev = LIBEVDEV_MAP.at(devid);
+  // cancels a playback still in progress
+  const int playerid = info[0].As<Number>().Uint32Value();
+  delete addonData(env)->players.Take(playerid);
 
-  const int uinputid = info[1].As<Number>().Uint32Value();
-  struct libevdev_uinput* uinput;
-  int result = 
-    libevdev_uinput_create_from_device(evdev, LIBEVDEV_UINPUT_OPEN_MANAGED, &uinput);
+  return env.Undefined();
+}
 
-  if (result < 0) return env.Null();
+Value NewCaptureWriter(const CallbackInfo& info) {
+  Env env = info.Env();
 
-  UINPUT_MAP.insert(std::pair<int,libevdev_uinput*>(uinputid, uinput));
+  if (info.Length() != 2) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  int uinput_fd = libevdev_uinput_get_fd(uinput);
-  return Number::New(env, uinput_fd);
+  if (!info[0].IsNumber() || !info[1].IsString()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int captureid = info[0].As<Number>().Uint32Value();
+  const std::string path = info[1].As<String>().Utf8Value();
+  CaptureWriter* writer = new CaptureWriter();
+
+  int result = writer->Open(path.c_str());
+  if (result < 0) {
+    delete writer;
+  } else {
+    addonData(env)->captureWriters.Put(captureid, writer);
+  }
+
+  return Number::New(env, result);
 }
 
-Value ReleaseUInput(const CallbackInfo& info) {
+Value ReleaseCaptureWriter(const CallbackInfo& info) {
   Env env = info.Env();
 
   if (info.Length() != 1) {
@@ -578,15 +1963,102 @@ Value ReleaseUInput(const CallbackInfo& info) {
     return env.Null();
   }
 
-  const int uinputid = info[0].As<Number>().Uint32Value();
-  struct libevdev_uinput* uinput = UINPUT_MAP.at(uinputid);
-  UINPUT_MAP.erase(uinputid);
-  libevdev_uinput_destroy(uinput);
+  const int captureid = info[0].As<Number>().Uint32Value();
+  CaptureWriter* writer = addonData(env)->captureWriters.Take(captureid);
+  if (writer == nullptr) return Number::New(env, 0);
+
+  addonData(env)->devices.ForEach([writer](int, DeviceHandle* device) {
+    device->source->RemoveCapture(writer);
+  });
+
+  // flushes the remaining events
+  int result = writer->Close();
+  delete writer;
+
+  return Number::New(env, result);
+}
+
+Value CaptureWriterAdd(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 2) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsNumber()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int captureid = info[0].As<Number>().Uint32Value();
+  CaptureWriter* writer = addonData(env)->captureWriters.Get(captureid);
+  if (writer == nullptr) return unknownHandle(env, "capture writer");
+  const int devid = info[1].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  EventSource* source = device->source;
+
+  const uint32_t index = writer->AddDevice(source->evdev());
+  source->SetCapture(writer, index);
+
+  return Number::New(env, index);
+}
+
+Value CaptureWriterRemove(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 2) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsNumber()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int captureid = info[0].As<Number>().Uint32Value();
+  CaptureWriter* writer = addonData(env)->captureWriters.Get(captureid);
+  if (writer == nullptr) return unknownHandle(env, "capture writer");
+  const int devid = info[1].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device != nullptr) device->source->RemoveCapture(writer);
 
   return env.Undefined();
 }
 
-Value GetDevNodeForUInput(const CallbackInfo& info) {
+Value NewCaptureReader(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 2) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsString()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int captureid = info[0].As<Number>().Uint32Value();
+  const std::string path = info[1].As<String>().Utf8Value();
+  CaptureReader* reader = new CaptureReader();
+
+  int result = reader->Open(path.c_str());
+  if (result < 0) {
+    delete reader;
+  } else {
+    addonData(env)->captureReaders.Put(captureid, reader);
+  }
+
+  return Number::New(env, result);
+}
+
+Value ReleaseCaptureReader(const CallbackInfo& info) {
   Env env = info.Env();
 
   if (info.Length() != 1) {
@@ -600,14 +2072,78 @@ Value GetDevNodeForUInput(const CallbackInfo& info) {
     return env.Null();
   }
 
-  const int uinputid = info[0].As<Number>().Uint32Value();
-  struct libevdev_uinput* uinput = UINPUT_MAP.at(uinputid);
-  const char *devNode = libevdev_uinput_get_devnode(uinput);
+  const int captureid = info[0].As<Number>().Uint32Value();
+  delete addonData(env)->captureReaders.Take(captureid);
 
-  return devNode != nullptr ? String::New(env, devNode) : env.Null();
+  return env.Undefined();
 }
 
-Value UInputWriteEvent(const CallbackInfo& info) {
+Value GetCaptureInfo(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 1) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber()) {
+    TypeError::New(env, "Wrong argument type").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int captureid = info[0].As<Number>().Uint32Value();
+  CaptureReader* reader = addonData(env)->captureReaders.Get(captureid);
+  if (reader == nullptr) return unknownHandle(env, "capture reader");
+
+  Array devices = Array::New(env);
+  for (const CaptureReader::Device& device : reader->devices()) {
+    Object deviceInfo = Object::New(env);
+    deviceInfo.Set("index", Number::New(env, device.header->device));
+    deviceInfo.Set("name", String::New(env, device.name));
+    deviceInfo.Set("bustype", Number::New(env, device.header->bustype));
+    deviceInfo.Set("vendor", Number::New(env, device.header->vendor));
+    deviceInfo.Set("product", Number::New(env, device.header->product));
+    deviceInfo.Set("version", Number::New(env, device.header->version));
+    devices.Set(devices.Length(), deviceInfo);
+  }
+
+  Object captureInfo = Object::New(env);
+  captureInfo.Set("devices", devices);
+  captureInfo.Set("events", Number::New(env, (double)reader->events()));
+  captureInfo.Set("startUs", Number::New(env, (double)reader->startUs()));
+  captureInfo.Set("endUs", Number::New(env, (double)reader->endUs()));
+
+  return captureInfo;
+}
+
+Value CaptureReaderInitDevice(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() != 3) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  if (!info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber()) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int captureid = info[0].As<Number>().Uint32Value();
+  CaptureReader* reader = addonData(env)->captureReaders.Get(captureid);
+  if (reader == nullptr) return unknownHandle(env, "capture reader");
+  const uint32_t index = info[1].As<Number>().Uint32Value();
+  const int devid = info[2].As<Number>().Uint32Value();
+  DeviceHandle* device = addonData(env)->devices.Get(devid);
+  if (device == nullptr) return unknownHandle(env, "device");
+  struct libevdev* evdev = device->evdev;
+
+  return Boolean::New(env, reader->InitDevice(index, evdev));
+}
+
+Value CaptureReaderSeek(const CallbackInfo& info) {
   Env env = info.Env();
 
   if (info.Length() != 2) {
@@ -616,21 +2152,43 @@ Value UInputWriteEvent(const CallbackInfo& info) {
     return env.Null();
   }
 
-  if (!info[0].IsNumber() || !info[1].IsObject()) {
+  if (!info[0].IsNumber() || !info[1].IsNumber()) {
     TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  const int uinputid = info[0].As<Number>().Uint32Value();
-  struct libevdev_uinput* uinput = UINPUT_MAP.at(uinputid);
-  const Object event = info[1].As<Object>();
-  const uint32_t typeCode = event.Get("type").As<Number>().Uint32Value();
-  const uint32_t code = event.Get("code").As<Number>().Uint32Value();
-  const uint32_t value = event.Get("value").As<Number>().Int32Value();
+  const int captureid = info[0].As<Number>().Uint32Value();
+  CaptureReader* reader = addonData(env)->captureReaders.Get(captureid);
+  if (reader == nullptr) return unknownHandle(env, "capture reader");
+  reader->Seek(info[1].As<Number>().Int64Value());
 
-  bool result = libevdev_uinput_write_event(uinput, typeCode, code, value) < 0 ? false : true;
+  return env.Undefined();
+}
 
-  return Boolean::New(env, result);
+Value CaptureReaderRead(const CallbackInfo& info) {
+  Env env = info.Env();
+
+  if (info.Length() < 2 || info.Length() > 3) {
+    TypeError::New(env, "Wrong number of arguments")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  int32_t* records = nullptr;
+  size_t length = 0;
+  if (!info[0].IsNumber() || !getInt32Buffer(info[1], &records, &length) ||
+      (info.Length() == 3 && !info[2].IsNumber())) {
+    TypeError::New(env, "Wrong argument types").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const int captureid = info[0].As<Number>().Uint32Value();
+  CaptureReader* reader = addonData(env)->captureReaders.Get(captureid);
+  if (reader == nullptr) return unknownHandle(env, "capture reader");
+  const int64_t untilUs = info.Length() == 3 ? info[2].As<Number>().Int64Value() : INT64_MAX;
+
+  size_t count = reader->Read(records, length / TAGGED_EVENT_RECORD_SIZE, untilUs);
+  return Number::New(env, count);
 }
 
 String Hello(const CallbackInfo& info) {
@@ -638,19 +2196,58 @@ String Hello(const CallbackInfo& info) {
   return String::New(env, "hello world");
 }
 
+AddonData::~AddonData() {
+  // owned handles left to finalizers are only marked released here
+  devices.ForEach([this](int, DeviceHandle* device) { releaseDevice(this, device); });
+  uinputs.ForEach([this](int, UInputHandle* handle) { releaseUInput(this, handle); });
+
+  readers.ForEach([](int, EventReader* reader) { delete reader; });
+  players.ForEach([](int, UInputPlayer* player) { delete player; });
+  captureWriters.ForEach([](int, CaptureWriter* writer) { delete writer; });
+  captureReaders.ForEach([](int, CaptureReader* reader) { delete reader; });
+  monitors.ForEach([](int, DeviceMonitor* monitor) { delete monitor; });
+}
+
 Object Init(Env env, Object exports) {
+  // each environment, e.g., a worker_thread, has its own instance
+  env.SetInstanceData(new AddonData());
+
   exports.Set(String::New(env, "NewLibevdev"), Function::New(env, NewLibevdev));
   exports.Set(String::New(env, "ReleaseLibevdev"), Function::New(env, ReleaseLibevdev));
   exports.Set(String::New(env, "SetFD"), Function::New(env, SetFD));
+  exports.Set(String::New(env, "AdoptProbedDevice"), Function::New(env, AdoptProbedDevice));
+  exports.Set(String::New(env, "DetachDevice"), Function::New(env, DetachDevice));
+  exports.Set(String::New(env, "ReleaseProbedDevice"), Function::New(env, ReleaseProbedDevice));
+  exports.Set(String::New(env, "ProbeDevices"), Function::New(env, ProbeDevices));
+  exports.Set(String::New(env, "NewDeviceMonitor"), Function::New(env, NewDeviceMonitor));
+  exports.Set(String::New(env, "ReleaseDeviceMonitor"), Function::New(env, ReleaseDeviceMonitor));
   exports.Set(String::New(env, "GetDeviceInfo"), Function::New(env, GetDeviceInfo));
   exports.Set(String::New(env, "Grab"), Function::New(env, Grab));
-  exports.Set(String::New(env, "GetCapabilities"), Function::New(env, GetCapabilities));
+  exports.Set(String::New(env, "GetCapabilityBits"), Function::New(env, GetCapabilityBits));
   exports.Set(String::New(env, "HasType"), Function::New(env, HasType));
   exports.Set(String::New(env, "HasCode"), Function::New(env, HasCode));
   exports.Set(String::New(env, "EnableEventType"), Function::New(env, EnableEventType));
   exports.Set(String::New(env, "EnableEventCode"), Function::New(env, EnableEventCode));
   exports.Set(String::New(env, "EnableProperty"), Function::New(env, EnableProperty));
+  exports.Set(String::New(env, "SetEventFilter"), Function::New(env, SetEventFilter));
+  exports.Set(String::New(env, "FilterEventType"), Function::New(env, FilterEventType));
+  exports.Set(String::New(env, "FilterEventCode"), Function::New(env, FilterEventCode));
   exports.Set(String::New(env, "NextEvent"), Function::New(env, NextEvent));
+  exports.Set(String::New(env, "NextEvents"), Function::New(env, NextEvents));
+  exports.Set(String::New(env, "NextFrames"), Function::New(env, NextFrames));
+  exports.Set(String::New(env, "NextTouchFrames"), Function::New(env, NextTouchFrames));
+  exports.Set(String::New(env, "SetHotkeys"), Function::New(env, SetHotkeys));
+  exports.Set(String::New(env, "NextHotkeys"), Function::New(env, NextHotkeys));
+  exports.Set(String::New(env, "SetAxisPipeline"), Function::New(env, SetAxisPipeline));
+  exports.Set(String::New(env, "SetEventRemap"), Function::New(env, SetEventRemap));
+  exports.Set(String::New(env, "SetCoalescing"), Function::New(env, SetCoalescing));
+  exports.Set(String::New(env, "GetState"), Function::New(env, GetState));
+  exports.Set(String::New(env, "GetStats"), Function::New(env, GetStats));
+  exports.Set(String::New(env, "NewEventReader"), Function::New(env, NewEventReader));
+  exports.Set(String::New(env, "ReleaseEventReader"), Function::New(env, ReleaseEventReader));
+  exports.Set(String::New(env, "EventReaderAdd"), Function::New(env, EventReaderAdd));
+  exports.Set(String::New(env, "EventReaderRemove"), Function::New(env, EventReaderRemove));
+  exports.Set(String::New(env, "EventReaderResume"), Function::New(env, EventReaderResume));
   exports.Set(String::New(env, "TypeForName"), Function::New(env, TypeForName));
   exports.Set(String::New(env, "NameForType"), Function::New(env, NameForType));
   exports.Set(String::New(env, "CodeForName"), Function::New(env, CodeForName));
@@ -660,6 +2257,20 @@ Object Init(Env env, Object exports) {
   exports.Set(String::New(env, "ReleaseUInput"), Function::New(env, ReleaseUInput));
   exports.Set(String::New(env, "GetDevNodeForUInput"), Function::New(env, GetDevNodeForUInput));
   exports.Set(String::New(env, "UInputWriteEvent"), Function::New(env, UInputWriteEvent));
+  exports.Set(String::New(env, "UInputWriteEvents"), Function::New(env, UInputWriteEvents));
+  exports.Set(String::New(env, "NewUInputPlayer"), Function::New(env, NewUInputPlayer));
+  exports.Set(String::New(env, "PauseUInputPlayer"), Function::New(env, PauseUInputPlayer));
+  exports.Set(String::New(env, "ReleaseUInputPlayer"), Function::New(env, ReleaseUInputPlayer));
+  exports.Set(String::New(env, "NewCaptureWriter"), Function::New(env, NewCaptureWriter));
+  exports.Set(String::New(env, "ReleaseCaptureWriter"), Function::New(env, ReleaseCaptureWriter));
+  exports.Set(String::New(env, "CaptureWriterAdd"), Function::New(env, CaptureWriterAdd));
+  exports.Set(String::New(env, "CaptureWriterRemove"), Function::New(env, CaptureWriterRemove));
+  exports.Set(String::New(env, "NewCaptureReader"), Function::New(env, NewCaptureReader));
+  exports.Set(String::New(env, "ReleaseCaptureReader"), Function::New(env, ReleaseCaptureReader));
+  exports.Set(String::New(env, "GetCaptureInfo"), Function::New(env, GetCaptureInfo));
+  exports.Set(String::New(env, "CaptureReaderInitDevice"), Function::New(env, CaptureReaderInitDevice));
+  exports.Set(String::New(env, "CaptureReaderSeek"), Function::New(env, CaptureReaderSeek));
+  exports.Set(String::New(env, "CaptureReaderRead"), Function::New(env, CaptureReaderRead));
 
   exports.Set(String::New(env, "Hello"), Function::New(env, Hello));
   return exports;
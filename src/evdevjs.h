@@ -0,0 +1,46 @@
+#ifndef EVDEVJS_H_
+#define EVDEVJS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "napi.h"
+
+extern "C" {
+#include <sys/types.h>
+#include <linux/input.h>
+#include <libevdev/libevdev.h>
+}
+
+// Packed event record layout shared with lib/event.ts (Event.RECORD_SIZE):
+//    [tv_sec, tv_usec, type, code, value]
+static const size_t EVENT_RECORD_SIZE = 5;
+
+// Event record tagged with its device id (Event.TAGGED_RECORD_SIZE):
+//    [devid, tv_sec, tv_usec, type, code, value]
+static const size_t TAGGED_EVENT_RECORD_SIZE = EVENT_RECORD_SIZE + 1;
+
+// Packed uinput event layout shared with lib/uinput.ts (UInput.EVENT_SIZE):
+//    [type, code, value]
+static const size_t UINPUT_EVENT_SIZE = 3;
+
+void writeEventRecord(int32_t* record, const struct input_event& evdevEvent);
+
+// Packed absinfo layout shared with lib/capability-bits.ts, per ABS code:
+//    [value, min, max, fuzz, flat, resolution]
+static const size_t ABS_INFO_SIZE = 6;
+
+// JS descriptions of a device, as returned by GetDeviceInfo,
+// GetCapabilityBits and the device's property codes.
+Napi::Object createDeviceInfo(Napi::Env env, struct libevdev* evdev);
+Napi::Object createCapabilityBits(Napi::Env env, const struct libevdev* evdev);
+Napi::Array createProperties(Napi::Env env, const struct libevdev* evdev);
+
+// Write count packed [type, code, value] events to a uinput fd with a single
+// write(), optionally followed by a SYN_REPORT. The events are staged in
+// scratch. Returns the number of events written or -errno.
+ssize_t writeUInputEvents(int fd, const int32_t* events, size_t count,
+                          bool synReport, std::vector<struct input_event>& scratch);
+
+#endif  // EVDEVJS_H_
@@ -0,0 +1,145 @@
+#include <cstring>
+
+#include "event-coalescer.h"
+
+static int64_t timeUs(const struct timeval& time) {
+  return (int64_t)time.tv_sec * 1000000 + time.tv_usec;
+}
+
+static bool testBit(const uint8_t* bits, unsigned int bit) {
+  return (bits[bit / 8] & (1 << (bit % 8))) != 0;
+}
+
+EventCoalescer::EventCoalescer(int64_t windowUs, uint32_t maxFrames)
+  : windowUs_(windowUs), maxFrames_(maxFrames) {
+  Reset();
+}
+
+void EventCoalescer::Reset() {
+  memset(rel_, 0, sizeof(rel_));
+  memset(abs_, 0, sizeof(abs_));
+  memset(relSet_, 0, sizeof(relSet_));
+  memset(absSet_, 0, sizeof(absSet_));
+  mscTimestamp_ = 0;
+  mscTimestampSet_ = false;
+  held_ = false;
+  frameOpen_ = false;
+  passthrough_ = false;
+  frames_ = 0;
+  startUs_ = 0;
+  last_ = {};
+}
+
+bool EventCoalescer::Coalesced(const struct input_event& evdevEvent) {
+  switch (evdevEvent.type) {
+    case EV_REL:
+      return evdevEvent.code < REL_CNT;
+    case EV_ABS:
+      // MT values belong to the slot selected in their frame
+      return evdevEvent.code < ABS_MT_SLOT;
+    case EV_MSC:
+      return evdevEvent.code == MSC_TIMESTAMP;
+    default:
+      return false;
+  }
+}
+
+void EventCoalescer::Accumulate(const struct input_event& evdevEvent) {
+  const unsigned int code = evdevEvent.code;
+
+  if (evdevEvent.type == EV_REL) {
+    rel_[code] += evdevEvent.value;
+    relSet_[code / 8] |= 1 << (code % 8);
+  } else if (evdevEvent.type == EV_ABS) {
+    abs_[code] = evdevEvent.value;
+    absSet_[code / 8] |= 1 << (code % 8);
+  } else {
+    mscTimestamp_ = evdevEvent.value;
+    mscTimestampSet_ = true;
+  }
+}
+
+void EventCoalescer::Push(std::deque<struct input_event>& out, const struct timeval& time,
+                          unsigned int type, unsigned int code, int32_t value) {
+  struct input_event evdevEvent = {};
+  evdevEvent.time = time;
+  evdevEvent.type = type;
+  evdevEvent.code = code;
+  evdevEvent.value = value;
+  out.push_back(evdevEvent);
+}
+
+void EventCoalescer::Emit(std::deque<struct input_event>& out, const struct timeval& time) {
+  for (unsigned int code = 0; code < REL_CNT; code++) {
+    // deltas that cancel out move nothing
+    if (testBit(relSet_, code) && rel_[code] != 0) Push(out, time, EV_REL, code, rel_[code]);
+  }
+  for (unsigned int code = 0; code < ABS_CNT; code++) {
+    if (testBit(absSet_, code)) Push(out, time, EV_ABS, code, abs_[code]);
+  }
+  if (mscTimestampSet_) Push(out, time, EV_MSC, MSC_TIMESTAMP, mscTimestamp_);
+
+  memset(rel_, 0, sizeof(rel_));
+  memset(relSet_, 0, sizeof(relSet_));
+  memset(absSet_, 0, sizeof(absSet_));
+  mscTimestampSet_ = false;
+  held_ = false;
+  frameOpen_ = false;
+  frames_ = 0;
+}
+
+void EventCoalescer::Process(const struct input_event& evdevEvent, std::deque<struct input_event>& out) {
+  if (Coalesced(evdevEvent)) {
+    Accumulate(evdevEvent);
+    frameOpen_ = true;
+    return;
+  }
+
+  if (evdevEvent.type != EV_SYN || evdevEvent.code != SYN_REPORT) {
+    // the motion so far goes ahead of the event, in its frame
+    if (held_ || frameOpen_) Emit(out, evdevEvent.time);
+    out.push_back(evdevEvent);
+    passthrough_ = true;
+    return;
+  }
+
+  if (passthrough_) {
+    if (frameOpen_) Emit(out, evdevEvent.time);
+    out.push_back(evdevEvent);
+    passthrough_ = false;
+    return;
+  }
+
+  if (!frameOpen_) {
+    // an empty frame, e.g., of events consumed natively
+    if (!held_) out.push_back(evdevEvent);
+    return;
+  }
+
+  frameOpen_ = false;
+  if (!held_) {
+    held_ = true;
+    startUs_ = timeUs(evdevEvent.time);
+  }
+  frames_++;
+  last_ = evdevEvent.time;
+
+  if (timeUs(evdevEvent.time) - startUs_ >= windowUs_ || (maxFrames_ > 0 && frames_ >= maxFrames_)) {
+    Emit(out, evdevEvent.time);
+    out.push_back(evdevEvent);
+  }
+}
+
+int64_t EventCoalescer::DeadlineUs() const {
+  if (!held_ || windowUs_ > INT64_MAX - startUs_) return INT64_MAX;
+  return startUs_ + windowUs_;
+}
+
+bool EventCoalescer::Flush(std::deque<struct input_event>& out) {
+  if (!held_ || frameOpen_ || passthrough_) return false;
+
+  const struct timeval time = last_;
+  Emit(out, time);
+  Push(out, time, EV_SYN, SYN_REPORT, 0);
+  return true;
+}
@@ -0,0 +1,70 @@
+#ifndef EVENT_COALESCER_H_
+#define EVENT_COALESCER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+extern "C" {
+#include <linux/input.h>
+}
+
+// EventCoalescer merges the frames of high-rate relative and absolute
+// axes, e.g., of an 8 kHz mouse, in the native read path. EV_REL deltas
+// are summed and the latest value of each EV_ABS code (but the MT codes)
+// and of MSC_TIMESTAMP is kept; the frames are held and passed on as one
+// frame once window has passed since the first held frame, by kernel
+// time, or maxFrames (0 for no limit) frames are held. Any other event,
+// e.g., a key or switch transition, is never merged: the motion held is
+// passed on ahead of it, in its frame.
+//
+// Frames are held until the next frame past the window, so the reader
+// calls Flush() once DeadlineUs() has passed to pass on a last frame.
+class EventCoalescer {
+ public:
+  EventCoalescer(int64_t windowUs, uint32_t maxFrames);
+
+  // Observe an event read from the device, appending the events to pass
+  // on in its place, if any, to out.
+  void Process(const struct input_event& evdevEvent, std::deque<struct input_event>& out);
+
+  // Discard the frames held, e.g., after SYN_DROPPED.
+  void Reset();
+
+  // Kernel time at which the frames held are due, INT64_MAX if none.
+  int64_t DeadlineUs() const;
+
+  // True if no events are held and no frame is in progress.
+  bool Idle() const { return !held_ && !frameOpen_ && !passthrough_; }
+
+  // Pass on the frames held, as one frame, to out. Returns false if there
+  // is nothing to pass on, or a frame is in progress.
+  bool Flush(std::deque<struct input_event>& out);
+
+ private:
+  static bool Coalesced(const struct input_event& evdevEvent);
+
+  void Accumulate(const struct input_event& evdevEvent);
+  void Emit(std::deque<struct input_event>& out, const struct timeval& time);
+  void Push(std::deque<struct input_event>& out, const struct timeval& time,
+            unsigned int type, unsigned int code, int32_t value);
+
+  int64_t windowUs_;
+  uint32_t maxFrames_;
+
+  int32_t rel_[REL_CNT];          // summed deltas
+  int32_t abs_[ABS_CNT];          // latest values
+  int32_t mscTimestamp_;
+  uint8_t relSet_[(REL_CNT + 7) / 8];
+  uint8_t absSet_[(ABS_CNT + 7) / 8];
+  bool mscTimestampSet_;
+
+  bool held_;                     // whole frames are held
+  bool frameOpen_;                // the frame in progress has merged events
+  bool passthrough_;              // the frame in progress has events passed on
+  uint32_t frames_;               // number of frames held
+  int64_t startUs_;               // time of the first frame held
+  struct timeval last_;           // time of the last frame held
+};
+
+#endif  // EVENT_COALESCER_H_
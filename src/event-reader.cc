@@ -0,0 +1,374 @@
+#include <algorithm>
+#include <deque>
+#include <memory>
+
+#include "event-reader.h"
+#include "addon-data.h"
+#include "evdevjs.h"
+
+extern "C" {
+#include <errno.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+}
+
+using namespace Napi;
+
+static const int MAX_EPOLL_EVENTS = 32;
+static const uint64_t WAKE_ID = UINT64_MAX;
+
+// Record the delivery latency of batch to the stats of its devices.
+static void recordLatency(Env env, const EventBatch* batch) {
+  AddonData* data = env.GetInstanceData<AddonData>();
+  const std::vector<int32_t>& records = batch->records;
+
+  if (batch->devid != 0) {
+    DeviceHandle* device = data->devices.Get(batch->devid);
+    if (device != nullptr) device->source->Delivered(records.data(), records.size(), batch->mode);
+    return;
+  }
+
+  const int64_t nowUs = EventStats::NowUs();
+  for (size_t offset = 0; offset < records.size(); offset += TAGGED_EVENT_RECORD_SIZE) {
+    DeviceHandle* device = data->devices.Get(records[offset]);
+    if (device != nullptr) device->source->stats().AddLatency(nowUs, records[offset + 1], records[offset + 2]);
+  }
+}
+
+static void CallJs(Env env, Function callback, EventBatch* batch) {
+  if (env != nullptr && callback != nullptr) {
+    if (!batch->failed) recordLatency(env, batch);
+
+    Value records = env.Null();
+    if (!batch->failed) {
+      Int32Array array = Int32Array::New(env, batch->records.size());
+      memcpy(array.Data(), batch->records.data(), batch->records.size() * sizeof(int32_t));
+      records = array;
+    }
+    callback.Call({Number::New(env, (double)batch->devid), records});
+  }
+
+  delete batch;
+}
+
+// Merge the sorted tagged records [mid, end) into the sorted records
+// [begin, mid) of records, ordered by kernel timestamp.
+static void mergeByTimestamp(std::vector<int32_t>& records, size_t mid) {
+  struct TaggedRecord {
+    int32_t data[TAGGED_EVENT_RECORD_SIZE];
+  };
+  static_assert(sizeof(TaggedRecord) == TAGGED_EVENT_RECORD_SIZE * sizeof(int32_t),
+                "TaggedRecord must be packed");
+
+  TaggedRecord* begin = reinterpret_cast<TaggedRecord*>(records.data());
+  TaggedRecord* end = begin + records.size() / TAGGED_EVENT_RECORD_SIZE;
+  std::inplace_merge(begin, begin + mid / TAGGED_EVENT_RECORD_SIZE, end,
+    [](const TaggedRecord& a, const TaggedRecord& b) {
+      return a.data[1] < b.data[1] || (a.data[1] == b.data[1] && a.data[2] < b.data[2]);
+    });
+}
+
+EventReader::EventReader(Env env, Function callback, int flags)
+  : flags_(flags), merged_(nullptr) {
+  epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+  wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+  struct epoll_event wakeEvent = {};
+  wakeEvent.events = EPOLLIN;
+  wakeEvent.data.u64 = WAKE_ID;
+  epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &wakeEvent);
+
+  tsfn_ = ThreadSafeFunction::New(env, callback, "EventReader", 0, 1);
+  thread_ = std::thread(&EventReader::Run, this);
+}
+
+EventReader::~EventReader() {
+  Stop();
+}
+
+bool EventReader::Add(int devid, EventSource* source, EventRing* ring, int mode) {
+  const int fd = libevdev_get_fd(source->evdev());
+  std::unique_ptr<EventRing> ownedRing(ring);
+  if (fd < 0) return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (devices_.count(devid) > 0) return false;
+
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.u64 = (uint64_t)devid;
+  if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) < 0) return false;
+
+  // merged while the consumer lags, flushed once it catches up
+  EventCoalescer* coalescer =
+    ring != nullptr && ring->policy() == RING_COALESCE ? new EventCoalescer(INT64_MAX, 0) : nullptr;
+  devices_[devid] = Source{source, ownedRing.release(), ring ? READ_EVENTS : mode, false, false, coalescer};
+  return true;
+}
+
+bool EventReader::Remove(int devid) {
+  // holding mutex_ guarantees the reader thread is not inside Drain()
+  // for this device, so the caller may free the libevdev once we return
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = devices_.find(devid);
+  if (it == devices_.end()) return false;
+
+  if (!it->second.failed) {
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, libevdev_get_fd(it->second.source->evdev()), nullptr);
+  }
+  delete it->second.ring;
+  delete it->second.coalescer;
+  devices_.erase(it);
+  return true;
+}
+
+bool EventReader::Resume(int devid) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = devices_.find(devid);
+  if (it == devices_.end() || !it->second.blocked || it->second.failed) return false;
+
+  // holding mutex_ keeps the reader thread out of Drain(), this thread
+  // is the ring's producer meanwhile
+  Source& source = it->second;
+  source.blocked = false;
+  source.ring->SetBlocked(false);
+
+  if (source.coalescer != nullptr) {
+    records_.clear();
+    Coalesce(source);
+    source.ring->Push(records_.data(), records_.size() / EVENT_RECORD_SIZE);
+    Notify(devid, source);
+    return true;
+  }
+
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.u64 = (uint64_t)devid;
+  epoll_ctl(epollFd_, EPOLL_CTL_ADD, libevdev_get_fd(source.source->evdev()), &event);
+
+  // events libevdev read ahead of the pause raise no epoll wakeup if the
+  // kernel's queue is empty, read them now
+  if (libevdev_has_event_pending(source.source->evdev()) > 0) {
+    while (Read(devid, source)) {}
+  }
+  return true;
+}
+
+void EventReader::Stop() {
+  if (!thread_.joinable()) return;
+
+  uint64_t one = 1;
+  if (write(wakeFd_, &one, sizeof(one)) < 0) {
+    // eventfd write only fails on counter overflow, the thread is awake anyway
+  }
+  thread_.join();
+
+  close(wakeFd_);
+  close(epollFd_);
+  tsfn_.Release();
+
+  for (auto& entry : devices_) {
+    delete entry.second.ring;
+    delete entry.second.coalescer;
+  }
+  devices_.clear();
+}
+
+void EventReader::Run() {
+  struct epoll_event events[MAX_EPOLL_EVENTS];
+
+  while (true) {
+    int n = epoll_wait(epollFd_, events, MAX_EPOLL_EVENTS, CoalesceTimeoutMs());
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+
+    if (flags_ & READER_MERGE) {
+      merged_ = new EventBatch{0, false, {}, READ_EVENTS};
+    }
+
+    for (int i = 0; i < n; i++) {
+      if (events[i].data.u64 == WAKE_ID) {
+        delete merged_;
+        merged_ = nullptr;
+        return;
+      }
+      Drain((int)events[i].data.u64);
+    }
+    FlushCoalesced();
+
+    if (merged_ != nullptr) {
+      Deliver(merged_);
+      merged_ = nullptr;
+    }
+  }
+}
+
+int EventReader::CoalesceTimeoutMs() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t deadlineUs = INT64_MAX;
+  for (auto& entry : devices_) {
+    if (!entry.second.failed) deadlineUs = std::min(deadlineUs, entry.second.source->CoalesceDeadlineUs());
+  }
+  if (deadlineUs == INT64_MAX) return -1;
+
+  // rounded up, not to wake before the deadline
+  const int64_t timeoutUs = deadlineUs - EventStats::NowUs();
+  return timeoutUs <= 0 ? 0 : (int)std::min<int64_t>((timeoutUs + 999) / 1000, INT32_MAX);
+}
+
+void EventReader::FlushCoalesced() {
+  std::vector<int> due;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int64_t nowUs = EventStats::NowUs();
+    for (auto& entry : devices_) {
+      if (!entry.second.failed && entry.second.source->FlushCoalesced(nowUs)) due.push_back(entry.first);
+    }
+  }
+
+  for (int devid : due) Drain(devid);
+}
+
+void EventReader::Drain(int devid) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = devices_.find(devid);
+  if (it == devices_.end() || it->second.failed) return;
+
+  while (Read(devid, it->second)) {}
+}
+
+// Read the events of a device once, holding mutex_. Returns true if
+// events are left to read that raise no epoll wakeup.
+bool EventReader::Read(int devid, Source& source) {
+  records_.clear();
+
+  // a full blocking ring stops reading the device, the kernel queue
+  // holding its events until the consumer resumes it
+  size_t max = SIZE_MAX;
+  if (source.ring != nullptr && source.ring->policy() == RING_BLOCK) {
+    if (source.blocked) return false;
+    if (source.ring->Space() == 0 && !Pause(source)) return false;
+    max = source.ring->Space();
+  }
+
+  int status;
+  if (source.mode == READ_FRAMES) {
+    status = source.source->ReadFrames();
+    source.source->TakeFrames(records_);
+  } else if (source.mode == READ_TOUCH_FRAMES) {
+    status = source.source->ReadTouchFrames();
+    source.source->touches().TakeFrames(records_);
+  } else if (source.mode == READ_HOTKEYS) {
+    status = source.source->ReadHotkeys();
+    source.source->hotkeys().TakeMatches(records_);
+  } else {
+    status = source.source->ReadEvents(records_, max);
+  }
+
+  if (source.coalescer != nullptr) Coalesce(source);
+
+  const size_t count = records_.size() / EVENT_RECORD_SIZE;
+  if (source.mode != READ_EVENTS) {
+    Deliver(new EventBatch{devid, false, records_, source.mode});
+  } else if (source.ring != nullptr) {
+    source.ring->Push(records_.data(), count);
+    Notify(devid, source);
+  } else if (merged_ != nullptr) {
+    std::vector<int32_t>& merged = merged_->records;
+    const size_t mid = merged.size();
+    for (size_t i = 0; i < count; i++) {
+      merged.push_back(devid);
+      merged.insert(merged.end(),
+                    records_.begin() + i * EVENT_RECORD_SIZE,
+                    records_.begin() + (i + 1) * EVENT_RECORD_SIZE);
+    }
+    if ((flags_ & READER_SORT_BY_TIME) && mid > 0) {
+      mergeByTimestamp(merged, mid);
+    }
+  } else {
+    Deliver(new EventBatch{devid, false, records_, READ_EVENTS});
+  }
+
+  if (status < 0) {
+    // device is gone or unreadable, stop polling it and report the error;
+    // the entry is released by Remove() on the JS thread
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, libevdev_get_fd(source.source->evdev()), nullptr);
+    source.failed = true;
+    Deliver(new EventBatch{devid, true, {}, source.mode});
+    return false;
+  }
+
+  // a read capped at the ring's space leaves the rest of the events in
+  // libevdev's queue, where they raise no epoll wakeup once the kernel's
+  // queue is empty: pause until the consumer makes room, or read on if
+  // it already has
+  return count >= max && source.source->Pending() > 0 && Pause(source);
+}
+
+bool EventReader::Pause(Source& source) {
+  source.ring->SetBlocked(true);
+
+  // the consumer may have made room before it could see the flag
+  if (source.ring->Space() > 0) {
+    source.ring->SetBlocked(false);
+    return true;
+  }
+
+  epoll_ctl(epollFd_, EPOLL_CTL_DEL, libevdev_get_fd(source.source->evdev()), nullptr);
+  source.blocked = true;
+  return false;
+}
+
+void EventReader::Coalesce(Source& source) {
+  const size_t count = records_.size() / EVENT_RECORD_SIZE;
+  if (source.coalescer->Idle() && source.ring->Space() >= count) return;
+
+  std::deque<struct input_event> out;
+  for (size_t i = 0; i < count; i++) {
+    const int32_t* record = records_.data() + i * EVENT_RECORD_SIZE;
+    struct input_event evdevEvent = {};
+    evdevEvent.time.tv_sec = record[0];
+    evdevEvent.time.tv_usec = record[1];
+    evdevEvent.type = record[2];
+    evdevEvent.code = record[3];
+    evdevEvent.value = record[4];
+    source.coalescer->Process(evdevEvent, out);
+  }
+  // the motion merged so far is held until there is room for it
+  if (source.ring->Space() > out.size()) source.coalescer->Flush(out);
+
+  records_.resize(out.size() * EVENT_RECORD_SIZE);
+  for (size_t i = 0; i < out.size(); i++) {
+    writeEventRecord(records_.data() + i * EVENT_RECORD_SIZE, out[i]);
+  }
+
+  // the consumer flushes the motion held once it made room
+  if (!source.coalescer->Idle()) {
+    source.blocked = true;
+    source.ring->SetBlocked(true);
+  }
+}
+
+void EventReader::Deliver(EventBatch* batch) {
+  if (!batch->failed && batch->records.empty()) {
+    delete batch;
+    return;
+  }
+
+  if (tsfn_.NonBlockingCall(batch, CallJs) != napi_ok) {
+    delete batch;
+  }
+}
+
+void EventReader::Notify(int devid, Source& source) {
+  if (!source.ring->TakeWaiting()) return;
+
+  EventBatch* batch = new EventBatch{devid, false, {}, READ_EVENTS};
+  if (tsfn_.NonBlockingCall(batch, CallJs) != napi_ok) {
+    delete batch;
+  }
+}
@@ -0,0 +1,113 @@
+#ifndef EVENT_READER_H_
+#define EVENT_READER_H_
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "napi.h"
+#include "event-ring.h"
+#include "event-source.h"
+
+extern "C" {
+#include <libevdev/libevdev.h>
+}
+
+// Events read during one epoll wakeup, either from the single device devid
+// or, for a merged batch, tagged records from every device (devid is 0).
+// A failed batch reports a read error on devid (e.g., ENODEV).
+struct EventBatch {
+  int devid;
+  bool failed;
+  std::vector<int32_t> records;
+  int mode;     // READ_EVENTS, READ_FRAMES, READ_TOUCH_FRAMES or READ_HOTKEYS
+};
+
+// EventReader flags
+static const int READER_MERGE = 1;          // deliver one tagged batch per wakeup
+static const int READER_SORT_BY_TIME = 2;   // merge-sort a merged batch by timestamp
+
+// EventReader drains libevdev devices on a dedicated thread.
+//
+// The reader epolls the fd of every device added to it and, when an fd
+// becomes readable, drains all pending events from the device's EventSource.
+// Each device's events are delivered to the JS callback as one packed
+// Int32Array batch via a ThreadSafeFunction:
+//    callback(devid: number, records: Int32Array | null)
+// or, for a device added with READ_FRAMES, READ_TOUCH_FRAMES or
+// READ_HOTKEYS, as its completed packed frames, touch frames or hotkey
+// matches, a batch being delivered only if there are any,
+// or, when the device was added with an EventRing, written to the ring
+// without waking JS but for a consumer waiting on the ring, woken with an
+// empty batch. When the ring is full its overflow policy applies (see
+// event-ring.h). Read errors are always reported via the callback.
+//
+// With READER_MERGE, one reader multiplexes many devices: all events read
+// in a wakeup are delivered as a single batch of tagged records
+//    callback(0, records: Int32Array)
+// optionally merge-sorted by kernel timestamp (READER_SORT_BY_TIME).
+//
+// Coalesced frames held by a device's EventSource (see event-coalescer.h)
+// are drained once due, the epoll wait timing out at the earliest deadline.
+//
+// The delivery latency of the events (see event-stats.h) is recorded as
+// the callback is called; events written to a ring are not measured.
+class EventReader {
+ public:
+  EventReader(Napi::Env env, Napi::Function callback, int flags = 0);
+  ~EventReader();
+
+  // Add and Remove must be called from the JS thread.
+  bool Add(int devid, EventSource* source, EventRing* ring = nullptr, int mode = READ_EVENTS);
+  bool Remove(int devid);
+
+  // Call fn() holding the lock the reader thread reads devid under, the
+  // device's libevdev may then be used by the calling thread. Returns
+  // false, without calling fn, if the device is not read by this reader.
+  template <typename Fn>
+  bool WithDevice(int devid, Fn fn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (devices_.count(devid) == 0) return false;
+
+    fn();
+    return true;
+  }
+  void Stop();
+
+  // Resume reading a device whose ring the consumer made room in, after
+  // the reader held records back for it (RING_BLOCKED). JS thread only.
+  bool Resume(int devid);
+
+ private:
+  struct Source {
+    EventSource* source;
+    EventRing* ring;    // owned, nullptr for callback delivery
+    int mode;           // READ_EVENTS, READ_FRAMES, READ_TOUCH_FRAMES or READ_HOTKEYS
+    bool failed;
+    bool blocked;       // records are held back for a full ring
+    EventCoalescer* coalescer;  // owned, for a RING_COALESCE ring
+  };
+
+  void Run();
+  int CoalesceTimeoutMs();
+  void FlushCoalesced();
+  void Drain(int devid);
+  bool Read(int devid, Source& source);
+  bool Pause(Source& source);
+  void Coalesce(Source& source);
+  void Deliver(EventBatch* batch);
+  void Notify(int devid, Source& source);
+
+  int flags_;
+  int epollFd_;
+  int wakeFd_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::map<int, Source> devices_;
+  std::vector<int32_t> records_;  // drain scratch, guarded by mutex_
+  EventBatch* merged_;            // current merged batch, reader thread only
+  Napi::ThreadSafeFunction tsfn_;
+};
+
+#endif  // EVENT_READER_H_
@@ -0,0 +1,117 @@
+#include <cmath>
+#include <cstring>
+
+#include "event-remap.h"
+#include "evdevjs.h"
+
+EventRemap* EventRemap::New(const struct libevdev* evdev, int uinputid, int fd,
+                            const std::vector<RemapRule>& rules) {
+  if (fd < 0) return nullptr;
+
+  EventRemap* remap = new EventRemap(uinputid, fd, rules);
+  for (size_t i = 0; i < rules.size(); i++) {
+    const RemapRule& rule = rules[i];
+    if (rule.type >= EV_CNT || rule.code >= KEY_CNT || rule.type == EV_SYN ||
+        rule.toType >= EV_CNT || rule.toCode >= KEY_CNT || rule.toType == EV_SYN ||
+        !std::isfinite(rule.scale) || !std::isfinite(rule.offset) ||
+        remap->Find(rule.type, rule.code) != nullptr) {
+      delete remap;
+      return nullptr;
+    }
+
+    std::vector<int16_t>& codes = remap->index_[rule.type];
+    if (codes.size() <= rule.code) codes.resize(rule.code + 1, -1);
+    codes[rule.code] = (int16_t)i;
+  }
+
+  for (unsigned int code = 0; code < ABS_CNT; code++) {
+    const struct input_absinfo* absInfo = libevdev_get_abs_info(evdev, code);
+    remap->absRange_[code] = absInfo != nullptr ? absInfo->minimum + absInfo->maximum : 0;
+  }
+
+  return remap;
+}
+
+EventRemap::EventRemap(int uinputid, int fd, const std::vector<RemapRule>& rules)
+  : uinputid_(uinputid), fd_(fd), rules_(rules), notified_(false) {
+  memset(absRange_, 0, sizeof(absRange_));
+}
+
+const RemapRule* EventRemap::Find(unsigned int type, unsigned int code) const {
+  if (type >= EV_CNT) return nullptr;
+
+  const std::vector<int16_t>& codes = index_[type];
+  if (code >= codes.size() || codes[code] < 0) return nullptr;
+  return &rules_[codes[code]];
+}
+
+int32_t EventRemap::Apply(const RemapRule& rule, int32_t value) const {
+  if (rule.scale != 1.0f || rule.offset != 0.0f) {
+    value = (int32_t)lroundf(value * rule.scale + rule.offset);
+  }
+
+  if (rule.invert) {
+    if (rule.type == EV_ABS && rule.code < ABS_CNT) {
+      value = absRange_[rule.code] - value;
+    } else if (rule.type == EV_KEY) {
+      // a repeat (2) stays a repeat
+      if (value == 0 || value == 1) value = 1 - value;
+    } else {
+      value = -value;
+    }
+  }
+
+  return value;
+}
+
+void EventRemap::Append(unsigned int type, unsigned int code, int32_t value) {
+  frame_.push_back((int32_t)type);
+  frame_.push_back((int32_t)code);
+  frame_.push_back(value);
+}
+
+void EventRemap::Flush() {
+  // a frame left empty by drop rules is not written; a failed write,
+  // e.g., of a destroyed uinput, loses the frame only
+  if (!frame_.empty()) {
+    writeUInputEvents(fd_, frame_.data(), frame_.size() / UINPUT_EVENT_SIZE, true, scratch_);
+  }
+
+  frame_.clear();
+}
+
+bool EventRemap::Process(const struct input_event& evdevEvent) {
+  if (evdevEvent.type == EV_SYN) {
+    if (evdevEvent.code == SYN_DROPPED) {
+      // the events since the last SYN_REPORT are incomplete
+      frame_.clear();
+      const bool notified = notified_;
+      notified_ = false;
+      return !notified;
+    }
+
+    if (evdevEvent.code == SYN_REPORT) {
+      Flush();
+      const bool notified = notified_;
+      notified_ = false;
+      return !notified;
+    }
+
+    // e.g., SYN_MT_REPORT of type A multi-touch
+    Append(evdevEvent.type, evdevEvent.code, evdevEvent.value);
+    return true;
+  }
+
+  const RemapRule* rule = Find(evdevEvent.type, evdevEvent.code);
+  if (rule == nullptr) {
+    Append(evdevEvent.type, evdevEvent.code, evdevEvent.value);
+    return true;
+  }
+
+  if (!rule->drop) {
+    Append(rule->toType, rule->toCode, Apply(*rule, evdevEvent.value));
+  }
+
+  if (rule->notify) notified_ = true;
+  return !rule->notify;
+}
@@ -0,0 +1,67 @@
+#ifndef EVENT_REMAP_H_
+#define EVENT_REMAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include <linux/input.h>
+#include <libevdev/libevdev.h>
+}
+
+// Rule of a remap table for one input (type, code).
+struct RemapRule {
+  unsigned int type;
+  unsigned int code;
+  unsigned int toType;    // output type and code, the input's by default
+  unsigned int toCode;
+  float scale;            // value * scale + offset, rounded
+  float offset;
+  bool invert;            // EV_ABS within the input's absinfo range, EV_KEY press/release, others negated
+  bool drop;              // not forwarded
+  bool notify;            // also delivered to JS listeners, as read
+};
+
+// EventRemap forwards a (grabbed) device's events to a uinput device in
+// the native read path, on the thread that reads the device. Each event
+// is looked up in a remap table; events without a rule are forwarded
+// unchanged. Remapped events are buffered up to their SYN_REPORT and the
+// frame is written to the uinput with a single write(). A frame cut short
+// by SYN_DROPPED is discarded; the sync diff that follows is forwarded as
+// a frame of its own.
+//
+// Forwarded and dropped events are consumed, JS sees only the events of
+// notify rules, each frame's SYN_REPORT included.
+class EventRemap {
+ public:
+  // Index rules over the device's absinfo. Returns nullptr if a rule
+  // is out of range or duplicates another's input.
+  static EventRemap* New(const struct libevdev* evdev, int uinputid, int fd,
+                         const std::vector<RemapRule>& rules);
+
+  int uinputid() const { return uinputid_; }
+
+  // Remap an event read from the device. Returns true if it is consumed.
+  bool Process(const struct input_event& evdevEvent);
+
+ private:
+  EventRemap(int uinputid, int fd, const std::vector<RemapRule>& rules);
+
+  const RemapRule* Find(unsigned int type, unsigned int code) const;
+  int32_t Apply(const RemapRule& rule, int32_t value) const;
+  void Append(unsigned int type, unsigned int code, int32_t value);
+  void Flush();
+
+  int uinputid_;
+  int fd_;
+  std::vector<RemapRule> rules_;
+  std::vector<int16_t> index_[EV_CNT];    // rule by code per type, -1 if none
+  int32_t absRange_[ABS_CNT];             // min + max of each input axis
+
+  std::vector<int32_t> frame_;            // packed [type, code, value] events
+  std::vector<struct input_event> scratch_;
+  bool notified_;                         // the frame in progress has notify events
+};
+
+#endif  // EVENT_REMAP_H_
@@ -0,0 +1,135 @@
+#ifndef EVENT_RING_H_
+#define EVENT_RING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "napi.h"
+#include "evdevjs.h"
+
+// Single-producer/single-consumer event ring living in a SharedArrayBuffer.
+// The native reader thread is the producer; JS (main thread or a worker)
+// consumes with Atomics. Layout as int32 slots, shared with lib/event-ring.ts:
+//    [0] head     - free-running count of records written (producer)
+//    [1] tail     - free-running count of records read (consumer)
+//    [2] capacity - number of records, a power of 2
+//    [3] overflow - count of records dropped because the ring was full
+//    [4] policy   - what the producer does when the ring is full, see below
+//    [5] waiting  - set by a consumer waiting for records, cleared by the
+//                   producer as it wakes it
+//    [6] blocked  - set by the reader while it stops reading the device of
+//                   a full RING_BLOCK ring, the consumer resumes it
+//    [7] reserved
+//    [8..] capacity * EVENT_RECORD_SIZE packed event records
+static const size_t RING_HEAD = 0;
+static const size_t RING_TAIL = 1;
+static const size_t RING_CAPACITY = 2;
+static const size_t RING_OVERFLOW = 3;
+static const size_t RING_POLICY = 4;
+static const size_t RING_WAITING = 5;
+static const size_t RING_BLOCKED = 6;
+static const size_t RING_HEADER_SIZE = 8;
+
+// Overflow policies
+static const int32_t RING_DROP_NEWEST = 0;  // records that do not fit are dropped
+static const int32_t RING_BLOCK = 1;        // the device is not read until there is room
+static const int32_t RING_DROP_OLDEST = 2;  // the oldest records are overwritten, the
+                                            // consumer commits its reads with a CAS of tail
+static const int32_t RING_COALESCE = 3;     // axis frames are merged while there is no
+                                            // room, see event-coalescer.h
+
+class EventRing {
+ public:
+  // Validate the ring layout of array. Returns nullptr if invalid.
+  static EventRing* New(Napi::Int32Array array) {
+    const size_t length = array.ElementLength();
+    if (length < RING_HEADER_SIZE) return nullptr;
+
+    int32_t* header = array.Data();
+    const uint32_t capacity = (uint32_t)header[RING_CAPACITY];
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) return nullptr;
+    if (length < RING_HEADER_SIZE + capacity * EVENT_RECORD_SIZE) return nullptr;
+    if (header[RING_POLICY] < RING_DROP_NEWEST || header[RING_POLICY] > RING_COALESCE) return nullptr;
+
+    return new EventRing(array, header, capacity);
+  }
+
+  int32_t policy() const { return policy_; }
+
+  // Number of records that can be pushed without overflow.
+  size_t Space() const {
+    const uint32_t head = __atomic_load_n((uint32_t*)&header_[RING_HEAD], __ATOMIC_RELAXED);
+    const uint32_t tail = __atomic_load_n((uint32_t*)&header_[RING_TAIL], __ATOMIC_SEQ_CST);
+    return capacity_ - (head - tail);
+  }
+
+  // Append count packed records. Records that do not fit are dropped,
+  // the newest or, with RING_DROP_OLDEST, the oldest, and counted as
+  // overflow. Called from the producer thread only.
+  void Push(const int32_t* records, size_t count) {
+    uint32_t head = __atomic_load_n((uint32_t*)&header_[RING_HEAD], __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n((uint32_t*)&header_[RING_TAIL], __ATOMIC_ACQUIRE);
+
+    if (policy_ == RING_DROP_OLDEST) {
+      size_t dropped = 0;
+      if (count > capacity_) {
+        dropped = count - capacity_;
+        records += dropped * EVENT_RECORD_SIZE;
+        count = capacity_;
+      }
+
+      // move tail past the records overwritten, unless the consumer did
+      while (capacity_ - (head - tail) < count) {
+        const uint32_t overwritten = count - (capacity_ - (head - tail));
+        if (__atomic_compare_exchange_n((uint32_t*)&header_[RING_TAIL], &tail, tail + overwritten,
+                                        false, __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE)) {
+          tail += overwritten;
+          dropped += overwritten;
+          break;
+        }
+      }
+      if (dropped > 0) __atomic_add_fetch(&header_[RING_OVERFLOW], (int32_t)dropped, __ATOMIC_RELAXED);
+    }
+
+    const size_t space = capacity_ - (head - tail);
+    const size_t n = count < space ? count : space;
+    for (size_t i = 0; i < n; i++, head++) {
+      int32_t* slot = records_ + (head & (capacity_ - 1)) * EVENT_RECORD_SIZE;
+      memcpy(slot, records + i * EVENT_RECORD_SIZE, EVENT_RECORD_SIZE * sizeof(int32_t));
+    }
+
+    __atomic_store_n((uint32_t*)&header_[RING_HEAD], head, __ATOMIC_SEQ_CST);
+    if (n < count) {
+      __atomic_add_fetch(&header_[RING_OVERFLOW], (int32_t)(count - n), __ATOMIC_RELAXED);
+    }
+  }
+
+  // Clear the consumer's waiting flag. Returns true if it was set, the
+  // consumer is then to be woken. Sequentially consistent with the head
+  // store of Push() so a consumer that found the ring empty is never missed.
+  bool TakeWaiting() {
+    return __atomic_exchange_n(&header_[RING_WAITING], 0, __ATOMIC_SEQ_CST) != 0;
+  }
+
+  void SetBlocked(bool blocked) {
+    __atomic_store_n(&header_[RING_BLOCKED], blocked ? 1 : 0, __ATOMIC_SEQ_CST);
+  }
+
+ private:
+  EventRing(Napi::Int32Array array, int32_t* header, uint32_t capacity)
+    : buffer_(Napi::Persistent(array.As<Napi::Object>())),
+      header_(header),
+      records_(header + RING_HEADER_SIZE),
+      capacity_(capacity),
+      policy_(header[RING_POLICY]) {}
+
+  // keeps the SharedArrayBuffer alive while the producer writes to it
+  Napi::ObjectReference buffer_;
+  int32_t* header_;
+  int32_t* records_;
+  uint32_t capacity_;
+  int32_t policy_;
+};
+
+#endif  // EVENT_RING_H_
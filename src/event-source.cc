@@ -0,0 +1,493 @@
+#include <algorithm>
+#include <cstring>
+
+#include "event-source.h"
+#include "evdevjs.h"
+
+extern "C" {
+#include <errno.h>
+#include <time.h>
+}
+
+EventSource::EventSource(struct libevdev* evdev)
+  : evdev_(evdev), syncing_(false), frame_(FRAME_HEADER_SIZE, 0), filtering_(false),
+    capturing_(false), capture_(nullptr), captureDevice_(0),
+    processingAxes_(false), axes_(nullptr), consumed_(false),
+    remapping_(false), remap_(nullptr), coalescing_(false), coalescer_(nullptr), batch_(0) {
+  memset(dirty_, 0, sizeof(dirty_));
+  memset(filterTypes_, 0, sizeof(filterTypes_));
+  memset(filterCodes_, 0, sizeof(filterCodes_));
+}
+
+EventSource::~EventSource() {
+  delete axes_;
+  delete remap_;
+  delete coalescer_;
+}
+
+int EventSource::UseMonotonicClock() {
+  const int result = libevdev_set_clock_id(evdev_, CLOCK_MONOTONIC);
+  stats_.SetMonotonic(result == 0);
+  return result;
+}
+
+void EventSource::EndBatch() {
+  if (batch_ == 0) return;
+
+  stats_.AddBatch(batch_);
+  batch_ = 0;
+}
+
+void EventSource::Delivered(const int32_t* data, size_t length, int mode) {
+  if (length == 0 || !stats_.monotonic()) return;
+
+  const int64_t nowUs = EventStats::NowUs();
+  size_t offset = 0;
+  if (mode == READ_EVENTS) {
+    for (; offset + EVENT_RECORD_SIZE <= length; offset += EVENT_RECORD_SIZE) {
+      stats_.AddLatency(nowUs, data[offset], data[offset + 1]);
+    }
+  } else if (mode == READ_FRAMES) {
+    while (offset + FRAME_HEADER_SIZE <= length) {
+      const int32_t* records = data + offset + FRAME_HEADER_SIZE;
+      for (int32_t i = 0; i < data[offset + 1]; i++) {
+        stats_.AddLatency(nowUs, records[i * EVENT_RECORD_SIZE], records[i * EVENT_RECORD_SIZE + 1]);
+      }
+      offset += FRAME_HEADER_SIZE + data[offset + 1] * EVENT_RECORD_SIZE;
+    }
+  } else if (mode == READ_HOTKEYS) {
+    // a match carries the frame completing it, measured at its SYN_REPORT
+    while (offset + HOTKEY_MATCH_HEADER_SIZE <= length) {
+      const int32_t count = data[offset + 2];
+      if (count > 0) {
+        const int32_t* report = data + offset + HOTKEY_MATCH_HEADER_SIZE + (count - 1) * EVENT_RECORD_SIZE;
+        stats_.AddLatency(nowUs, report[0], report[1]);
+      }
+      offset += HOTKEY_MATCH_HEADER_SIZE + count * EVENT_RECORD_SIZE;
+    }
+  } else if (mode == READ_TOUCH_FRAMES) {
+    // a touch frame carries the time of its SYN_REPORT
+    while (offset + TOUCH_FRAME_HEADER_SIZE <= length) {
+      stats_.AddLatency(nowUs, data[offset + 2], data[offset + 3]);
+      offset += TOUCH_FRAME_HEADER_SIZE + data[offset + 1] * TOUCH_CONTACT_SIZE;
+    }
+  }
+}
+
+int EventSource::Pending() {
+  // the sync diff is generated by libevdev on the next read, the fd
+  // need not be readable for it
+  if (syncing_ || !coalesced_.empty()) return 1;
+
+  return libevdev_has_event_pending(evdev_);
+}
+
+int EventSource::Next(struct input_event* evdevEvent) {
+  if (!coalesced_.empty()) {
+    // events passed on by the coalescer, already seen as read
+    *evdevEvent = coalesced_.front();
+    coalesced_.pop_front();
+    consumed_ = false;
+    return LIBEVDEV_READ_STATUS_SUCCESS;
+  }
+
+  if (syncing_) {
+    int result = libevdev_next_event(evdev_, LIBEVDEV_READ_FLAG_SYNC, evdevEvent);
+    if (result == LIBEVDEV_READ_STATUS_SYNC) {
+      batch_++;
+      stats_.Add(EventStats::EVENTS);
+      stats_.Add(EventStats::SYNC_EVENTS);
+      MarkDirty(*evdevEvent);
+      Capture(*evdevEvent);
+      consumed_ = Forward(*evdevEvent) || ProcessAxes(*evdevEvent);
+      if (consumed_) stats_.Add(EventStats::CONSUMED);
+      return result;
+    }
+
+    // -EAGAIN, the diff is drained, resume normal reading
+    syncing_ = false;
+  }
+
+  int result = libevdev_next_event(evdev_, LIBEVDEV_READ_FLAG_NORMAL, evdevEvent);
+  if (result == LIBEVDEV_READ_STATUS_SYNC) {
+    // evdevEvent is SYN_DROPPED, the sync diff follows
+    syncing_ = true;
+    batch_++;
+    stats_.Add(EventStats::EVENTS);
+    stats_.Add(EventStats::DROPPED);
+    Capture(*evdevEvent);
+    ResetCoalescer();
+    consumed_ = Forward(*evdevEvent);
+    if (consumed_) stats_.Add(EventStats::CONSUMED);
+  } else if (result == LIBEVDEV_READ_STATUS_SUCCESS) {
+    batch_++;
+    stats_.Add(EventStats::EVENTS);
+    if (evdevEvent->type == EV_SYN && evdevEvent->code == SYN_REPORT) stats_.Add(EventStats::FRAMES);
+    MarkDirty(*evdevEvent);
+    Capture(*evdevEvent);
+    consumed_ = Forward(*evdevEvent) || ProcessAxes(*evdevEvent) || !Coalesce(evdevEvent);
+    if (consumed_) stats_.Add(EventStats::CONSUMED);
+  }
+
+  return result;
+}
+
+void EventSource::Capture(const struct input_event& evdevEvent) {
+  if (!__atomic_load_n(&capturing_, __ATOMIC_RELAXED)) return;
+
+  captured_.push_back(evdevEvent);
+  if (evdevEvent.type != EV_SYN) return;
+
+  std::lock_guard<std::mutex> lock(captureMutex_);
+  if (capture_ != nullptr) {
+    capture_->Append(captureDevice_, captured_.data(), captured_.size());
+  }
+  captured_.clear();
+}
+
+void EventSource::SetCapture(CaptureWriter* capture, uint32_t device) {
+  std::lock_guard<std::mutex> lock(captureMutex_);
+  capture_ = capture;
+  captureDevice_ = device;
+  __atomic_store_n(&capturing_, capture != nullptr, __ATOMIC_RELAXED);
+}
+
+void EventSource::RemoveCapture(CaptureWriter* capture) {
+  std::lock_guard<std::mutex> lock(captureMutex_);
+  if (capture_ != capture) return;
+
+  capture_ = nullptr;
+  __atomic_store_n(&capturing_, false, __ATOMIC_RELAXED);
+}
+
+bool EventSource::ProcessAxes(const struct input_event& evdevEvent) {
+  if (!__atomic_load_n(&processingAxes_, __ATOMIC_RELAXED)) return false;
+
+  std::lock_guard<std::mutex> lock(axesMutex_);
+  return axes_ != nullptr && axes_->Process(evdevEvent, syncing_);
+}
+
+bool EventSource::Forward(const struct input_event& evdevEvent) {
+  if (!__atomic_load_n(&remapping_, __ATOMIC_RELAXED)) return false;
+
+  std::lock_guard<std::mutex> lock(remapMutex_);
+  return remap_ != nullptr && remap_->Process(evdevEvent);
+}
+
+void EventSource::SetRemap(EventRemap* remap) {
+  EventRemap* previous;
+  {
+    std::lock_guard<std::mutex> lock(remapMutex_);
+    previous = remap_;
+    remap_ = remap;
+    __atomic_store_n(&remapping_, remap != nullptr, __ATOMIC_RELAXED);
+  }
+
+  delete previous;
+}
+
+void EventSource::RemoveRemap(int uinputid) {
+  EventRemap* previous = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(remapMutex_);
+    if (remap_ == nullptr || remap_->uinputid() != uinputid) return;
+
+    previous = remap_;
+    remap_ = nullptr;
+    __atomic_store_n(&remapping_, false, __ATOMIC_RELAXED);
+  }
+
+  delete previous;
+}
+
+bool EventSource::Coalesce(struct input_event* evdevEvent) {
+  if (!__atomic_load_n(&coalescing_, __ATOMIC_RELAXED)) return true;
+
+  {
+    std::lock_guard<std::mutex> lock(coalescerMutex_);
+    if (coalescer_ == nullptr) return true;
+    coalescer_->Process(*evdevEvent, coalesced_);
+  }
+
+  if (coalesced_.empty()) return false;
+
+  *evdevEvent = coalesced_.front();
+  coalesced_.pop_front();
+  return true;
+}
+
+void EventSource::ResetCoalescer() {
+  if (!__atomic_load_n(&coalescing_, __ATOMIC_RELAXED)) return;
+
+  std::lock_guard<std::mutex> lock(coalescerMutex_);
+  if (coalescer_ != nullptr) coalescer_->Reset();
+}
+
+int64_t EventSource::CoalesceDeadlineUs() {
+  if (!__atomic_load_n(&coalescing_, __ATOMIC_RELAXED)) return INT64_MAX;
+
+  std::lock_guard<std::mutex> lock(coalescerMutex_);
+  if (coalescer_ == nullptr) return INT64_MAX;
+
+  const int64_t deadlineUs = coalescer_->DeadlineUs();
+  // kernel time is only comparable with NowUs() on CLOCK_MONOTONIC
+  if (deadlineUs != INT64_MAX && !stats_.monotonic()) return 0;
+  return deadlineUs;
+}
+
+bool EventSource::FlushCoalesced(int64_t nowUs) {
+  if (!__atomic_load_n(&coalescing_, __ATOMIC_RELAXED)) return false;
+  if (nowUs < CoalesceDeadlineUs()) return false;
+
+  std::lock_guard<std::mutex> lock(coalescerMutex_);
+  return coalescer_ != nullptr && coalescer_->Flush(coalesced_);
+}
+
+void EventSource::SetCoalescer(EventCoalescer* coalescer) {
+  EventCoalescer* previous;
+  {
+    std::lock_guard<std::mutex> lock(coalescerMutex_);
+    previous = coalescer_;
+    coalescer_ = coalescer;
+    __atomic_store_n(&coalescing_, coalescer != nullptr, __ATOMIC_RELAXED);
+  }
+
+  // the motion held is lost, as with a change of filter
+  delete previous;
+}
+
+bool EventSource::Deliverable(const struct input_event& evdevEvent) {
+  if (consumed_) return false;
+  if (Accept(evdevEvent)) return true;
+
+  stats_.Add(EventStats::DISCARDED);
+  return false;
+}
+
+void EventSource::SetAxes(AxisPipeline* pipeline) {
+  AxisPipeline* previous;
+  {
+    std::lock_guard<std::mutex> lock(axesMutex_);
+    previous = axes_;
+    axes_ = pipeline;
+    __atomic_store_n(&processingAxes_, pipeline != nullptr, __ATOMIC_RELAXED);
+  }
+
+  // the reader no longer uses it, release its buffer on the JS thread
+  delete previous;
+}
+
+void EventSource::MarkDirty(const struct input_event& evdevEvent) {
+  unsigned int bit;
+  if (evdevEvent.type == EV_KEY && evdevEvent.code < KEY_CNT) {
+    bit = DIRTY_KEY_OFFSET + evdevEvent.code;
+  } else if (evdevEvent.type == EV_ABS && evdevEvent.code < ABS_CNT) {
+    bit = DIRTY_ABS_OFFSET + evdevEvent.code;
+
+    // libevdev applied the event to its current slot
+    if (evdevEvent.code >= MT_CODE_FIRST && evdevEvent.code < MT_CODE_FIRST + MT_CODE_COUNT) {
+      const int slot = libevdev_get_current_slot(evdev_);
+      if (slot >= 0 && slot < (int)MAX_STATE_SLOTS) {
+        const unsigned int slotBit = DIRTY_SLOT_OFFSET + slot;
+        __atomic_or_fetch(&dirty_[slotBit / 8], (uint8_t)(1 << (slotBit % 8)), __ATOMIC_RELAXED);
+      }
+    }
+  } else {
+    return;
+  }
+
+  __atomic_or_fetch(&dirty_[bit / 8], (uint8_t)(1 << (bit % 8)), __ATOMIC_RELAXED);
+}
+
+void EventSource::TakeDirty(uint8_t* dst, size_t length) {
+  const size_t n = length < sizeof(dirty_) ? length : sizeof(dirty_);
+  for (size_t i = 0; i < n; i++) {
+    dst[i] = __atomic_exchange_n(&dirty_[i], 0, __ATOMIC_RELAXED);
+  }
+}
+
+void EventSource::SetFilter(bool enabled) {
+  __atomic_store_n(&filtering_, false, __ATOMIC_RELAXED);
+  memset(filterTypes_, 0, sizeof(filterTypes_));
+  memset(filterCodes_, 0, sizeof(filterCodes_));
+  __atomic_store_n(&filtering_, enabled, __ATOMIC_RELEASE);
+}
+
+static void setBit(uint8_t* bitmap, unsigned int bit, bool value) {
+  if (value) {
+    __atomic_or_fetch(&bitmap[bit / 8], (uint8_t)(1 << (bit % 8)), __ATOMIC_RELAXED);
+  } else {
+    __atomic_and_fetch(&bitmap[bit / 8], (uint8_t)~(1 << (bit % 8)), __ATOMIC_RELAXED);
+  }
+}
+
+bool EventSource::SetFilterType(unsigned int type, bool accepted) {
+  if (type >= EV_CNT) return false;
+
+  setBit(filterTypes_, type, accepted);
+  return true;
+}
+
+bool EventSource::SetFilterCode(unsigned int type, unsigned int code, bool accepted) {
+  if (type >= EV_CNT || code >= KEY_CNT) return false;
+
+  setBit(filterCodes_[type], code, accepted);
+  return true;
+}
+
+void EventSource::Drain() {
+  struct input_event evdevEvent;
+
+  while (Pending() > 0) {
+    if (Next(&evdevEvent) < 0) break;
+  }
+  EndBatch();
+}
+
+int EventSource::ReadEvents(std::vector<int32_t>& records, size_t max) {
+  struct input_event evdevEvent;
+  int pending = 0;
+
+  int status = 0;
+
+  for (size_t count = 0; count < max && (pending = Pending()) > 0;) {
+    const int result = Next(&evdevEvent);
+    if (result == -EAGAIN) break;
+    if (result < 0) {
+      status = result;
+      break;
+    }
+    if (!Deliverable(evdevEvent)) continue;
+
+    count++;
+    const size_t offset = records.size();
+    records.resize(offset + EVENT_RECORD_SIZE);
+    writeEventRecord(records.data() + offset, evdevEvent);
+  }
+
+  EndBatch();
+  if (status == 0 && pending < 0) status = pending;
+  return status;
+}
+
+int EventSource::ReadFrames() {
+  struct input_event evdevEvent;
+  int pending = 0;
+
+  int status = 0;
+
+  while ((pending = Pending()) > 0) {
+    const int result = Next(&evdevEvent);
+    if (result == -EAGAIN) break;
+    if (result < 0) {
+      status = result;
+      break;
+    }
+
+    AddToFrame(evdevEvent);
+  }
+
+  EndBatch();
+  if (status == 0 && pending < 0) status = pending;
+  return status;
+}
+
+int EventSource::ReadHotkeys() {
+  struct input_event evdevEvent;
+  int pending = 0;
+  int status = 0;
+
+  while ((pending = Pending()) > 0) {
+    const int result = Next(&evdevEvent);
+    if (result == -EAGAIN) break;
+    if (result < 0) {
+      status = result;
+      break;
+    }
+
+    hotkeys_.Add(evdev_, evdevEvent);
+  }
+
+  EndBatch();
+  if (status == 0 && pending < 0) status = pending;
+  return status;
+}
+
+int EventSource::ReadTouchFrames() {
+  struct input_event evdevEvent;
+  int pending = 0;
+
+  int status = 0;
+
+  while ((pending = Pending()) > 0) {
+    const int result = Next(&evdevEvent);
+    if (result == -EAGAIN) break;
+    if (result < 0) {
+      status = result;
+      break;
+    }
+
+    touches_.Add(evdev_, evdevEvent);
+  }
+
+  EndBatch();
+  if (status == 0 && pending < 0) status = pending;
+  return status;
+}
+
+void EventSource::AddToFrame(const struct input_event& evdevEvent) {
+  if (evdevEvent.type == EV_SYN && evdevEvent.code == SYN_DROPPED) {
+    // events since the last SYN_REPORT are incomplete, the diff replaces them
+    frame_.resize(FRAME_HEADER_SIZE);
+    frame_[0] = FRAME_FLAG_RESYNC;
+    frame_[1] = 0;
+    return;
+  }
+
+  // a SYN_REPORT is only consumed with a frame of nothing but consumed events
+  if (consumed_) return;
+
+  const bool report = evdevEvent.type == EV_SYN && evdevEvent.code == SYN_REPORT;
+  if (!report && !Deliverable(evdevEvent)) return;
+
+  const size_t offset = frame_.size();
+  frame_.resize(offset + EVENT_RECORD_SIZE);
+  writeEventRecord(frame_.data() + offset, evdevEvent);
+  frame_[1]++;
+
+  // libevdev terminates the sync diff with a SYN_REPORT too
+  if (report) {
+    // a frame left with only its SYN_REPORT by the filter is dropped
+    if (frame_[1] > 1 || frame_[0] != 0 || Accept(evdevEvent)) {
+      completed_.insert(completed_.end(), frame_.begin(), frame_.end());
+    }
+    frame_.resize(FRAME_HEADER_SIZE);
+    frame_[0] = 0;
+    frame_[1] = 0;
+  }
+}
+
+size_t EventSource::NextFrameSize() const {
+  if (completed_.empty()) return 0;
+
+  return FRAME_HEADER_SIZE + completed_[1] * EVENT_RECORD_SIZE;
+}
+
+size_t EventSource::TakeFrames(int32_t* dst, size_t capacity) {
+  size_t length = 0;
+
+  while (length < completed_.size()) {
+    const size_t frameSize = FRAME_HEADER_SIZE + completed_[length + 1] * EVENT_RECORD_SIZE;
+    if (length + frameSize > capacity) break;
+    length += frameSize;
+  }
+
+  std::copy(completed_.begin(), completed_.begin() + length, dst);
+  completed_.erase(completed_.begin(), completed_.begin() + length);
+  return length;
+}
+
+void EventSource::TakeFrames(std::vector<int32_t>& frames) {
+  frames.insert(frames.end(), completed_.begin(), completed_.end());
+  completed_.clear();
+}
@@ -0,0 +1,240 @@
+#ifndef EVENT_SOURCE_H_
+#define EVENT_SOURCE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "axis-pipeline.h"
+#include "capture-writer.h"
+#include "event-coalescer.h"
+#include "event-remap.h"
+#include "event-stats.h"
+#include "hotkey-matcher.h"
+#include "touch-tracker.h"
+
+extern "C" {
+#include <linux/input.h>
+#include <libevdev/libevdev.h>
+}
+
+// Packed frame layout shared with lib/frame.ts, as int32 slots:
+//    [flags, count, count * EVENT_RECORD_SIZE event records]
+// A frame holds the events up to and including their SYN_REPORT.
+static const size_t FRAME_HEADER_SIZE = 2;
+static const int32_t FRAME_FLAG_RESYNC = 1;  // state diff after SYN_DROPPED
+
+// How a device's events are delivered by EventReader and lib/event-reader.ts
+static const int READ_EVENTS = 0;         // packed event records
+static const int READ_FRAMES = 1;         // packed frames
+static const int READ_TOUCH_FRAMES = 2;   // packed touch frames, see touch-tracker.h
+static const int READ_HOTKEYS = 3;        // packed hotkey matches, see hotkey-matcher.h
+
+// Device state snapshot layout shared with lib/device-state.ts.
+// MT slot values are stored slot-major for codes ABS_MT_TOUCH_MAJOR..ABS_MT_TOOL_Y.
+// The dirty bitmap has one bit per key code, then per abs code, then per slot.
+static const unsigned int MT_CODE_FIRST = ABS_MT_TOUCH_MAJOR;
+static const unsigned int MT_CODE_COUNT = ABS_MT_TOOL_Y - ABS_MT_TOUCH_MAJOR + 1;
+static const unsigned int MAX_STATE_SLOTS = 64;
+static const unsigned int DIRTY_KEY_OFFSET = 0;
+static const unsigned int DIRTY_ABS_OFFSET = KEY_CNT;
+static const unsigned int DIRTY_SLOT_OFFSET = KEY_CNT + ABS_CNT;
+static const unsigned int DIRTY_BITS = KEY_CNT + ABS_CNT + MAX_STATE_SLOTS;
+
+// EventSource is the native read path of a device. It wraps the device's
+// libevdev handle (not owned) with the per-device state needed to read it:
+//  - SYN_DROPPED handling: after a kernel buffer overrun the sync diff is
+//    drained with LIBEVDEV_READ_FLAG_SYNC and returned, not discarded
+//  - frame assembly: events are buffered up to each SYN_REPORT
+//  - touch tracking: MT slot state is turned into a touch frame per SYN_REPORT
+//  - hotkey matching: key presses are matched against registered hotkeys
+//  - state tracking: a dirty bitmap of the keys, axes and MT slots changed
+//    since the last state snapshot
+//  - event filtering: a type/code subscription mask; events outside it are
+//    discarded by ReadEvents()/ReadFrames() after libevdev has seen them
+//  - capture: every event read, filtered or not, is also recorded to an
+//    attached CaptureWriter, one batch per EV_SYN
+//  - forwarding: the events are remapped and written to a uinput by an
+//    attached EventRemap, which consumes all but its notify events, see
+//    event-remap.h; forwarding takes precedence over axis processing
+//  - axis processing: the events of the axes of an attached AxisPipeline
+//    are consumed by it, see axis-pipeline.h
+//  - coalescing: the frames of the relative and absolute axes left are
+//    merged by an attached EventCoalescer, see event-coalescer.h; Next()
+//    returns the events it passes on in place of those read
+//  - stats: counters of the events read, dropped and discarded, and of
+//    the latency of their delivery to JS, see event-stats.h
+class EventSource {
+ public:
+  explicit EventSource(struct libevdev* evdev);
+  ~EventSource();
+
+  struct libevdev* evdev() const { return evdev_; }
+
+  // Switch the device's kernel timestamps to CLOCK_MONOTONIC, the clock
+  // delivery latency is measured with. Returns 0 or -errno.
+  int UseMonotonicClock();
+
+  EventStats& stats() { return stats_; }
+
+  // Count the events read by Next() since the last call as one drain.
+  // ReadEvents(), ReadFrames(), ReadTouchFrames(), ReadHotkeys() and
+  // Drain() end theirs.
+  void EndBatch();
+
+  // Record the delivery latency of data, as read with mode: packed event
+  // records, frames, touch frames or hotkey matches.
+  void Delivered(const int32_t* data, size_t length, int mode);
+
+  // > 0 if an event can be read without blocking, 0 if none, -errno on error
+  int Pending();
+
+  // Read the next event, resynchronising after SYN_DROPPED.
+  // Returns LIBEVDEV_READ_STATUS_SUCCESS, LIBEVDEV_READ_STATUS_SYNC for
+  // SYN_DROPPED and the sync diff events that follow it, -EAGAIN if no
+  // event is available or -errno on error.
+  int Next(struct input_event* evdevEvent);
+
+  // Append all pending events to records as packed event records,
+  // at most max. Returns 0 or -errno on a read error.
+  int ReadEvents(std::vector<int32_t>& records, size_t max = SIZE_MAX);
+
+  // Read all pending events and assemble them into completed frames.
+  // Returns 0 or -errno on a read error.
+  int ReadFrames();
+
+  // Move whole completed frames into dst, at most capacity int32 slots.
+  // Returns the number of slots written.
+  size_t TakeFrames(int32_t* dst, size_t capacity);
+
+  // Move all completed frames to the end of frames.
+  void TakeFrames(std::vector<int32_t>& frames);
+
+  // Size in slots of the oldest completed frame, 0 if there is none.
+  size_t NextFrameSize() const;
+
+  // Read all pending events and track their MT contacts into touch frames,
+  // taken with touches().TakeFrames(). Returns 0 or -errno on a read error.
+  int ReadTouchFrames();
+
+  TouchTracker& touches() { return touches_; }
+
+  // Read all pending events and match their key presses against the
+  // hotkeys, taken with hotkeys().TakeMatches(). Returns 0 or -errno on a
+  // read error.
+  int ReadHotkeys();
+
+  HotkeyMatcher& hotkeys() { return hotkeys_; }
+
+  // Read and discard all pending events, only updating libevdev's state.
+  void Drain();
+
+  // Copy the dirty bitmap (DIRTY_BITS bits) into dst and clear it.
+  // May be called concurrently with a reader thread calling Next().
+  void TakeDirty(uint8_t* dst, size_t length);
+
+  // Enable filtering with an empty mask, or disable filtering (accept all).
+  // The filter may be changed while a reader thread reads the device.
+  void SetFilter(bool enabled);
+  bool SetFilterType(unsigned int type, bool accepted);
+  bool SetFilterCode(unsigned int type, unsigned int code, bool accepted);
+
+  // Record the events read to capture as device index, nullptr to stop.
+  // May be called while a reader thread reads the device; once it returns
+  // the previous writer receives no more events.
+  void SetCapture(CaptureWriter* capture, uint32_t device);
+
+  // Stop recording if the events are recorded to capture.
+  void RemoveCapture(CaptureWriter* capture);
+
+  // Process axes with pipeline (owned), nullptr to stop. May be called
+  // while a reader thread reads the device. JS thread only.
+  void SetAxes(AxisPipeline* pipeline);
+
+  // Forward the events with remap (owned), nullptr to stop. May be called
+  // while a reader thread reads the device. JS thread only.
+  void SetRemap(EventRemap* remap);
+
+  // Stop forwarding if the events are forwarded to uinputid, e.g., before
+  // the uinput is destroyed.
+  void RemoveRemap(int uinputid);
+
+  // Coalesce the axis frames with coalescer (owned), nullptr to stop. May be
+  // called while a reader thread reads the device. JS thread only.
+  void SetCoalescer(EventCoalescer* coalescer);
+
+  // CLOCK_MONOTONIC time at which the coalesced frames held are due,
+  // INT64_MAX if none, 0 if the device's clock is not monotonic.
+  int64_t CoalesceDeadlineUs();
+
+  // Queue the coalesced frames held for Next() if they are due at nowUs.
+  // Returns true if a frame was queued. Called by the thread reading the
+  // device.
+  bool FlushCoalesced(int64_t nowUs);
+
+  // True if the event last read by Next() is to be delivered: it was not
+  // consumed natively and passes the filter. Counts discards.
+  bool Deliverable(const struct input_event& evdevEvent);
+
+  // True if the event passes the filter.
+  bool Accept(const struct input_event& evdevEvent) const {
+    if (!__atomic_load_n(&filtering_, __ATOMIC_RELAXED)) return true;
+    if (evdevEvent.type >= EV_CNT) return false;
+    if (testBit(filterTypes_, evdevEvent.type)) return true;
+
+    return evdevEvent.code < KEY_CNT && testBit(filterCodes_[evdevEvent.type], evdevEvent.code);
+  }
+
+ private:
+  static bool testBit(const uint8_t* bitmap, unsigned int bit) {
+    return (__atomic_load_n(&bitmap[bit / 8], __ATOMIC_RELAXED) & (1 << (bit % 8))) != 0;
+  }
+
+  void AddToFrame(const struct input_event& evdevEvent);
+  void MarkDirty(const struct input_event& evdevEvent);
+  void Capture(const struct input_event& evdevEvent);
+  bool ProcessAxes(const struct input_event& evdevEvent);
+  bool Forward(const struct input_event& evdevEvent);
+  bool Coalesce(struct input_event* evdevEvent);
+  void ResetCoalescer();
+
+  struct libevdev* evdev_;
+  bool syncing_;
+
+  std::vector<int32_t> frame_;      // frame in progress, header included
+  std::vector<int32_t> completed_;  // completed frames, oldest first
+  TouchTracker touches_;
+  HotkeyMatcher hotkeys_;
+  uint8_t dirty_[(DIRTY_BITS + 7) / 8];
+
+  bool filtering_;
+  uint8_t filterTypes_[EV_CNT / 8];           // types accepted with all codes
+  uint8_t filterCodes_[EV_CNT][KEY_CNT / 8];  // codes accepted per type
+
+  bool capturing_;
+  std::mutex captureMutex_;
+  CaptureWriter* capture_;                    // guarded by captureMutex_
+  uint32_t captureDevice_;
+  std::vector<struct input_event> captured_;  // events since the last EV_SYN
+
+  bool processingAxes_;
+  std::mutex axesMutex_;
+  AxisPipeline* axes_;                        // guarded by axesMutex_
+  bool consumed_;                             // the last event read was consumed natively
+
+  bool remapping_;
+  std::mutex remapMutex_;
+  EventRemap* remap_;                         // guarded by remapMutex_
+
+  bool coalescing_;
+  std::mutex coalescerMutex_;
+  EventCoalescer* coalescer_;                 // guarded by coalescerMutex_
+  std::deque<struct input_event> coalesced_;  // events passed on, not yet returned
+
+  EventStats stats_;
+  uint64_t batch_;                            // events read since the last EndBatch()
+};
+
+#endif  // EVENT_SOURCE_H_
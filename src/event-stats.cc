@@ -0,0 +1,64 @@
+#include <cstring>
+
+#include "event-stats.h"
+
+extern "C" {
+#include <time.h>
+}
+
+EventStats::EventStats()
+  : monotonic_(false), latencyCount_(0), latencySumUs_(0), latencyMaxUs_(0) {
+  memset(counters_, 0, sizeof(counters_));
+  memset(batches_, 0, sizeof(batches_));
+  memset(latencies_, 0, sizeof(latencies_));
+}
+
+size_t EventStats::Bucket(uint64_t value) {
+  if (value < 2) return 0;
+
+  const size_t bucket = 63 - __builtin_clzll(value);
+  return bucket < STATS_BUCKETS ? bucket : STATS_BUCKETS - 1;
+}
+
+void EventStats::AddBatch(uint64_t count) {
+  Add(READS);
+  __atomic_add_fetch(&batches_[Bucket(count)], 1, __ATOMIC_RELAXED);
+}
+
+int64_t EventStats::NowUs() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+void EventStats::AddLatency(int64_t nowUs, int32_t tvSec, int32_t tvUsec) {
+  if (!monotonic()) return;
+
+  // an event stamped after nowUs, e.g., by another clock, counts as 0
+  const int64_t latency = nowUs - ((int64_t)tvSec * 1000000 + tvUsec);
+  const uint64_t latencyUs = latency > 0 ? (uint64_t)latency : 0;
+
+  __atomic_add_fetch(&latencyCount_, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&latencySumUs_, latencyUs, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&latencies_[Bucket(latencyUs)], 1, __ATOMIC_RELAXED);
+
+  uint64_t max = __atomic_load_n(&latencyMaxUs_, __ATOMIC_RELAXED);
+  while (latencyUs > max &&
+         !__atomic_compare_exchange_n(&latencyMaxUs_, &max, latencyUs, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+void EventStats::Snapshot(double* dst) const {
+  for (size_t i = 0; i <= READS; i++) {
+    dst[i] = (double)__atomic_load_n(&counters_[i], __ATOMIC_RELAXED);
+  }
+  dst[7] = (double)__atomic_load_n(&latencyCount_, __ATOMIC_RELAXED);
+  dst[8] = (double)__atomic_load_n(&latencySumUs_, __ATOMIC_RELAXED);
+  dst[9] = (double)__atomic_load_n(&latencyMaxUs_, __ATOMIC_RELAXED);
+
+  for (size_t i = 0; i < STATS_BUCKETS; i++) {
+    dst[STATS_COUNTERS + i] = (double)__atomic_load_n(&batches_[i], __ATOMIC_RELAXED);
+    dst[STATS_COUNTERS + STATS_BUCKETS + i] = (double)__atomic_load_n(&latencies_[i], __ATOMIC_RELAXED);
+  }
+}
@@ -0,0 +1,80 @@
+#ifndef EVENT_STATS_H_
+#define EVENT_STATS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Stats snapshot layout shared with lib/device-stats.ts, as float64 slots:
+//    [0] events      - events read from libevdev, sync diffs included
+//    [1] frames      - SYN_REPORTs read
+//    [2] dropped     - SYN_DROPPED occurrences (kernel buffer overruns)
+//    [3] syncEvents  - events of the sync diffs after SYN_DROPPED
+//    [4] discarded   - events read but not delivered, rejected by the filter
+//    [5] consumed    - events consumed natively: forwarded, merged by the coalescer
+//                      or by the axis pipeline
+//    [6] reads       - drains of the device, one per batch of events read
+//    [7] latencyCount, [8] latencySumUs, [9] latencyMaxUs
+//    [10..] STATS_BUCKETS batch size buckets, then STATS_BUCKETS latency buckets
+// Bucket i counts values in [2^i, 2^(i+1)), bucket 0 also counts 0 and
+// the last bucket everything above.
+static const size_t STATS_COUNTERS = 10;
+static const size_t STATS_BUCKETS = 24;
+static const size_t STATS_SIZE = STATS_COUNTERS + 2 * STATS_BUCKETS;
+
+// EventStats are the counters of a device's native read path. They are
+// updated with relaxed atomics, by the reader thread while it drains the
+// device and by the JS thread as events are delivered to it, so a snapshot
+// may be taken at any time without locking.
+//
+// Latency is the time from the kernel timestamp of an event to its delivery
+// to JS, only measured once the device's clock is CLOCK_MONOTONIC.
+class EventStats {
+ public:
+  EventStats();
+
+  enum Counter {
+    EVENTS = 0,
+    FRAMES,
+    DROPPED,
+    SYNC_EVENTS,
+    DISCARDED,
+    CONSUMED,
+    READS
+  };
+
+  void Add(Counter counter, uint64_t n = 1) {
+    __atomic_add_fetch(&counters_[counter], n, __ATOMIC_RELAXED);
+  }
+
+  // Count a drain that read count events.
+  void AddBatch(uint64_t count);
+
+  // Latency is measured against CLOCK_MONOTONIC once monotonic is set.
+  void SetMonotonic(bool monotonic) {
+    __atomic_store_n(&monotonic_, monotonic, __ATOMIC_RELAXED);
+  }
+
+  bool monotonic() const { return __atomic_load_n(&monotonic_, __ATOMIC_RELAXED); }
+
+  // Current CLOCK_MONOTONIC time to pass to AddLatency().
+  static int64_t NowUs();
+
+  // Record the latency of an event delivered at nowUs.
+  void AddLatency(int64_t nowUs, int32_t tvSec, int32_t tvUsec);
+
+  // Copy the counters into dst laid out as above, STATS_SIZE slots.
+  void Snapshot(double* dst) const;
+
+ private:
+  static size_t Bucket(uint64_t value);
+
+  bool monotonic_;
+  uint64_t counters_[READS + 1];
+  uint64_t latencyCount_;
+  uint64_t latencySumUs_;
+  uint64_t latencyMaxUs_;
+  uint64_t batches_[STATS_BUCKETS];
+  uint64_t latencies_[STATS_BUCKETS];
+};
+
+#endif  // EVENT_STATS_H_
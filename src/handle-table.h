@@ -0,0 +1,56 @@
+#ifndef HANDLE_TABLE_H_
+#define HANDLE_TABLE_H_
+
+#include <cstddef>
+#include <vector>
+
+// HandleTable resolves the ids JS allocates for native objects (device,
+// uinput, reader, ... ids) to the objects. JS ids are small integers, so
+// the table is a vector indexed by id: a lookup is a bounds check and a
+// load, and an unknown or released id resolves to nullptr instead of
+// throwing. The table does not own the objects.
+//
+// The vector is as long as the highest id in use. Readers, players and
+// capture files reuse the lowest free id (lib/handle-ids.ts), so their
+// tables are bounded by how many are open at once. Device and uinput ids
+// only increase, as tagged records may still name a closed device: their
+// table holds a pointer per device opened up to the newest still open,
+// a few bytes per hotplug.
+// JS thread only.
+template <typename T>
+class HandleTable {
+ public:
+  T* Get(int id) const {
+    return id >= 0 && static_cast<size_t>(id) < slots_.size() ? slots_[id] : nullptr;
+  }
+
+  // Store object at id. Returns false if id is invalid or in use.
+  bool Put(int id, T* object) {
+    if (id < 0 || Get(id) != nullptr) return false;
+    if (static_cast<size_t>(id) >= slots_.size()) slots_.resize(id + 1, nullptr);
+    slots_[id] = object;
+    return true;
+  }
+
+  // Remove and return the object at id, nullptr if there is none.
+  T* Take(int id) {
+    T* object = Get(id);
+    if (object == nullptr) return nullptr;
+
+    slots_[id] = nullptr;
+    while (!slots_.empty() && slots_.back() == nullptr) slots_.pop_back();
+    return object;
+  }
+
+  template <typename Fn>
+  void ForEach(Fn fn) const {
+    for (size_t id = 0; id < slots_.size(); id++) {
+      if (slots_[id] != nullptr) fn(static_cast<int>(id), slots_[id]);
+    }
+  }
+
+ private:
+  std::vector<T*> slots_;
+};
+
+#endif  // HANDLE_TABLE_H_
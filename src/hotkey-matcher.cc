@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cstring>
+
+#include "hotkey-matcher.h"
+#include "evdevjs.h"
+#include "event-source.h"
+
+static void setKey(uint64_t* keys, unsigned int code, bool pressed) {
+  if (pressed) {
+    keys[code / 64] |= (uint64_t)1 << (code % 64);
+  } else {
+    keys[code / 64] &= ~((uint64_t)1 << (code % 64));
+  }
+}
+
+static int64_t eventTimeUs(const struct input_event& evdevEvent) {
+  return (int64_t)evdevEvent.time.tv_sec * 1000000 + evdevEvent.time.tv_usec;
+}
+
+HotkeyMatcher::HotkeyMatcher()
+  : chordsByKey_(KEY_CNT), trie_(1, Node{-1, {}}), stepTimeoutUs_(0),
+    seed_(false), lastStepUs_(0), resync_(false), frame_(FRAME_HEADER_SIZE, 0) {
+  memset(pressed_, 0, sizeof(pressed_));
+}
+
+bool HotkeyMatcher::Set(const std::vector<HotkeyPattern>& hotkeys, int64_t stepTimeoutUs) {
+  std::vector<Chord> chords;
+  std::vector<std::vector<int>> chordsByKey(KEY_CNT);
+  std::vector<Node> trie(1, Node{-1, {}});
+
+  for (const HotkeyPattern& hotkey : hotkeys) {
+    if (hotkey.steps.empty()) return false;
+
+    size_t node = 0;
+    for (const std::vector<unsigned int>& step : hotkey.steps) {
+      if (step.empty()) return false;
+
+      Chord chord = {};
+      for (unsigned int code : step) {
+        if (code >= KEY_CNT) return false;
+        setKey(chord.keys, code, true);
+      }
+
+      // intern the chord, steps with the same keys share it
+      int chordIndex = -1;
+      for (size_t i = 0; i < chords.size() && chordIndex < 0; i++) {
+        if (memcmp(chords[i].keys, chord.keys, sizeof(chord.keys)) == 0) chordIndex = (int)i;
+      }
+      if (chordIndex < 0) {
+        chordIndex = (int)chords.size();
+        chords.push_back(chord);
+        for (unsigned int code = 0; code < KEY_CNT; code++) {
+          if (chord.keys[code / 64] & ((uint64_t)1 << (code % 64))) {
+            chordsByKey[code].push_back(chordIndex);
+          }
+        }
+      }
+
+      auto it = std::find_if(trie[node].next.begin(), trie[node].next.end(),
+        [chordIndex](const std::pair<int, size_t>& edge) { return edge.first == chordIndex; });
+      if (it != trie[node].next.end()) {
+        node = it->second;
+      } else {
+        trie.push_back(Node{-1, {}});
+        trie[node].next.emplace_back(chordIndex, trie.size() - 1);
+        node = trie.size() - 1;
+      }
+    }
+
+    if (trie[node].hotkey >= 0) return false;
+    trie[node].hotkey = hotkey.id;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  chords_.swap(chords);
+  chordsByKey_.swap(chordsByKey);
+  trie_.swap(trie);
+  stepTimeoutUs_ = stepTimeoutUs;
+  states_.clear();
+  fired_.clear();
+  // libevdev's state belongs to the reader thread
+  seed_ = true;
+  return true;
+}
+
+int HotkeyMatcher::MatchChord(unsigned int code) const {
+  // at most one chord has exactly the pressed keys
+  for (int chord : chordsByKey_[code]) {
+    if (memcmp(chords_[chord].keys, pressed_, sizeof(pressed_)) == 0) return chord;
+  }
+  return -1;
+}
+
+void HotkeyMatcher::Press(unsigned int code, int64_t timeUs) {
+  if (chordsByKey_[code].empty()) {
+    states_.clear();
+    return;
+  }
+
+  const int chord = MatchChord(code);
+  if (chord < 0) return;  // e.g., a modifier on the way to a chord
+
+  if (timeUs - lastStepUs_ > stepTimeoutUs_) states_.clear();
+  lastStepUs_ = timeUs;
+
+  // advance the sequences in progress, and start new ones from the root
+  std::vector<size_t> states;
+  bool fired = false;
+  states_.push_back(0);
+  for (size_t state : states_) {
+    for (const std::pair<int, size_t>& edge : trie_[state].next) {
+      if (edge.first != chord) continue;
+
+      const Node& node = trie_[edge.second];
+      if (node.hotkey >= 0) {
+        fired_.push_back(node.hotkey);
+        fired = true;
+      }
+      if (!node.next.empty()) states.push_back(edge.second);
+    }
+  }
+
+  // a completed hotkey consumes its presses, longer sequences start over
+  if (fired) states.clear();
+  states_.swap(states);
+}
+
+void HotkeyMatcher::Add(const struct libevdev* evdev, const struct input_event& evdevEvent) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (seed_) {
+    // evdev already applied evdevEvent, applying it again below is a no-op
+    memset(pressed_, 0, sizeof(pressed_));
+    for (unsigned int code = 0; code < KEY_CNT; code++) {
+      if (libevdev_get_event_value(evdev, EV_KEY, code)) setKey(pressed_, code, true);
+    }
+    seed_ = false;
+  }
+
+  if (evdevEvent.type == EV_SYN && evdevEvent.code == SYN_DROPPED) {
+    // the sync diff that follows updates the pressed keys without matching
+    resync_ = true;
+    states_.clear();
+    fired_.clear();
+    frame_.resize(FRAME_HEADER_SIZE);
+    frame_[0] = FRAME_FLAG_RESYNC;
+    frame_[1] = 0;
+    return;
+  }
+
+  const size_t offset = frame_.size();
+  frame_.resize(offset + EVENT_RECORD_SIZE);
+  writeEventRecord(frame_.data() + offset, evdevEvent);
+  frame_[1]++;
+
+  if (evdevEvent.type == EV_KEY && evdevEvent.code < KEY_CNT) {
+    // repeats (2) neither press nor release
+    if (evdevEvent.value == 0) {
+      setKey(pressed_, evdevEvent.code, false);
+    } else if (evdevEvent.value == 1) {
+      setKey(pressed_, evdevEvent.code, true);
+      if (!resync_) Press(evdevEvent.code, eventTimeUs(evdevEvent));
+    }
+  } else if (evdevEvent.type == EV_SYN && evdevEvent.code == SYN_REPORT) {
+    Report();
+  }
+}
+
+void HotkeyMatcher::Report() {
+  for (int hotkey : fired_) {
+    matches_.push_back(hotkey);
+    matches_.insert(matches_.end(), frame_.begin(), frame_.end());
+  }
+
+  fired_.clear();
+  resync_ = false;
+  frame_.resize(FRAME_HEADER_SIZE);
+  frame_[0] = 0;
+  frame_[1] = 0;
+}
+
+size_t HotkeyMatcher::NextMatchSize() const {
+  if (matches_.empty()) return 0;
+
+  return HOTKEY_MATCH_HEADER_SIZE + matches_[2] * EVENT_RECORD_SIZE;
+}
+
+size_t HotkeyMatcher::TakeMatches(int32_t* dst, size_t capacity) {
+  size_t length = 0;
+
+  while (length < matches_.size()) {
+    const size_t matchSize = HOTKEY_MATCH_HEADER_SIZE + matches_[length + 2] * EVENT_RECORD_SIZE;
+    if (length + matchSize > capacity) break;
+    length += matchSize;
+  }
+
+  std::copy(matches_.begin(), matches_.begin() + length, dst);
+  matches_.erase(matches_.begin(), matches_.begin() + length);
+  return length;
+}
+
+void HotkeyMatcher::TakeMatches(std::vector<int32_t>& matches) {
+  matches.insert(matches.end(), matches_.begin(), matches_.end());
+  matches_.clear();
+}
@@ -0,0 +1,98 @@
+#ifndef HOTKEY_MATCHER_H_
+#define HOTKEY_MATCHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+#include <linux/input.h>
+#include <libevdev/libevdev.h>
+}
+
+// Packed hotkey match layout shared with lib/hotkeys.ts, as int32 slots:
+//    [hotkeyId, flags, count, count * EVENT_RECORD_SIZE event records]
+// i.e., the id of the hotkey followed by the packed frame (see
+// FRAME_HEADER_SIZE) whose key press completed it.
+static const size_t HOTKEY_MATCH_HEADER_SIZE = 3;
+
+// A hotkey is a sequence of steps, each a chord: a set of keys completed
+// by a key press that leaves exactly these keys pressed. A single step
+// hotkey is a plain chord, e.g., KEY_LEFTCTRL+KEY_C.
+struct HotkeyPattern {
+  int id;
+  std::vector<std::vector<unsigned int>> steps;
+};
+
+// HotkeyMatcher matches a keyboard's key presses against registered
+// hotkeys in the native read path. The pressed keys are kept as a bitmap;
+// the distinct chords of all hotkeys are indexed by key, so a press is
+// tested only against the chords containing it, and the hotkeys are
+// compiled into a trie over their chords, advanced by each matched chord.
+// Consecutive steps of a sequence must be pressed within the step timeout
+// of each other, by kernel time. A press of a key that is part of no
+// chord breaks a sequence in progress; a completed hotkey ends all of
+// them. Every hotkey completed by a press matches, e.g., both a chord and
+// a sequence ending with it.
+//
+// Every event read is observed, but only a completed hotkey produces a
+// match, so a keyboard typing no hotkey produces nothing to deliver.
+// Hotkeys may be changed while a reader thread reads the device.
+class HotkeyMatcher {
+ public:
+  HotkeyMatcher();
+
+  // Replace the hotkeys. Returns false, leaving the hotkeys unchanged, if
+  // a key is out of range, a step is empty or two hotkeys have the same
+  // steps. The pressed keys are taken from the device by the next Add().
+  bool Set(const std::vector<HotkeyPattern>& hotkeys, int64_t stepTimeoutUs);
+
+  // Observe an event evdev read from the device, sync diffs included.
+  // Called by the thread reading evdev.
+  void Add(const struct libevdev* evdev, const struct input_event& evdevEvent);
+
+  // Size in slots of the oldest match, 0 if there is none.
+  size_t NextMatchSize() const;
+
+  // Move whole matches into dst, at most capacity int32 slots.
+  // Returns the number of slots written.
+  size_t TakeMatches(int32_t* dst, size_t capacity);
+
+  // Move all matches to the end of matches.
+  void TakeMatches(std::vector<int32_t>& matches);
+
+ private:
+  static const size_t WORDS = (KEY_CNT + 63) / 64;
+
+  struct Chord {
+    uint64_t keys[WORDS];
+  };
+
+  struct Node {
+    int hotkey;                                   // hotkey completed here, -1 if none
+    std::vector<std::pair<int, size_t>> next;     // child node by chord
+  };
+
+  int MatchChord(unsigned int code) const;
+  void Press(unsigned int code, int64_t timeUs);
+  void Report();
+
+  std::mutex mutex_;
+  std::vector<Chord> chords_;
+  std::vector<std::vector<int>> chordsByKey_;   // chords containing each key
+  std::vector<Node> trie_;                      // trie_[0] is the root
+  int64_t stepTimeoutUs_;
+
+  uint64_t pressed_[WORDS];
+  bool seed_;                       // pressed_ to be taken from the device
+  std::vector<size_t> states_;      // trie nodes of the sequences in progress
+  int64_t lastStepUs_;
+
+  bool resync_;
+  std::vector<int32_t> frame_;      // frame in progress, header included
+  std::vector<int> fired_;          // hotkeys completed in the frame in progress
+  std::vector<int32_t> matches_;    // completed matches, oldest first
+};
+
+#endif  // HOTKEY_MATCHER_H_
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "probe-worker.h"
+#include "evdevjs.h"
+
+using namespace Napi;
+
+// a slow device stalls its probe thread only
+static const size_t MAX_PROBE_THREADS = 16;
+
+ProbeWorker::ProbeWorker(Napi::Env env, const std::vector<std::string>& paths)
+  : AsyncWorker(env, "ProbeWorker"), paths_(paths), results_(paths.size()),
+    deferred_(Napi::Promise::Deferred::New(env)) {
+}
+
+ProbeWorker::~ProbeWorker() {
+  // results not handed to JS
+  for (Result& result : results_) {
+    if (result.owned) releaseProbedDevice(&result.probed);
+  }
+}
+
+void ProbeWorker::Execute() {
+  std::atomic<size_t> next(0);
+  auto probe = [&]() {
+    size_t i;
+    while ((i = next++) < paths_.size()) {
+      results_[i].error = probeDevice(paths_[i], &results_[i].probed);
+      results_[i].owned = results_[i].error == 0;
+    }
+  };
+
+  const size_t count = std::min(paths_.size(), MAX_PROBE_THREADS);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < count; i++) {
+    threads.emplace_back(probe);
+  }
+  probe();
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+void ProbeWorker::OnOK() {
+  Napi::Env env = Env();
+  Array results = Array::New(env);
+
+  for (Result& result : results_) {
+    Object probe = Object::New(env);
+    probe.Set("path", String::New(env, result.probed.path));
+
+    if (result.error < 0) {
+      probe.Set("error", Number::New(env, result.error));
+    } else {
+      probe.Set("info", createDeviceInfo(env, result.probed.evdev));
+      probe.Set("capabilityBits", createCapabilityBits(env, result.probed.evdev));
+      probe.Set("properties", createProperties(env, result.probed.evdev));
+      probe.Set("token", Number::New(env, storeProbedDevice(result.probed)));
+      result.owned = false;
+    }
+
+    results.Set(results.Length(), probe);
+  }
+
+  deferred_.Resolve(results);
+}
@@ -0,0 +1,37 @@
+#ifndef PROBE_WORKER_H_
+#define PROBE_WORKER_H_
+
+#include <string>
+#include <vector>
+
+#include "napi.h"
+#include "device-probe.h"
+
+// ProbeWorker opens and probes device nodes with libevdev in parallel,
+// off the JS thread, and resolves its promise with one result per path:
+//    {path, token, info, capabilityBits, properties}  probed, adopt with token
+//    {path, error}                                    -errno, e.g., not evdev
+class ProbeWorker : public Napi::AsyncWorker {
+ public:
+  ProbeWorker(Napi::Env env, const std::vector<std::string>& paths);
+  ~ProbeWorker();
+
+  Napi::Promise Promise() const { return deferred_.Promise(); }
+
+ protected:
+  void Execute() override;
+  void OnOK() override;
+
+ private:
+  struct Result {
+    ProbedDevice probed;
+    int error;
+    bool owned;   // probed fd and libevdev not yet handed to the probe store
+  };
+
+  std::vector<std::string> paths_;
+  std::vector<Result> results_;
+  Napi::Promise::Deferred deferred_;
+};
+
+#endif  // PROBE_WORKER_H_
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cstring>
+
+#include "touch-tracker.h"
+
+static const unsigned int CONTACT_CODES[] = {
+  ABS_MT_POSITION_X, ABS_MT_POSITION_Y, ABS_MT_PRESSURE,
+  ABS_MT_TOUCH_MAJOR, ABS_MT_TOUCH_MINOR
+};
+static const size_t CONTACT_VALUE_COUNT = sizeof(CONTACT_CODES) / sizeof(CONTACT_CODES[0]);
+static_assert(CONTACT_VALUE_COUNT == TOUCH_CONTACT_SIZE - 3, "contact values follow slot, id and flags");
+
+TouchTracker::TouchTracker() : resync_(false), frame_(0) {
+}
+
+void TouchTracker::Add(const struct libevdev* evdev, const struct input_event& evdevEvent) {
+  if (evdevEvent.type != EV_SYN) return;
+
+  if (evdevEvent.code == SYN_DROPPED) {
+    // the sync diff that follows ends with a SYN_REPORT of the current state
+    resync_ = true;
+  } else if (evdevEvent.code == SYN_REPORT) {
+    Report(evdev, evdevEvent.time);
+  }
+}
+
+void TouchTracker::Report(const struct libevdev* evdev, const struct timeval& time) {
+  const int numSlots = libevdev_get_num_slots(evdev);
+  if (numSlots <= 0) return;
+  if (contacts_.size() != (size_t)numSlots) {
+    contacts_.resize(numSlots, Contact{-1, {0, 0, 0, 0, 0}});
+  }
+
+  frame_ = completed_.size();
+  completed_.resize(frame_ + TOUCH_FRAME_HEADER_SIZE);
+  completed_[frame_] = resync_ ? TOUCH_FRAME_FLAG_RESYNC : 0;
+  completed_[frame_ + 1] = 0;
+  completed_[frame_ + 2] = (int32_t)time.tv_sec;
+  completed_[frame_ + 3] = (int32_t)time.tv_usec;
+
+  for (int slot = 0; slot < numSlots; slot++) {
+    Contact& previous = contacts_[slot];
+    const int32_t trackingId = libevdev_get_slot_value(evdev, slot, ABS_MT_TRACKING_ID);
+    const bool began = trackingId >= 0 && trackingId != previous.trackingId;
+
+    // lifted, or replaced by a new contact within one frame (e.g., after
+    // SYN_DROPPED): the previous contact ends with its last values
+    if (previous.trackingId >= 0 && trackingId != previous.trackingId) {
+      AddContact(slot, previous.trackingId, TOUCH_END, previous.values);
+    }
+
+    if (trackingId >= 0) {
+      int32_t values[CONTACT_VALUE_COUNT];
+      for (size_t i = 0; i < CONTACT_VALUE_COUNT; i++) {
+        values[i] = libevdev_get_slot_value(evdev, slot, CONTACT_CODES[i]);
+      }
+
+      int32_t flags = began ? TOUCH_BEGIN : 0;
+      if (began || memcmp(values, previous.values, sizeof(values)) != 0) flags |= TOUCH_MOVED;
+      AddContact(slot, trackingId, flags, values);
+      memcpy(previous.values, values, sizeof(values));
+    }
+
+    previous.trackingId = trackingId;
+  }
+
+  if (completed_[frame_ + 1] == 0) {
+    // no contacts, e.g., a frame of key events only
+    completed_.resize(frame_);
+  } else {
+    resync_ = false;
+  }
+}
+
+void TouchTracker::AddContact(int slot, int32_t trackingId, int32_t flags, const int32_t* values) {
+  const size_t offset = completed_.size();
+  completed_.resize(offset + TOUCH_CONTACT_SIZE);
+
+  int32_t* contact = completed_.data() + offset;
+  contact[0] = slot;
+  contact[1] = trackingId;
+  contact[2] = flags;
+  memcpy(contact + 3, values, CONTACT_VALUE_COUNT * sizeof(int32_t));
+  completed_[frame_ + 1]++;
+}
+
+size_t TouchTracker::NextFrameSize() const {
+  if (completed_.empty()) return 0;
+
+  return TOUCH_FRAME_HEADER_SIZE + completed_[1] * TOUCH_CONTACT_SIZE;
+}
+
+size_t TouchTracker::TakeFrames(int32_t* dst, size_t capacity) {
+  size_t length = 0;
+
+  while (length < completed_.size()) {
+    const size_t frameSize = TOUCH_FRAME_HEADER_SIZE + completed_[length + 1] * TOUCH_CONTACT_SIZE;
+    if (length + frameSize > capacity) break;
+    length += frameSize;
+  }
+
+  std::copy(completed_.begin(), completed_.begin() + length, dst);
+  completed_.erase(completed_.begin(), completed_.begin() + length);
+  return length;
+}
+
+void TouchTracker::TakeFrames(std::vector<int32_t>& frames) {
+  frames.insert(frames.end(), completed_.begin(), completed_.end());
+  completed_.clear();
+}
@@ -0,0 +1,64 @@
+#ifndef TOUCH_TRACKER_H_
+#define TOUCH_TRACKER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include <linux/input.h>
+#include <libevdev/libevdev.h>
+}
+
+// Packed touch frame layout shared with lib/touch-frame.ts, as int32 slots:
+//    [flags, count, tv_sec, tv_usec, count * TOUCH_CONTACT_SIZE contacts]
+// A contact is reported for every active slot and, once, for every slot
+// whose contact ended:
+//    [slot, trackingId, flags, x, y, pressure, touchMajor, touchMinor]
+static const size_t TOUCH_FRAME_HEADER_SIZE = 4;
+static const size_t TOUCH_CONTACT_SIZE = 8;
+static const int32_t TOUCH_FRAME_FLAG_RESYNC = 1;  // first frame after SYN_DROPPED
+
+// contact flags
+static const int32_t TOUCH_BEGIN = 1;   // new tracking id in the slot
+static const int32_t TOUCH_END = 2;     // contact lifted, values are the last known
+static const int32_t TOUCH_MOVED = 4;   // values changed since the previous frame
+
+// TouchTracker turns libevdev's protocol B slot state into one packed
+// touch frame per SYN_REPORT. libevdev has already applied the frame's
+// ABS_MT_* events to its slots when the SYN_REPORT is read, so the
+// tracker only compares each slot with the previous frame to derive the
+// begin/end/moved flags. Frames without contacts are not produced.
+class TouchTracker {
+ public:
+  TouchTracker();
+
+  // Observe an event read from evdev, after libevdev has processed it.
+  void Add(const struct libevdev* evdev, const struct input_event& evdevEvent);
+
+  // Size in slots of the oldest completed frame, 0 if there is none.
+  size_t NextFrameSize() const;
+
+  // Move whole completed frames into dst, at most capacity int32 slots.
+  // Returns the number of slots written.
+  size_t TakeFrames(int32_t* dst, size_t capacity);
+
+  // Move all completed frames to the end of frames.
+  void TakeFrames(std::vector<int32_t>& frames);
+
+ private:
+  struct Contact {
+    int32_t trackingId;     // -1 if the slot is free
+    int32_t values[TOUCH_CONTACT_SIZE - 3];   // x, y, pressure, touchMajor, touchMinor
+  };
+
+  void Report(const struct libevdev* evdev, const struct timeval& time);
+  void AddContact(int slot, int32_t trackingId, int32_t flags, const int32_t* values);
+
+  std::vector<Contact> contacts_;   // previous frame, by slot
+  bool resync_;
+  size_t frame_;                    // offset of the frame in progress in completed_
+  std::vector<int32_t> completed_;  // completed frames, oldest first
+};
+
+#endif  // TOUCH_TRACKER_H_
@@ -0,0 +1,172 @@
+#include "uinput-player.h"
+#include "evdevjs.h"
+
+extern "C" {
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+}
+
+using namespace Napi;
+
+static const int64_t NSEC_PER_SEC = 1000000000;
+
+static int64_t monotonicNow() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+static int64_t recordTimeUs(const int32_t* record) {
+  return (int64_t)record[0] * 1000000 + record[1];
+}
+
+static void CallJs(Env env, Function callback, PlaybackResult* result) {
+  if (env != nullptr && callback != nullptr) {
+    Object info = Object::New(env);
+    info.Set("completed", Boolean::New(env, result->completed));
+    info.Set("events", Number::New(env, result->events));
+    info.Set("maxErrorUs", Number::New(env, result->maxErrorNs / 1000.0));
+    info.Set("meanErrorUs", Number::New(env,
+      result->writes > 0 ? result->totalErrorNs / 1000.0 / result->writes : 0));
+    info.Set("errno", Number::New(env, result->error));
+    callback.Call({info});
+  }
+
+  delete result;
+}
+
+UInputPlayer::UInputPlayer(Env env, Function callback, int uinputid, int fd,
+                           const int32_t* records, size_t count)
+  : uinputid_(uinputid), fd_(fd),
+    records_(records, records + count * EVENT_RECORD_SIZE),
+    paused_(false), cancelled_(false), pausedAtNs_(0), offsetNs_(0) {
+  timerFd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+  tsfn_ = ThreadSafeFunction::New(env, callback, "UInputPlayer", 0, 1);
+  thread_ = std::thread(&UInputPlayer::Run, this);
+}
+
+UInputPlayer::~UInputPlayer() {
+  Cancel();
+  thread_.join();
+
+  close(timerFd_);
+  close(wakeFd_);
+  tsfn_.Release();
+}
+
+void UInputPlayer::Pause() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (paused_ || cancelled_) return;
+
+  paused_ = true;
+  pausedAtNs_ = monotonicNow();
+  Signal();
+}
+
+void UInputPlayer::Resume() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!paused_) return;
+
+  paused_ = false;
+  offsetNs_ += monotonicNow() - pausedAtNs_;
+  Signal();
+}
+
+void UInputPlayer::Cancel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cancelled_ = true;
+  Signal();
+}
+
+void UInputPlayer::Signal() {
+  uint64_t one = 1;
+  if (write(wakeFd_, &one, sizeof(one)) < 0) {
+    // eventfd write only fails on counter overflow, the thread is awake anyway
+  }
+}
+
+// Sleep until scheduleNs, shifted by the time spent paused, has passed.
+// Returns false if the playback was cancelled while waiting.
+bool UInputPlayer::Wait(int64_t scheduleNs, int64_t* deadlineNs) {
+  while (true) {
+    bool paused;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (cancelled_) return false;
+      paused = paused_;
+      *deadlineNs = scheduleNs + offsetNs_;
+    }
+
+    // a zero itimerspec disarms the timer while paused
+    struct itimerspec spec = {};
+    if (!paused) {
+      if (*deadlineNs <= monotonicNow()) return true;
+      spec.it_value.tv_sec = *deadlineNs / NSEC_PER_SEC;
+      spec.it_value.tv_nsec = *deadlineNs % NSEC_PER_SEC;
+    }
+    timerfd_settime(timerFd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+
+    struct pollfd fds[2] = {{timerFd_, POLLIN, 0}, {wakeFd_, POLLIN, 0}};
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+
+    // drain whichever fired, then recheck the state and deadline
+    uint64_t count;
+    if ((fds[0].revents & POLLIN) && read(timerFd_, &count, sizeof(count)) < 0) {
+      // EAGAIN, the timer was rearmed
+    }
+    if ((fds[1].revents & POLLIN) && read(wakeFd_, &count, sizeof(count)) < 0) {
+      // EAGAIN, already drained
+    }
+  }
+}
+
+void UInputPlayer::Run() {
+  PlaybackResult* result = new PlaybackResult{false, 0, 0, 0, 0, 0};
+  const size_t count = records_.size() / EVENT_RECORD_SIZE;
+  const int32_t* records = records_.data();
+  const int64_t firstUs = count > 0 ? recordTimeUs(records) : 0;
+  const int64_t startNs = monotonicNow();
+
+  size_t i = 0;
+  while (i < count) {
+    // batch the records sharing a timestamp into one write
+    const int64_t timeUs = recordTimeUs(records + i * EVENT_RECORD_SIZE);
+    events_.clear();
+    size_t end = i;
+    for (; end < count; end++) {
+      const int32_t* record = records + end * EVENT_RECORD_SIZE;
+      if (recordTimeUs(record) != timeUs) break;
+      events_.insert(events_.end(), record + 2, record + EVENT_RECORD_SIZE);
+    }
+
+    int64_t deadlineNs;
+    if (!Wait(startNs + (timeUs - firstUs) * 1000, &deadlineNs)) break;
+
+    ssize_t written = writeUInputEvents(fd_, events_.data(), end - i, false, scratch_);
+    if (written < 0) {
+      result->error = -written;
+      break;
+    }
+
+    const int64_t errorNs = monotonicNow() - deadlineNs;
+    result->events += written;
+    result->writes++;
+    result->totalErrorNs += errorNs;
+    if (errorNs > result->maxErrorNs) result->maxErrorNs = errorNs;
+    i = end;
+  }
+
+  result->completed = i == count && result->error == 0;
+  if (tsfn_.NonBlockingCall(result, CallJs) != napi_ok) {
+    delete result;
+  }
+}
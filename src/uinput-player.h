@@ -0,0 +1,72 @@
+#ifndef UINPUT_PLAYER_H_
+#define UINPUT_PLAYER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "napi.h"
+
+extern "C" {
+#include <linux/input.h>
+}
+
+// Outcome of a playback, reported to the JS callback as
+//    callback({completed, events, maxErrorUs, meanErrorUs, errno})
+// Timing error is the lateness of each write against its schedule.
+struct PlaybackResult {
+  bool completed;      // false if cancelled or a write failed
+  int events;          // number of events written
+  int64_t maxErrorNs;
+  int64_t totalErrorNs;
+  int writes;          // number of scheduled writes
+  int error;           // errno of a failed write, 0 otherwise
+};
+
+// UInputPlayer writes packed timestamped event records
+//    [tv_sec, tv_usec, type, code, value]
+// to a uinput fd on a dedicated thread, preserving the intervals between
+// the record timestamps. Records with the same timestamp are written with
+// a single write(). Each write is scheduled with an absolute CLOCK_MONOTONIC
+// timerfd, so timing does not depend on the node event loop.
+//
+// Playback starts on construction and may be paused, resumed and cancelled
+// from the JS thread. Time spent paused shifts the remaining schedule.
+// The result is delivered to the JS callback via a ThreadSafeFunction.
+class UInputPlayer {
+ public:
+  UInputPlayer(Napi::Env env, Napi::Function callback, int uinputid, int fd,
+               const int32_t* records, size_t count);
+  ~UInputPlayer();
+
+  int uinputid() const { return uinputid_; }
+
+  // Pause, Resume and Cancel must be called from the JS thread.
+  void Pause();
+  void Resume();
+  void Cancel();
+
+ private:
+  void Run();
+  bool Wait(int64_t scheduleNs, int64_t* deadlineNs);
+  void Signal();
+
+  int uinputid_;
+  int fd_;
+  int timerFd_;
+  int wakeFd_;
+  std::vector<int32_t> records_;
+  std::vector<int32_t> events_;               // write batch, player thread only
+  std::vector<struct input_event> scratch_;   // player thread only
+  std::thread thread_;
+  std::mutex mutex_;
+  bool paused_;
+  bool cancelled_;
+  int64_t pausedAtNs_;
+  int64_t offsetNs_;   // total time paused, guarded by mutex_
+  Napi::ThreadSafeFunction tsfn_;
+};
+
+#endif  // UINPUT_PLAYER_H_
@@ -0,0 +1,49 @@
+import * as assert from 'assert';
+import { AxisState } from '../lib/index';
+import { run, test } from './harness';
+
+const ABS_X = 0x00;
+const ABS_Y = 0x01;
+const ABS_RZ = 0x05;
+
+// header slots, as laid out by src/axis-pipeline.h
+const SEQUENCE = 0;
+const CHANGED = 1;
+const SEC = 2;
+const USEC = 3;
+const HEADER_SIZE = 8;
+
+test('AxisState reads the values published into its buffer', () => {
+  const state = new AxisState([ABS_X, ABS_Y]);
+  assert.strictEqual(state.sequence, 0);
+  assert.strictEqual(state.array.length, HEADER_SIZE + 2);
+
+  // publish a frame the way the native pipeline does, under its seqlock
+  const array = state.array;
+  const values = new Float32Array(array.buffer, HEADER_SIZE * 4, 2);
+  Atomics.add(array, SEQUENCE, 1);
+  values[1] = -0.5;
+  array[CHANGED] = 1 << 1;
+  array[SEC] = 12;
+  array[USEC] = 345;
+  Atomics.add(array, SEQUENCE, 1);
+
+  assert.strictEqual(state.sequence, 1);
+  assert.deepStrictEqual(Array.from(state.copyValues()), [0, -0.5]);
+  assert.strictEqual(state.value(ABS_X), 0);
+  assert.strictEqual(state.value(ABS_Y), -0.5);
+  assert.ok(Number.isNaN(state.value(ABS_RZ)));
+  assert.strictEqual(state.changed(ABS_X), false);
+  assert.strictEqual(state.changed(ABS_Y), true);
+  assert.strictEqual(state.changed(ABS_RZ), false);
+  assert.strictEqual(state.sec, 12);
+  assert.strictEqual(state.usec, 345);
+});
+
+test('AxisState takes 1 to 32 axes', () => {
+  assert.throws(() => new AxisState([]));
+  assert.throws(() => new AxisState(Array.from({length: 33}, (_, i) => i)));
+  assert.strictEqual(new AxisState(Array.from({length: 32}, (_, i) => i)).values.length, 32);
+});
+
+run();
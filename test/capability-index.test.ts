@@ -0,0 +1,90 @@
+import * as assert from 'assert';
+import { CapabilityBits, CapabilityIndex } from '../lib/index';
+import { run, test } from './harness';
+
+const EV_KEY = 0x01;
+const EV_ABS = 0x03;
+const KEY_A = 30;
+const BTN_LEFT = 0x110;
+const ABS_X = 0x00;
+
+// bits with the [type, code] capabilities, and absinfo [value, min, max, ...] per abs code
+function newBits(capabilities: [number, number][], absInfo: Map<number, number[]> = new Map()): CapabilityBits {
+  const types = new Uint8Array(4);
+  const codes: (Uint8Array | null)[] = new Array(32).fill(null);
+  const info = new Int32Array(0x40 * CapabilityBits.ABS_INFO_SIZE);
+  for (const [type, code] of capabilities) {
+    types[type >> 3] |= 1 << (type & 7);
+    codes[type] = codes[type] ?? new Uint8Array(0x300 / 8);
+    codes[type]![code >> 3] |= 1 << (code & 7);
+  }
+  for (const [code, values] of absInfo) {
+    info.set(values, code * CapabilityBits.ABS_INFO_SIZE);
+  }
+  return new CapabilityBits({types, codes, absInfo: info});
+}
+
+test('CapabilityBits tests and lists its bitmaps', () => {
+  const bits = newBits([[EV_KEY, BTN_LEFT], [EV_KEY, KEY_A], [EV_ABS, ABS_X]],
+    new Map([[ABS_X, [5, 0, 1023, 4, 8, 12]]]));
+
+  assert.strictEqual(bits.hasType(EV_KEY), true);
+  assert.strictEqual(bits.hasType(0x02), false);
+  assert.strictEqual(bits.hasCode(EV_KEY, KEY_A), true);
+  assert.strictEqual(bits.hasCode(EV_KEY, KEY_A + 1), false);
+  assert.strictEqual(bits.hasCode(0x02, 0), false);
+  assert.strictEqual(bits.hasCode(EV_KEY, 0x10000), false);
+
+  assert.deepStrictEqual(bits.getAbsInfo(ABS_X),
+    {value: 5, min: 0, max: 1023, fuzz: 4, flat: 8, resolution: 12});
+  assert.strictEqual(bits.getAbsInfo(0x01), undefined);
+
+  assert.deepStrictEqual(bits.toCapabilities(), [
+    {type: EV_KEY, events: [{code: KEY_A}, {code: BTN_LEFT}]},
+    {type: EV_ABS, events: [{code: ABS_X, absInfo: bits.getAbsInfo(ABS_X)}]},
+  ]);
+});
+
+test('CapabilityIndex finds items by type and code', () => {
+  const index = new CapabilityIndex<string>();
+  index.add('keyboard', newBits([[EV_KEY, KEY_A]]));
+  index.add('mouse', newBits([[EV_KEY, BTN_LEFT]]));
+  index.add('tablet', newBits([[EV_KEY, BTN_LEFT], [EV_ABS, ABS_X]]));
+
+  assert.strictEqual(index.size, 3);
+  assert.deepStrictEqual(index.find(EV_KEY), ['keyboard', 'mouse', 'tablet']);
+  assert.deepStrictEqual(index.find(EV_KEY, BTN_LEFT), ['mouse', 'tablet']);
+  assert.deepStrictEqual(index.find(EV_ABS, ABS_X), ['tablet']);
+  assert.deepStrictEqual(index.find(0x02), []);
+
+  // re-adding replaces the entry
+  index.add('mouse', newBits([[EV_ABS, ABS_X]]));
+  assert.deepStrictEqual(index.find(EV_KEY, BTN_LEFT), ['tablet']);
+  assert.deepStrictEqual(index.find(EV_ABS, ABS_X), ['mouse', 'tablet']);
+
+  // a removed item's slot is reused
+  index.remove('keyboard');
+  assert.strictEqual(index.has('keyboard'), false);
+  assert.deepStrictEqual(index.find(EV_KEY, KEY_A), []);
+  index.add('keypad', newBits([[EV_KEY, KEY_A]]));
+  assert.deepStrictEqual(index.find(EV_KEY), ['keypad', 'tablet']);
+
+  index.clear();
+  assert.strictEqual(index.size, 0);
+  assert.deepStrictEqual(index.find(EV_KEY), []);
+});
+
+test('CapabilityIndex grows past 32 items', () => {
+  const index = new CapabilityIndex<number>();
+  const expected: number[] = [];
+  for (let i = 0; i < 100; i++) {
+    index.add(i, newBits([[EV_KEY, i % 2 === 0 ? KEY_A : BTN_LEFT]]));
+    if (i % 2 === 0) expected.push(i);
+  }
+
+  assert.strictEqual(index.size, 100);
+  assert.deepStrictEqual(index.find(EV_KEY, KEY_A), expected);
+  assert.strictEqual(index.find(EV_KEY).length, 100);
+});
+
+run();
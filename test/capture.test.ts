@@ -0,0 +1,62 @@
+import * as assert from 'assert';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { CaptureReader, CaptureWriter, Evdev, Event, InputCodes } from '../lib/index';
+import { emit, openLoopback, run, scanFrames, test, waitFor } from './harness';
+
+const EV_MSC = InputCodes.getType('EV_MSC');
+
+test('a capture reads and replays the recorded events', async () => {
+  const file = path.join(fs.mkdtempSync(path.join(os.tmpdir(), 'evdevjs-')), 'test.cap');
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test capture');
+  try {
+    let seen = 0;
+    device.on('event', () => seen++);
+    const writer = new CaptureWriter(file);
+    assert.strictEqual(writer.add(device), 0);
+    device.enableEvents(true);
+
+    emit(uinput, scanFrames(3));
+    await waitFor(() => seen >= 6);
+    writer.close();
+
+    const reader = new CaptureReader(file);
+    try {
+      assert.strictEqual(reader.devices.length, 1);
+      assert.strictEqual(reader.devices[0].name, 'evdevjs test capture');
+      assert.strictEqual(reader.info.events, 6);
+      assert.ok(reader.info.endUs >= reader.info.startUs);
+
+      const records = new Int32Array(16 * Event.TAGGED_RECORD_SIZE);
+      assert.strictEqual(reader.read(records), 6);
+      const scans: number[] = [];
+      for (let i = 0; i < 6; i++) {
+        const event = Event.fromTaggedRecord(records, i);
+        assert.strictEqual(records[i * Event.TAGGED_RECORD_SIZE], 0);
+        if (event.type === EV_MSC) scans.push(event.value);
+      }
+      assert.deepStrictEqual(scans, [1, 2, 3]);
+      assert.strictEqual(reader.read(records), 0);
+
+      // replay the capture to the listeners of the recorded device
+      const replayed: number[] = [];
+      device.enableEvents(false);
+      device.removeAllListeners('event');
+      device.on('event', (event: Event) => {
+        if (event.type === EV_MSC) replayed.push(event.value);
+      });
+      assert.strictEqual(await reader.replay(new Map([[0, device]]), {speed: Infinity}), 6);
+      assert.deepStrictEqual(replayed, [1, 2, 3]);
+    } finally {
+      reader.close();
+    }
+  } finally {
+    uinput.close();
+    evdev.close();
+    fs.rmSync(path.dirname(file), {recursive: true, force: true});
+  }
+});
+
+run();
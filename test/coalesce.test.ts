@@ -0,0 +1,71 @@
+import * as assert from 'assert';
+import { Evdev, Event, InputCodes } from '../lib/index';
+import { emit, LoopbackCode, openLoopback, run, sleep, test, waitFor } from './harness';
+
+const EV_SYN = InputCodes.getType('EV_SYN');
+const EV_KEY = InputCodes.getType('EV_KEY');
+const EV_REL = InputCodes.getType('EV_REL');
+const SYN_REPORT = InputCodes.getCode('SYN_REPORT');
+const BTN_LEFT = InputCodes.getCode('BTN_LEFT');
+const REL_X = InputCodes.getCode('REL_X');
+
+const MOUSE: LoopbackCode[] = [['EV_KEY', 'BTN_LEFT'], ['EV_REL', 'REL_X'], ['EV_REL', 'REL_Y']];
+
+// frames moving REL_X by each of deltas
+function moves(deltas: number[]): number[] {
+  return deltas.flatMap(delta => [EV_REL, REL_X, delta, EV_SYN, SYN_REPORT, 0]);
+}
+
+test('coalesce() sums the motion of a burst', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test coalesce', MOUSE);
+  try {
+    const events: number[][] = [];
+    device.on('event', (event: Event) => {
+      if (event.type !== EV_SYN) events.push([event.type, event.code, event.value]);
+    });
+    device.coalesce({windowMs: 200});
+    device.enableEvents(true);
+    assert.strictEqual(device.isCoalescing(), true);
+
+    emit(uinput, moves([1, 2, 3, 4, 5]));
+    await waitFor(() => events.length >= 1);
+    assert.deepStrictEqual(events, [[EV_REL, REL_X, 15]]);
+
+    // the motion so far is published ahead of a button
+    events.length = 0;
+    emit(uinput, moves([1, 1]));
+    emit(uinput, [EV_REL, REL_X, 1, EV_KEY, BTN_LEFT, 1, EV_SYN, SYN_REPORT, 0]);
+    await waitFor(() => events.length >= 2);
+    assert.deepStrictEqual(events, [[EV_REL, REL_X, 3], [EV_KEY, BTN_LEFT, 1]]);
+
+    device.clearCoalescing();
+    assert.strictEqual(device.isCoalescing(), false);
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+test('coalesce() passes a frame on every maxFrames frames', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test coalesce max', MOUSE);
+  try {
+    const deltas: number[] = [];
+    device.on('event', (event: Event) => {
+      if (event.type === EV_REL) deltas.push(event.value);
+    });
+    device.coalesce({windowMs: 10000, maxFrames: 2});
+    device.enableEvents(true);
+
+    emit(uinput, moves([1, 1, 1, 1]));
+    await waitFor(() => deltas.length >= 2);
+    await sleep(20);
+    assert.deepStrictEqual(deltas, [2, 2]);
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+run();
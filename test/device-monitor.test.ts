@@ -0,0 +1,46 @@
+import * as assert from 'assert';
+import { Device, Evdev } from '../lib/index';
+import { requireUInput, run, test, waitFor } from './harness';
+
+const NAME = 'evdevjs test hotplug';
+
+test('watchDevices() emits plugged and unplugged devices', async () => {
+  requireUInput();
+
+  const watcher = new Evdev();
+  const creator = new Evdev();
+  try {
+    const added: Device[] = [];
+    const removed: Device[] = [];
+    watcher.on('device-added', (device: Device) => {
+      if (device.name === NAME) added.push(device);
+    });
+    watcher.on('device-removed', (device: Device) => {
+      if (added.includes(device)) removed.push(device);
+    });
+    watcher.watchDevices('/dev/input', /event\d+$/);
+    assert.strictEqual(watcher.isWatchingDevices(), true);
+
+    const template = creator.newDevice();
+    template.name = NAME;
+    template.enableEventType('EV_MSC');
+    template.enableEventCode('EV_MSC', 'MSC_SCAN');
+    const uinput = creator.newUInputFromDevice(template);
+
+    await waitFor(() => added.length >= 1);
+    assert.strictEqual(added.length, 1);
+    assert.ok(added[0].file.startsWith('/dev/input/event'));
+
+    uinput.close();
+    await waitFor(() => removed.length >= 1);
+    assert.strictEqual(removed[0], added[0]);
+
+    watcher.unwatchDevices();
+    assert.strictEqual(watcher.isWatchingDevices(), false);
+  } finally {
+    watcher.close();
+    creator.close();
+  }
+});
+
+run();
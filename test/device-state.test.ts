@@ -0,0 +1,58 @@
+import * as assert from 'assert';
+import { DeviceState, Evdev, InputCodes } from '../lib/index';
+import { emit, openLoopback, run, test, waitFor } from './harness';
+
+const EV_SYN = InputCodes.getType('EV_SYN');
+const EV_KEY = InputCodes.getType('EV_KEY');
+const SYN_REPORT = InputCodes.getCode('SYN_REPORT');
+const KEY_A = InputCodes.getCode('KEY_A') as InputCodes.EV_KEY_CODE;
+const KEY_B = InputCodes.getCode('KEY_B') as InputCodes.EV_KEY_CODE;
+
+test('DeviceState reads its key and dirty bitmaps', () => {
+  const state = new DeviceState();
+  assert.strictEqual(state.isKeyDown(KEY_A), false);
+  assert.strictEqual(state.isChanged(), false);
+
+  state.keys[KEY_A >> 3] |= 1 << (KEY_A & 7);
+  state.dirty[KEY_A >> 3] |= 1 << (KEY_A & 7);
+  assert.strictEqual(state.isKeyDown(KEY_A), true);
+  assert.strictEqual(state.isKeyDown(KEY_B), false);
+  assert.strictEqual(state.isKeyChanged(KEY_A), true);
+  assert.strictEqual(state.isChanged(), true);
+});
+
+for (const events of [false, true]) {
+  test(`getState() tracks pressed keys${events ? ', events enabled' : ''}`, async () => {
+    const evdev = new Evdev();
+    const {uinput, device} = await openLoopback(evdev, 'evdevjs test state', [
+      ['EV_KEY', 'KEY_A'], ['EV_KEY', 'KEY_B'],
+    ]);
+    try {
+      let seen = 0;
+      if (events) {
+        device.on('event', () => seen++);
+        device.enableEvents(true);
+      }
+
+      emit(uinput, [EV_KEY, KEY_A, 1, EV_SYN, SYN_REPORT, 0]);
+      const state = new DeviceState();
+      await waitFor(() => device.getState(state).isKeyDown(KEY_A));
+      assert.strictEqual(state.isKeyDown(KEY_B), false);
+
+      emit(uinput, [EV_KEY, KEY_A, 0, EV_SYN, SYN_REPORT, 0]);
+      await waitFor(() => !device.getState(state).isKeyDown(KEY_A));
+      assert.strictEqual(state.isKeyChanged(KEY_A), true);
+      assert.strictEqual(device.getState(state).isChanged(), false);
+
+      if (events) {
+        // the snapshot does not steal events from the listeners
+        await waitFor(() => seen >= 4);
+      }
+    } finally {
+      uinput.close();
+      evdev.close();
+    }
+  });
+}
+
+run();
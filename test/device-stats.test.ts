@@ -0,0 +1,36 @@
+import * as assert from 'assert';
+import { Evdev } from '../lib/index';
+import { emit, openLoopback, run, scanFrames, test, waitFor } from './harness';
+
+for (const native of [false, true]) {
+  test(`getStats() counts the events read${native ? ', native reader' : ''}`, async () => {
+    const evdev = new Evdev();
+    const {uinput, device} = await openLoopback(evdev, 'evdevjs test stats');
+    try {
+      let seen = 0;
+      device.useNativeReader(native);
+      device.on('event', () => seen++);
+      device.filterEventType('EV_MSC');
+      device.enableEvents(true);
+
+      emit(uinput, scanFrames(5));
+      await waitFor(() => device.getStats().events >= 10);
+      await waitFor(() => seen >= 5);
+
+      const stats = device.getStats();
+      assert.strictEqual(stats.events, 10);
+      assert.strictEqual(stats.frames, 5);
+      assert.strictEqual(stats.dropped, 0);
+      // the SYN_REPORTs are filtered
+      assert.strictEqual(stats.discarded, 5);
+      assert.ok(stats.reads >= 1);
+      assert.strictEqual(seen, 5);
+      assert.strictEqual(evdev.getStats().get(device.file)!.events, 10);
+    } finally {
+      uinput.close();
+      evdev.close();
+    }
+  });
+}
+
+run();
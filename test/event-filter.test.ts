@@ -0,0 +1,99 @@
+import * as assert from 'assert';
+import { Evdev, Event, InputCodes } from '../lib/index';
+import { emit, openLoopback, run, sleep, test, waitFor } from './harness';
+
+const evdevjs = require('bindings')('evdevjs.node');
+
+const EV_SYN = InputCodes.getType('EV_SYN');
+const EV_KEY = InputCodes.getType('EV_KEY');
+const EV_MSC = InputCodes.getType('EV_MSC');
+const SYN_REPORT = InputCodes.getCode('SYN_REPORT');
+const KEY_A = InputCodes.getCode('KEY_A');
+const MSC_SCAN = InputCodes.getCode('MSC_SCAN');
+
+for (const native of [false, true]) {
+  test(`filterEventType() discards other types natively${native ? ', native reader' : ''}`, async () => {
+    const evdev = new Evdev();
+    const {uinput, device} = await openLoopback(evdev, 'evdevjs test filter', [
+      ['EV_KEY', 'KEY_A'], ['EV_MSC', 'MSC_SCAN'],
+    ]);
+    try {
+      const types: number[] = [];
+      device.useNativeReader(native);
+      device.on('event', (event: Event) => types.push(event.type));
+      device.filterEventType('EV_KEY');
+      device.enableEvents(true);
+
+      emit(uinput, [
+        EV_MSC, MSC_SCAN, 1, EV_KEY, KEY_A, 1, EV_SYN, SYN_REPORT, 0,
+        EV_MSC, MSC_SCAN, 2, EV_KEY, KEY_A, 0, EV_SYN, SYN_REPORT, 0,
+      ]);
+      await waitFor(() => types.length >= 2);
+
+      assert.deepStrictEqual(types, [EV_KEY, EV_KEY]);
+      // libevdev still tracked the filtered events
+      assert.strictEqual(device.getState().isKeyDown(KEY_A as InputCodes.EV_KEY_CODE), false);
+
+      device.clearEventFilter();
+      emit(uinput, [EV_MSC, MSC_SCAN, 3, EV_SYN, SYN_REPORT, 0]);
+      await waitFor(() => types.length >= 4);
+      assert.deepStrictEqual(types.slice(2), [EV_MSC, EV_SYN]);
+    } finally {
+      uinput.close();
+      evdev.close();
+    }
+  });
+}
+
+test('the filter derived from typed listeners keeps their types', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test typed filter', [
+    ['EV_KEY', 'KEY_A'], ['EV_MSC', 'MSC_SCAN'],
+  ]);
+  try {
+    const keys: number[] = [];
+    let others = 0;
+    device.publishTypedEvents(true);
+    device.on('EV_KEY', (event: Event) => keys.push(event.value));
+    device.on('EV_SYN', () => others++);
+    device.enableEvents(true);
+    // the derived filter is applied in a microtask
+    await Promise.resolve();
+
+    emit(uinput, [
+      EV_MSC, MSC_SCAN, 1, EV_KEY, KEY_A, 1, EV_SYN, SYN_REPORT, 0,
+    ]);
+    await waitFor(() => keys.length >= 1 && others >= 1);
+    assert.deepStrictEqual(keys, [1]);
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+test('NextEvent() returns null once only filtered events are pending', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test filter next', [
+    ['EV_KEY', 'KEY_A'], ['EV_MSC', 'MSC_SCAN'],
+  ]);
+  try {
+    device.filterEventType('EV_KEY');
+    assert.strictEqual(evdevjs.NextEvent(device.id), null);
+
+    // the device fd is blocking, skipping these must not wait for more
+    emit(uinput, [EV_MSC, MSC_SCAN, 1, EV_SYN, SYN_REPORT, 0]);
+    await sleep(20);
+    assert.strictEqual(evdevjs.NextEvent(device.id), null);
+
+    emit(uinput, [EV_KEY, KEY_A, 1, EV_SYN, SYN_REPORT, 0]);
+    await sleep(20);
+    const event: Event = evdevjs.NextEvent(device.id);
+    assert.strictEqual(event.type, EV_KEY);
+    assert.strictEqual(event.value, 1);
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+run();
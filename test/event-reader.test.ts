@@ -0,0 +1,64 @@
+import * as assert from 'assert';
+import { Evdev, Event, InputCodes } from '../lib/index';
+import { EventReader } from '../lib/event-reader';
+import { emit, openLoopback, run, scanFrames, test, waitFor } from './harness';
+
+const EV_MSC = InputCodes.getType('EV_MSC');
+
+test('the native reader publishes the device events', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test native reader');
+  try {
+    const scans: number[] = [];
+    device.on('event', (event: Event) => {
+      if (event.type === EV_MSC) scans.push(event.value);
+    });
+    device.useNativeReader(true);
+    device.enableEvents(true);
+    assert.ok(device.isUsingNativeReader());
+
+    emit(uinput, scanFrames(20));
+    await waitFor(() => scans.length >= 20);
+
+    // switching readers while enabled loses no events
+    device.useNativeReader(false);
+    emit(uinput, scanFrames(20, 21));
+    await waitFor(() => scans.length >= 40);
+    assert.deepStrictEqual(scans, Array.from({length: 40}, (_, i) => i + 1));
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+test('EventReader delivers packed records and reports an unplugged device', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test reader unplug');
+  let unplugged = false;
+  const batches: (Int32Array | null)[] = [];
+  const reader = new EventReader((devId, records) => {
+    assert.strictEqual(devId, device.id);
+    batches.push(records);
+  });
+  try {
+    assert.ok(reader.add(device));
+
+    emit(uinput, scanFrames(3));
+    await waitFor(() => batches.some(records => records !== null &&
+      records.length >= 6 * Event.RECORD_SIZE));
+
+    const records = batches[0]!;
+    assert.strictEqual(records[2], EV_MSC);
+    assert.strictEqual(records[4], 1);
+
+    uinput.close();
+    unplugged = true;
+    await waitFor(() => batches.includes(null));
+  } finally {
+    reader.close();
+    if (!unplugged) uinput.close();
+    evdev.close();
+  }
+});
+
+run();
@@ -0,0 +1,71 @@
+import * as assert from 'assert';
+import { Evdev, Event, EventRing, InputCodes } from '../lib/index';
+import { emit, openLoopback, run, scanFrames, test, waitFor } from './harness';
+
+const EV_MSC = InputCodes.getType('EV_MSC');
+
+// header slots, see lib/event-ring.ts
+const HEAD = 0;
+const TAIL = 1;
+const HEADER_SIZE = 8;
+
+// write events to ring as the native producer does, values numbered from first
+function produce(ring: EventRing, count: number, first: number): void {
+  const array = ring.array;
+  const head = Atomics.load(array, HEAD);
+  for (let i = 0; i < count; i++) {
+    const offset = HEADER_SIZE + ((head + i) & (ring.capacity - 1)) * Event.RECORD_SIZE;
+    array.set([0, 0, EV_MSC, 4, first + i], offset);
+  }
+  Atomics.store(array, HEAD, (head + count) | 0);
+}
+
+test('EventRing rounds its capacity up to a power of 2', () => {
+  assert.strictEqual(EventRing.create(1).capacity, 1);
+  assert.strictEqual(EventRing.create(100).capacity, 128);
+  assert.strictEqual(EventRing.create(128).capacity, 128);
+});
+
+test('EventRing reads and consumes across the end of the ring', () => {
+  const ring = EventRing.create(8);
+  // positions wrap at 2^32
+  Atomics.store(ring.array, HEAD, -3);
+  Atomics.store(ring.array, TAIL, -3);
+
+  produce(ring, 6, 1);
+  assert.strictEqual(ring.available, 6);
+
+  const records = new Int32Array(4 * Event.RECORD_SIZE);
+  assert.strictEqual(ring.read(records), 4);
+  assert.deepStrictEqual([0, 1, 2, 3].map(i => records[i * Event.RECORD_SIZE + 4]), [1, 2, 3, 4]);
+
+  produce(ring, 5, 7);
+  const values: number[] = [];
+  assert.strictEqual(ring.consume((array, offset) => values.push(array[offset + 4]), 6), 6);
+  assert.deepStrictEqual(values, [5, 6, 7, 8, 9, 10]);
+  assert.strictEqual(ring.available, 1);
+  assert.strictEqual(ring.overflows, 0);
+});
+
+test('openEventRing() receives the device events', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test ring');
+  try {
+    const ring = device.openEventRing(64);
+    emit(uinput, scanFrames(3));
+    await waitFor(() => ring.available >= 6);
+
+    const scans: number[] = [];
+    ring.consume((records, offset) => {
+      if (records[offset + 2] === EV_MSC) scans.push(records[offset + 4]);
+    });
+    assert.deepStrictEqual(scans, [1, 2, 3]);
+    assert.strictEqual(ring.available, 0);
+    assert.strictEqual(ring.overflows, 0);
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+run();
@@ -0,0 +1,161 @@
+import * as assert from 'assert';
+import { Evdev, Event, EventRing, EventStream, InputCodes } from '../lib/index';
+import { emit, LoopbackCode, openLoopback, run, scanFrames, test, waitFor } from './harness';
+
+const EV_SYN = InputCodes.getType('EV_SYN');
+const EV_MSC = InputCodes.getType('EV_MSC');
+const EV_REL = InputCodes.getType('EV_REL');
+const SYN_REPORT = InputCodes.getCode('SYN_REPORT');
+const REL_X = InputCodes.getCode('REL_X');
+
+// header slots, see lib/event-ring.ts
+const HEAD = 0;
+const TAIL = 1;
+
+// the MSC_SCAN values of the events of the next batches of stream, until count
+async function nextScans(stream: EventStream, count: number): Promise<number[]> {
+  const scans: number[] = [];
+  for await (const events of stream) {
+    events.forEach((event: Event) => {
+      if (event.type === EV_MSC) scans.push(event.value);
+    });
+    if (scans.length >= count) break;
+  }
+  return scans;
+}
+
+test('EventRing keeps its overflow policy in its header', () => {
+  assert.strictEqual(EventRing.create(4).overflow, 'dropNewest');
+  for (const policy of ['dropNewest', 'block', 'dropOldest', 'coalesce'] as const) {
+    const ring = EventRing.create(4, policy);
+    assert.strictEqual(ring.overflow, policy);
+    assert.strictEqual(new EventRing(ring.buffer).overflow, policy);
+  }
+  assert.throws(() => EventRing.create(4, 'dropAll' as any));
+});
+
+test('EventRing.wait() only waits on an empty ring', () => {
+  const ring = EventRing.create(4);
+  assert.strictEqual(ring.wait(), true);
+  Atomics.store(ring.array, HEAD, 1);
+  assert.strictEqual(ring.wait(), false);
+});
+
+test('EventRing.consume() leaves tail moved by a dropOldest producer', () => {
+  const ring = EventRing.create(4, 'dropOldest');
+  Atomics.store(ring.array, HEAD, 4);
+
+  let visited = 0;
+  ring.consume(() => {
+    // the producer overwrites the oldest 3 events as the first is visited
+    if (visited++ === 0) {
+      Atomics.store(ring.array, HEAD, 7);
+      Atomics.store(ring.array, TAIL, 3);
+    }
+  }, 2);
+  assert.strictEqual(Atomics.load(ring.array, TAIL), 3);
+
+  ring.consume(() => {}, 2);
+  assert.strictEqual(Atomics.load(ring.array, TAIL), 5);
+});
+
+test('events() iterates the device events in batches', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test stream');
+  try {
+    const stream = device.events({batch: 4});
+    emit(uinput, scanFrames(3));
+
+    let batches = 0;
+    const scans: number[] = [];
+    for await (const events of stream) {
+      batches++;
+      assert.ok(events.length <= 4);
+      events.forEach((event: Event) => {
+        if (event.type === EV_MSC) scans.push(event.value);
+      });
+      if (scans.length === 3) break;
+    }
+    assert.deepStrictEqual(scans, [1, 2, 3]);
+    assert.ok(batches >= 2);
+    assert.ok(stream.done);
+    assert.strictEqual(stream.dropped, 0);
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+for (const [overflow, expected] of [['dropNewest', [1, 2]], ['dropOldest', [4, 5]]] as const) {
+  test(`events() with ${overflow} keeps the ${overflow === 'dropNewest' ? 'oldest' : 'newest'} events`, async () => {
+    const evdev = new Evdev();
+    const {uinput, device} = await openLoopback(evdev, `evdevjs test ${overflow}`);
+    try {
+      const stream = device.events({highWaterMark: 4, overflow});
+      emit(uinput, scanFrames(5));
+      await waitFor(() => stream.dropped >= 6);
+
+      assert.deepStrictEqual(await nextScans(stream, 2), expected);
+      assert.strictEqual(stream.dropped, 6);
+    } finally {
+      uinput.close();
+      evdev.close();
+    }
+  });
+}
+
+test('events() with block reads on as the consumer makes room', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test block');
+  try {
+    const stream = device.events({highWaterMark: 4, batch: 2, overflow: 'block'});
+    emit(uinput, scanFrames(5));
+    // libevdev read all the events, the ring took 4
+    await waitFor(() => stream.ring.blocked);
+
+    let timer: NodeJS.Timeout | undefined;
+    const stalled = new Promise<number[]>((_, reject) => {
+      timer = setTimeout(() => reject(new Error('stream stalled')), 2000);
+    });
+    try {
+      assert.deepStrictEqual(await Promise.race([nextScans(stream, 5), stalled]), [1, 2, 3, 4, 5]);
+    } finally {
+      clearTimeout(timer);
+    }
+    assert.strictEqual(stream.dropped, 0);
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+test('events() with coalesce merges the motion that does not fit', async () => {
+  const evdev = new Evdev();
+  const mouse: LoopbackCode[] = [['EV_REL', 'REL_X'], ['EV_REL', 'REL_Y']];
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test coalesce stream', mouse);
+  try {
+    const stream = device.events({highWaterMark: 4, overflow: 'coalesce'});
+    for (let i = 0; i < 5; i++) emit(uinput, [EV_REL, REL_X, 1, EV_SYN, SYN_REPORT, 0]);
+    // the consumer lags until every frame was read
+    await waitFor(() => device.getStats().events >= 10);
+
+    let motion = 0;
+    let frames = 0;
+    for await (const events of stream) {
+      events.forEach((event: Event) => {
+        if (event.type === EV_REL) motion += event.value;
+        if (event.type === EV_SYN) frames++;
+      });
+      if (motion >= 5) break;
+    }
+    assert.strictEqual(motion, 5);
+    // the frames that did not fit were merged
+    assert.ok(frames < 5, `${frames} frames`);
+    assert.strictEqual(stream.dropped, 0);
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+run();
@@ -0,0 +1,100 @@
+import * as assert from 'assert';
+import { Event, EventBatch, EventView } from '../lib/index';
+import { run, test } from './harness';
+
+const EV_KEY = 0x01;
+const EV_REL = 0x02;
+
+const RECORDS = Int32Array.from([
+  10, 500, EV_KEY, 30, 1,
+  11, 999999, EV_REL, 0, -4,
+  // tv_sec past 2^31, as the kernel's unsigned seconds
+  -1, 1, EV_REL, 1, 7,
+]);
+
+// the same records, each tagged with the device id 5, 6, 7
+const TAGGED = Int32Array.from([
+  5, ...RECORDS.subarray(0, 5),
+  6, ...RECORDS.subarray(5, 10),
+  7, ...RECORDS.subarray(10, 15),
+]);
+
+test('EventView reads a record in place', () => {
+  const view = new EventView(RECORDS);
+  assert.strictEqual(view.at(1), view);
+  assert.strictEqual(view.offset, 5);
+  assert.strictEqual(view.type, EV_REL);
+  assert.strictEqual(view.code, 0);
+  assert.strictEqual(view.value, -4);
+  assert.strictEqual(view.tag, 0);
+  assert.strictEqual(view.timeUs, 11999999);
+  assert.deepStrictEqual(view.time, {tv_sec: 11, tv_usec: 999999});
+
+  assert.strictEqual(view.at(2).timeUs, 4294967295 * 1000000 + 1);
+});
+
+test('EventView reads tagged records with their stride', () => {
+  const view = new EventView(TAGGED, Event.TAGGED_RECORD_SIZE);
+  assert.strictEqual(view.offset, 1);
+  assert.strictEqual(view.tag, 5);
+  assert.strictEqual(view.value, 1);
+
+  view.at(2);
+  assert.strictEqual(view.offset, 13);
+  assert.strictEqual(view.tag, 7);
+  assert.strictEqual(view.code, 1);
+  assert.strictEqual(view.value, 7);
+
+  view.reset(TAGGED.subarray(Event.TAGGED_RECORD_SIZE));
+  assert.strictEqual(view.tag, 6);
+  assert.strictEqual(view.value, -4);
+});
+
+test('EventView.toEvent() copies the event', () => {
+  const records = RECORDS.slice();
+  const event = new EventView(records).at(0).toEvent();
+  records.fill(0);
+  assert.deepStrictEqual(event, Event.fromRecord(RECORDS, 0));
+});
+
+test('EventBatch visits its events with one cursor', () => {
+  const batch = new EventBatch(RECORDS, 2);
+  assert.strictEqual(batch.count, 2);
+  assert.strictEqual(batch.at(0), batch.at(1));
+
+  const values: number[] = [];
+  batch.forEach((event, idx) => values.push(idx, event.value));
+  assert.deepStrictEqual(values, [0, 1, 1, -4]);
+
+  const views = new Set<EventView>();
+  const types: number[] = [];
+  for (const event of batch) {
+    views.add(event);
+    types.push(event.type);
+  }
+  assert.deepStrictEqual(types, [EV_KEY, EV_REL]);
+  assert.strictEqual(views.size, 1);
+
+  batch.reset(RECORDS.subarray(10), 1);
+  assert.deepStrictEqual([...batch].map(event => event.value), [7]);
+});
+
+test('EventBatch iterates with a single result object', () => {
+  const batch = new EventBatch(RECORDS, 2);
+  const iterator = batch[Symbol.iterator]();
+  const first = iterator.next();
+  assert.strictEqual(first.value.value, 1);
+  const second = iterator.next();
+  assert.strictEqual(second, first);
+  assert.strictEqual(second.value.value, -4);
+  assert.strictEqual(iterator.next().done, true);
+});
+
+test('EventBatch.toEvents() copies tagged events', () => {
+  const batch = new EventBatch(TAGGED, 3, Event.TAGGED_RECORD_SIZE);
+  const events = batch.toEvents();
+  assert.deepStrictEqual(events, [0, 1, 2].map(i => Event.fromRecord(RECORDS, i)));
+  assert.deepStrictEqual(events.map(event => event.value), [1, -4, 7]);
+});
+
+run();
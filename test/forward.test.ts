@@ -0,0 +1,65 @@
+import * as assert from 'assert';
+import { Evdev, Event, InputCodes, RemapRule } from '../lib/index';
+import { emit, LoopbackCode, openLoopback, run, test, waitFor } from './harness';
+
+const EV_SYN = InputCodes.getType('EV_SYN');
+const EV_KEY = InputCodes.getType('EV_KEY');
+const SYN_REPORT = InputCodes.getCode('SYN_REPORT');
+const KEY_A = InputCodes.getCode('KEY_A');
+const KEY_B = InputCodes.getCode('KEY_B');
+const KEY_F12 = InputCodes.getCode('KEY_F12');
+
+const KEYS: LoopbackCode[] = [['EV_KEY', 'KEY_A'], ['EV_KEY', 'KEY_B'], ['EV_KEY', 'KEY_F12']];
+
+test('RemapRule.resolve() fills in names and defaults', () => {
+  assert.deepStrictEqual(RemapRule.resolve({type: 'EV_KEY', code: 'KEY_A', toCode: 'KEY_B'}), {
+    type: EV_KEY, code: KEY_A, toType: EV_KEY, toCode: KEY_B,
+    scale: 1, offset: 0, invert: false, drop: false, notify: false
+  });
+  assert.deepStrictEqual(RemapRule.resolve({type: EV_KEY, code: KEY_F12, drop: true, notify: true}), {
+    type: EV_KEY, code: KEY_F12, toType: EV_KEY, toCode: KEY_F12,
+    scale: 1, offset: 0, invert: false, drop: true, notify: true
+  });
+});
+
+test('forward() remaps events to a uinput device natively', async () => {
+  const evdev = new Evdev();
+  const source = await openLoopback(evdev, 'evdevjs test forward source', KEYS);
+  const sink = await openLoopback(evdev, 'evdevjs test forward sink', KEYS);
+  try {
+    const forwarded: number[][] = [];
+    sink.device.on('event', (event: Event) => {
+      if (event.type === EV_KEY) forwarded.push([event.code, event.value]);
+    });
+    sink.device.enableEvents(true);
+
+    const notified: number[] = [];
+    source.device.on('event', (event: Event) => {
+      if (event.type === EV_KEY) notified.push(event.code);
+    });
+    source.device.forward(sink.uinput, [
+      {type: 'EV_KEY', code: 'KEY_A', toCode: 'KEY_B'},
+      {type: 'EV_KEY', code: 'KEY_F12', drop: true, notify: true},
+    ]);
+    assert.strictEqual(source.device.isForwarding(), true);
+
+    emit(source.uinput, [
+      EV_KEY, KEY_A, 1, EV_SYN, SYN_REPORT, 0,
+      EV_KEY, KEY_A, 0, EV_SYN, SYN_REPORT, 0,
+      EV_KEY, KEY_F12, 1, EV_SYN, SYN_REPORT, 0,
+    ]);
+    await waitFor(() => forwarded.length >= 2 && notified.length >= 1);
+
+    assert.deepStrictEqual(forwarded, [[KEY_B, 1], [KEY_B, 0]]);
+    assert.deepStrictEqual(notified, [KEY_F12]);
+
+    source.device.stopForwarding();
+    assert.strictEqual(source.device.isForwarding(), false);
+  } finally {
+    source.uinput.close();
+    sink.uinput.close();
+    evdev.close();
+  }
+});
+
+run();
@@ -0,0 +1,101 @@
+import * as assert from 'assert';
+import { Evdev, Event, Frame, InputCodes, TouchFrame } from '../lib/index';
+import { emit, openLoopback, run, test, waitFor } from './harness';
+
+const EV_SYN = InputCodes.getType('EV_SYN');
+const EV_MSC = InputCodes.getType('EV_MSC');
+const SYN_REPORT = InputCodes.getCode('SYN_REPORT');
+const MSC_SCAN = InputCodes.getCode('MSC_SCAN');
+
+test('Frame.forEach() splits packed frames', () => {
+  const frames = Int32Array.from([
+    0, 2,
+      1, 10, EV_MSC, MSC_SCAN, 7,
+      1, 10, EV_SYN, SYN_REPORT, 0,
+    Frame.FLAG_RESYNC, 1,
+      2, 20, EV_SYN, SYN_REPORT, 0,
+    // past length, not visited
+    0, 0,
+  ]);
+
+  const visited: Frame[] = [];
+  Frame.forEach(frames, frames.length - Frame.HEADER_SIZE, frame => visited.push(frame));
+
+  assert.strictEqual(visited.length, 2);
+  assert.strictEqual(visited[0].resync, false);
+  assert.strictEqual(visited[0].count, 2);
+  assert.deepStrictEqual(Event.fromRecord(visited[0].records, 0),
+    Event.fromRecord(Int32Array.from([1, 10, EV_MSC, MSC_SCAN, 7]), 0));
+  assert.strictEqual(visited[0].records.length, 2 * Event.RECORD_SIZE);
+  assert.strictEqual(visited[1].resync, true);
+  assert.strictEqual(visited[1].count, 1);
+  assert.strictEqual(visited[1].records[0], 2);
+});
+
+test('TouchFrame.forEach() splits packed touch frames', () => {
+  const {BEGIN, END, MOVED} = TouchFrame;
+  const frames = Int32Array.from([
+    0, 2, 5, 500,
+      0, 41, BEGIN | MOVED, 100, 200, 30, 4, 3,
+      1, 42, BEGIN | MOVED, 300, 400, 31, 5, 4,
+    TouchFrame.FLAG_RESYNC, 1, 5, 600,
+      0, 41, END, 110, 210, 0, 4, 3,
+    0, 0, 6, 0,
+  ]);
+
+  const visited: TouchFrame[] = [];
+  TouchFrame.forEach(frames, frames.length, frame => visited.push(frame));
+
+  assert.strictEqual(visited.length, 3);
+  assert.strictEqual(visited[0].resync, false);
+  assert.strictEqual(visited[0].sec, 5);
+  assert.strictEqual(visited[0].usec, 500);
+  assert.strictEqual(visited[0].count, 2);
+  const second = visited[0].contacts.subarray(TouchFrame.CONTACT_SIZE);
+  assert.strictEqual(second[TouchFrame.SLOT], 1);
+  assert.strictEqual(second[TouchFrame.ID], 42);
+  assert.strictEqual(second[TouchFrame.X], 300);
+  assert.strictEqual(second[TouchFrame.Y], 400);
+  assert.strictEqual(second[TouchFrame.PRESSURE], 31);
+  assert.strictEqual(second[TouchFrame.TOUCH_MINOR], 4);
+
+  assert.strictEqual(visited[1].resync, true);
+  assert.strictEqual(visited[1].contacts[TouchFrame.FLAGS], END);
+  assert.strictEqual(visited[2].count, 0);
+  assert.strictEqual(visited[2].contacts.length, 0);
+});
+
+for (const native of [false, true]) {
+  test(`publishFrames() emits a frame per SYN_REPORT${native ? ', native reader' : ''}`, async () => {
+    const evdev = new Evdev();
+    const {uinput, device} = await openLoopback(evdev, 'evdevjs test frames');
+    try {
+      const frames: number[][] = [];
+      device.publishFrames(true);
+      device.useNativeReader(native);
+      device.on('frame', (frame: Frame) => {
+        const scans: number[] = [];
+        for (let i = 0; i < frame.count; i++) {
+          const event = Event.fromRecord(frame.records, i);
+          if (event.type === EV_MSC) scans.push(event.value);
+        }
+        assert.strictEqual(frame.records[(frame.count - 1) * Event.RECORD_SIZE + 3], SYN_REPORT);
+        frames.push(scans);
+      });
+      device.enableEvents(true);
+
+      emit(uinput, [
+        EV_MSC, MSC_SCAN, 1, EV_MSC, MSC_SCAN, 2, EV_SYN, SYN_REPORT, 0,
+        EV_MSC, MSC_SCAN, 3, EV_SYN, SYN_REPORT, 0,
+      ]);
+      await waitFor(() => frames.length >= 2);
+
+      assert.deepStrictEqual(frames, [[1, 2], [3]]);
+    } finally {
+      uinput.close();
+      evdev.close();
+    }
+  });
+}
+
+run();
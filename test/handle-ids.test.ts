@@ -0,0 +1,15 @@
+import * as assert from 'assert';
+import { HandleIds } from '../lib/handle-ids';
+import { run, test } from './harness';
+
+test('HandleIds reuses the lowest released id', () => {
+  const ids = new HandleIds();
+  assert.deepStrictEqual([ids.allocate(), ids.allocate(), ids.allocate(), ids.allocate()], [1, 2, 3, 4]);
+
+  ids.release(3);
+  ids.release(1);
+  ids.release(3);
+  assert.deepStrictEqual([ids.allocate(), ids.allocate(), ids.allocate()], [1, 3, 5]);
+});
+
+run();
@@ -0,0 +1,132 @@
+// Minimal test runner for the test/*.test.ts scripts: each script
+// registers its tests with test() and runs them with run(). A test that
+// needs hardware access throws Skip when it is unavailable.
+
+import * as fs from 'fs';
+import { Device, Evdev, Event, InputCodes } from '../lib/index';
+import { UInput } from '../lib/uinput';
+
+export type TestFn = () => void | Promise<void>;
+
+export class Skip extends Error {}
+
+const OPEN_TIMEOUT_MS = 2000;
+
+const tests: [string, TestFn][] = [];
+
+export function test(name: string, fn: TestFn): void {
+  tests.push([name, fn]);
+}
+
+export async function run(): Promise<void> {
+  let failed = 0;
+
+  for (const [name, fn] of tests) {
+    try {
+      await fn();
+      console.log(`ok - ${name}`);
+    } catch (err) {
+      if (err instanceof Skip) {
+        console.log(`ok - ${name} # SKIP ${err.message}`);
+        continue;
+      }
+      failed++;
+      console.log(`not ok - ${name}`);
+      console.log(err);
+    }
+  }
+
+  if (failed > 0) process.exitCode = 1;
+}
+
+export function sleep(ms: number): Promise<void> {
+  return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+/**
+ * Poll until done() or fail after timeoutMs.
+ */
+export async function waitFor(done: () => boolean, timeoutMs = OPEN_TIMEOUT_MS): Promise<void> {
+  const deadline = Date.now() + timeoutMs;
+  while (!done()) {
+    if (Date.now() > deadline) throw new Error('Timed out');
+    await sleep(5);
+  }
+}
+
+export type Loopback = {
+  uinput: UInput;
+  device: Device;
+}
+
+// [type, code] of the events a loopback device emits
+export type LoopbackCode = [InputCodes.EV_TYPE_NAME, InputCodes.EV_CODE_NAME];
+
+export const MSC_SCAN_CODES: LoopbackCode[] = [['EV_MSC', 'MSC_SCAN']];
+
+/**
+ * Throw Skip without read/write access to /dev/uinput.
+ */
+export function requireUInput(): void {
+  try {
+    fs.accessSync('/dev/uinput', fs.constants.R_OK | fs.constants.W_OK);
+  } catch (err) {
+    throw new Skip('no access to /dev/uinput');
+  }
+}
+
+/**
+ * A uinput device emitting codes, by default MSC_SCAN, and the Device
+ * reading it back. Skips the test without access to /dev/uinput.
+ */
+export async function openLoopback(evdev: Evdev, name: string, codes = MSC_SCAN_CODES): Promise<Loopback> {
+  requireUInput();
+
+  const template = evdev.newDevice();
+  template.name = name;
+  for (const [type, code] of codes) {
+    template.enableEventType(type);
+    template.enableEventCode(type, code);
+  }
+  const uinput = evdev.newUInputFromDevice(template);
+
+  // the uinput's node appears, and becomes accessible, asynchronously
+  const deadline = Date.now() + OPEN_TIMEOUT_MS;
+  while (true) {
+    try {
+      const file = uinput.file;
+      if (file) return {uinput, device: evdev.openDevice(file)};
+    } catch (err) {
+      if (Date.now() > deadline) throw err;
+    }
+    if (Date.now() > deadline) throw new Error('uinput device node did not appear');
+    await sleep(10);
+  }
+}
+
+/**
+ * Write [type, code, value] triples to uinput one event at a time.
+ */
+export function emit(uinput: UInput, events: number[]): void {
+  for (let i = 0; i + 2 < events.length; i += 3) {
+    uinput.writeEvent({
+      type: events[i] as InputCodes.EV_TYPE_CODE,
+      code: events[i + 1] as InputCodes.EV_CODE,
+      value: events[i + 2]
+    } as Event);
+  }
+}
+
+/**
+ * [type, code, value] triples of count MSC_SCAN frames numbered from first.
+ */
+export function scanFrames(count: number, first = 1): number[] {
+  const EV_SYN = InputCodes.getType('EV_SYN');
+  const EV_MSC = InputCodes.getType('EV_MSC');
+  const SYN_REPORT = InputCodes.getCode('SYN_REPORT');
+  const MSC_SCAN = InputCodes.getCode('MSC_SCAN');
+
+  const events: number[] = [];
+  for (let i = first; i < first + count; i++) events.push(EV_MSC, MSC_SCAN, i, EV_SYN, SYN_REPORT, 0);
+  return events;
+}
@@ -0,0 +1,85 @@
+import * as assert from 'assert';
+import { Evdev, Event, Hotkey, HotkeyMatch, InputCodes } from '../lib/index';
+import { emit, LoopbackCode, openLoopback, run, sleep, test, waitFor } from './harness';
+
+const EV_SYN = InputCodes.getType('EV_SYN');
+const EV_KEY = InputCodes.getType('EV_KEY');
+const SYN_REPORT = InputCodes.getCode('SYN_REPORT');
+const KEY_LEFTCTRL = InputCodes.getCode('KEY_LEFTCTRL');
+const KEY_K = InputCodes.getCode('KEY_K');
+const KEY_C = InputCodes.getCode('KEY_C');
+
+const KEYS: LoopbackCode[] = [['EV_KEY', 'KEY_LEFTCTRL'], ['EV_KEY', 'KEY_K'], ['EV_KEY', 'KEY_C']];
+
+// press and release code, each in its own frame
+function tap(code: number): number[] {
+  return [EV_KEY, code, 1, EV_SYN, SYN_REPORT, 0, EV_KEY, code, 0, EV_SYN, SYN_REPORT, 0];
+}
+
+test('Hotkey.resolve() lists the key codes of each step', () => {
+  assert.deepStrictEqual(Hotkey.resolve({chord: ['KEY_LEFTCTRL', 'KEY_K']}), [[KEY_LEFTCTRL, KEY_K]]);
+  assert.deepStrictEqual(Hotkey.resolve({sequence: ['KEY_C', ['KEY_LEFTCTRL', KEY_K as InputCodes.EV_KEY_CODE]]}),
+    [[KEY_C], [KEY_LEFTCTRL, KEY_K]]);
+});
+
+test('Hotkey.forEachMatch() splits packed matches', () => {
+  const matches = Int32Array.from([
+    3, 0, 2,
+      1, 10, EV_KEY, KEY_K, 1,
+      1, 10, EV_SYN, SYN_REPORT, 0,
+    0, 0, 1,
+      2, 20, EV_SYN, SYN_REPORT, 0,
+    // past length, not visited
+    9, 0, 0,
+  ]);
+
+  const visited: number[] = [];
+  Hotkey.forEachMatch(matches, matches.length - Hotkey.MATCH_HEADER_SIZE, (id, frame) => {
+    visited.push(id);
+    if (id === 3) {
+      assert.strictEqual(frame.count, 2);
+      assert.deepStrictEqual(Event.fromRecord(frame.records, 0).code, KEY_K);
+    } else {
+      assert.strictEqual(frame.count, 1);
+      assert.strictEqual(frame.records[0], 2);
+    }
+  });
+  assert.deepStrictEqual(visited, [3, 0]);
+});
+
+test('setHotkeys() publishes chord and sequence matches only', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test hotkeys', KEYS);
+  try {
+    const matches: string[] = [];
+    let events = 0;
+    device.on('event', () => events++);
+    device.on('hotkey', (match: HotkeyMatch) => {
+      assert.strictEqual(Event.fromRecord(match.frame.records, 0).value, 1);
+      matches.push(match.name);
+    });
+    device.setHotkeys(new Map<string, Hotkey>([
+      ['kill', {chord: ['KEY_LEFTCTRL', 'KEY_K']}],
+      ['copy', {sequence: ['KEY_C', 'KEY_C']}],
+    ]));
+    device.enableEvents(true);
+
+    // K alone is no chord
+    emit(uinput, tap(KEY_K));
+    emit(uinput, [EV_KEY, KEY_LEFTCTRL, 1, EV_SYN, SYN_REPORT, 0]);
+    emit(uinput, tap(KEY_K));
+    emit(uinput, [EV_KEY, KEY_LEFTCTRL, 0, EV_SYN, SYN_REPORT, 0]);
+    emit(uinput, tap(KEY_C));
+    emit(uinput, tap(KEY_C));
+    await waitFor(() => matches.length >= 2);
+    await sleep(20);
+
+    assert.deepStrictEqual(matches, ['kill', 'copy']);
+    assert.strictEqual(events, 0);
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+run();
@@ -0,0 +1,38 @@
+import * as assert from 'assert';
+import { InputCodes } from '../lib/index';
+import { run, test } from './harness';
+
+test('getCode() and getCodeName() round trip every declared code', () => {
+  for (const [typeKey, typeName] of Object.entries(InputCodes.EV_TYPE)) {
+    const type = Number(typeKey) as InputCodes.EV_TYPE_CODE;
+    assert.strictEqual(InputCodes.getType(typeName), type);
+    assert.strictEqual(InputCodes.getTypeName(type), typeName);
+
+    for (const [codeKey, codeName] of Object.entries(InputCodes.InputCodeMap.get(typeName) ?? {})) {
+      const code = Number(codeKey) as InputCodes.EV_CODE;
+      assert.strictEqual(InputCodes.getCodeName(type, code), codeName);
+      assert.strictEqual(InputCodes.getCode(codeName as InputCodes.EV_CODE_NAME), code);
+    }
+  }
+});
+
+test('getCode() resolves aliases', () => {
+  const aliases: [string, string][] = [
+    ['BTN_A', 'BTN_SOUTH'],
+    ['BTN_MISC', 'BTN_0'],
+    ['BTN_GAMEPAD', 'BTN_SOUTH'],
+    ['KEY_HANGUEL', 'KEY_HANGEUL'],
+  ];
+  for (const [alias, name] of aliases) {
+    const code = InputCodes.getCode(alias as InputCodes.EV_CODE_NAME);
+    assert.strictEqual(code, InputCodes.getCode(name as InputCodes.EV_CODE_NAME), alias);
+    assert.strictEqual(InputCodes.getCode(alias as InputCodes.EV_CODE_NAME), code, `${alias} cached`);
+  }
+});
+
+test('getCode() returns -1 for unknown names', () => {
+  assert.strictEqual(InputCodes.getCode('KEY_NOT_A_KEY' as InputCodes.EV_CODE_NAME), -1);
+  assert.strictEqual(InputCodes.getType('EV_NOT_A_TYPE' as InputCodes.EV_TYPE_NAME), -1);
+});
+
+run();
@@ -0,0 +1,32 @@
+import * as assert from 'assert';
+import { Evdev } from '../lib/index';
+import { openLoopback, run, test } from './harness';
+
+const evdevjs = require('bindings')('evdevjs.node');
+
+test('loadDevicesAsync() probes and adopts device nodes', async () => {
+  const creator = new Evdev();
+  const loader = new Evdev();
+  const {uinput, device} = await openLoopback(creator, 'evdevjs test probe');
+  try {
+    const file = device.file;
+    const devices = await loader.loadDevicesAsync('/dev/input', candidate => candidate === file);
+    assert.strictEqual(devices.length, 1);
+    assert.strictEqual(devices[0].file, file);
+    assert.strictEqual(devices[0].name, 'evdevjs test probe');
+    assert.ok(devices[0].fd > 0);
+
+    // loaded devices are not opened again
+    assert.deepStrictEqual(await loader.loadDevicesAsync('/dev/input', candidate => candidate === file), devices);
+  } finally {
+    uinput.close();
+    loader.close();
+    creator.close();
+  }
+});
+
+test('ProbeDevices() takes only paths', () => {
+  assert.throws(() => evdevjs.ProbeDevices(['/dev/input/event0', 0]), TypeError);
+});
+
+run();
@@ -0,0 +1,82 @@
+import * as assert from 'assert';
+import { Device, Evdev, Event, InputCodes } from '../lib/index';
+import { emit, openLoopback, run, scanFrames, test, waitFor } from './harness';
+
+const EV_MSC = InputCodes.getType('EV_MSC');
+const MSC_SCAN = InputCodes.getCode('MSC_SCAN');
+
+test('Event.fromTaggedRecord() skips the device id', () => {
+  const records = Int32Array.from([7, 1, 2, EV_MSC, MSC_SCAN, 3, 8, 4, 5, EV_MSC, MSC_SCAN, 6]);
+  const event = Event.fromTaggedRecord(records, 1);
+  assert.deepStrictEqual(event.time, {tv_sec: 4, tv_usec: 5});
+  assert.strictEqual(event.type, EV_MSC);
+  assert.strictEqual(event.code, MSC_SCAN);
+  assert.strictEqual(event.value, 6);
+});
+
+test('Evdev.enableEvents() multiplexes the events of all devices', async () => {
+  const evdev = new Evdev();
+  const first = await openLoopback(evdev, 'evdevjs test multiplex 1');
+  try {
+    const scans = new Map<Device, number[]>();
+    evdev.on('event', (event: Event, device: Device) => {
+      if (event.type !== EV_MSC) return;
+      if (!scans.has(device)) scans.set(device, []);
+      scans.get(device)!.push(event.value);
+    });
+    evdev.enableEvents(true, {sortByTime: true});
+
+    // devices opened later join the reader
+    const second = await openLoopback(evdev, 'evdevjs test multiplex 2');
+    try {
+      emit(first.uinput, scanFrames(10));
+      emit(second.uinput, scanFrames(10, 101));
+      await waitFor(() => (scans.get(first.device)?.length ?? 0) >= 10 &&
+        (scans.get(second.device)?.length ?? 0) >= 10);
+
+      assert.deepStrictEqual(scans.get(first.device), Array.from({length: 10}, (_, i) => i + 1));
+      assert.deepStrictEqual(scans.get(second.device), Array.from({length: 10}, (_, i) => i + 101));
+      assert.ok(!first.device.areEventsEnabled());
+    } finally {
+      second.uinput.close();
+    }
+  } finally {
+    first.uinput.close();
+    evdev.close();
+  }
+});
+
+test('A multiplexed device has no read path of its own', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test multiplex owner');
+  try {
+    device.enableEvents(true);
+    evdev.enableEvents(true);
+    assert.ok(device.isMultiplexed());
+    assert.ok(!device.areEventsEnabled());
+
+    assert.throws(() => device.enableEvents(true), /multiplexed/);
+    assert.throws(() => device.openEventRing(), /multiplexed/);
+    assert.throws(() => device.events(), /multiplexed/);
+    assert.throws(() => device.coalesce(), /multiplexed/);
+    assert.throws(() => device.setHotkeys(new Map()), /multiplexed/);
+
+    // stopping multiplexing restores the device's events
+    evdev.enableEvents(false);
+    assert.ok(!device.isMultiplexed());
+    assert.ok(device.areEventsEnabled());
+
+    const scans: number[] = [];
+    device.on('event', (event: Event) => {
+      if (event.type === EV_MSC) scans.push(event.value);
+    });
+    emit(uinput, scanFrames(3));
+    await waitFor(() => scans.length >= 3);
+    assert.deepStrictEqual(scans, [1, 2, 3]);
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+run();
@@ -0,0 +1,26 @@
+import * as assert from 'assert';
+import { Evdev, Event, InputCodes } from '../lib/index';
+import { emit, openLoopback, run, scanFrames, test, waitFor } from './harness';
+
+const EV_MSC = InputCodes.getType('EV_MSC');
+
+test('events written in one burst are all published, in order', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test drain');
+  try {
+    const scans: number[] = [];
+    device.on('event', (event: Event) => {
+      if (event.type === EV_MSC) scans.push(event.value);
+    });
+    device.enableEvents(true);
+
+    emit(uinput, scanFrames(50));
+    await waitFor(() => scans.length >= 50);
+    assert.deepStrictEqual(scans, Array.from({length: 50}, (_, i) => i + 1));
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+run();
@@ -34,7 +34,7 @@ function main(): void {
 
     console.log('stream created');
 
-    console.log('capabilities:', evdevjs.GetCapabilities(_fd));
+    console.log('capabilities:', evdevjs.GetCapabilityBits(_fd));
 
     console.log('typeName: ', InputCodes.getTypeName(0x01)); //"EV_KEY"
     console.log('type: ', InputCodes.getType("EV_KEY")); // 18
@@ -52,7 +52,7 @@ function test1() {
   let deviceInfo = evdevjs.NewLibevdev(fd);
   console.log('devinfo:', deviceInfo);
   
-  let caps = evdevjs.GetCapabilities(fd) ;
+  let caps = evdevjs.GetCapabilityBits(fd) ;
   console.log('capabilities:', caps);
   console.log('hasType(3)', evdevjs.HasType(fd, 3) );
   console.log('hasCode(3, 1)', evdevjs.HasCode(fd, 3,1) );
@@ -0,0 +1,73 @@
+import * as assert from 'assert';
+import { Evdev, Event, InputCodes, PlaybackResult } from '../lib/index';
+import { openLoopback, run, test, waitFor } from './harness';
+
+const EV_SYN = InputCodes.getType('EV_SYN');
+const EV_MSC = InputCodes.getType('EV_MSC');
+const SYN_REPORT = InputCodes.getCode('SYN_REPORT');
+const MSC_SCAN = InputCodes.getCode('MSC_SCAN');
+
+// scan frames 1..count, stepUs apart
+function scanRecords(count: number, stepUs: number): Int32Array {
+  const records: number[] = [];
+  for (let i = 1; i <= count; i++) {
+    const us = i * stepUs;
+    const sec = Math.floor(us / 1e6);
+    records.push(sec, us % 1e6, EV_MSC, MSC_SCAN, i);
+    records.push(sec, us % 1e6, EV_SYN, SYN_REPORT, 0);
+  }
+  return Int32Array.from(records);
+}
+
+test('play() replays records with their timing', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test player');
+  try {
+    const scans: number[] = [];
+    const times: number[] = [];
+    device.on('event', (event: Event) => {
+      if (event.type !== EV_MSC) return;
+      scans.push(event.value);
+      times.push(event.time!.tv_sec * 1e6 + event.time!.tv_usec);
+    });
+    device.enableEvents(true);
+
+    let result: PlaybackResult | undefined;
+    const player = uinput.play(scanRecords(5, 20000), r => result = r);
+    await waitFor(() => result !== undefined && scans.length >= 5);
+
+    assert.strictEqual(result!.completed, true);
+    assert.strictEqual(result!.events, 10);
+    assert.strictEqual(result!.errno, 0);
+    assert.strictEqual(player.isFinished(), true);
+    assert.deepStrictEqual(scans, [1, 2, 3, 4, 5]);
+    // kernel timestamps keep the 20ms intervals, give or take scheduling
+    assert.ok(times[4] - times[0] >= 60000, `spread ${times[4] - times[0]}us`);
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+test('cancel() ends playback once', async () => {
+  const evdev = new Evdev();
+  const {uinput} = await openLoopback(evdev, 'evdevjs test player cancel');
+  try {
+    const results: PlaybackResult[] = [];
+    const player = uinput.play(scanRecords(10, 1000000), r => results.push(r));
+    player.cancel();
+    player.cancel();
+    // no-ops once released
+    player.pause();
+    player.resume();
+    await waitFor(() => results.length >= 1);
+
+    assert.strictEqual(results[0].completed, false);
+    assert.strictEqual(player.isFinished(), true);
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+run();
@@ -0,0 +1,59 @@
+import * as assert from 'assert';
+import * as path from 'path';
+import { Worker } from 'worker_threads';
+import { Evdev } from '../lib/index';
+import { emit, openLoopback, run, scanFrames, test } from './harness';
+
+// adopts the transferred device and posts the MSC_SCAN values it reads
+const WORKER = `
+const { parentPort, workerData } = require('worker_threads');
+const { Evdev, InputCodes } = require(workerData.lib);
+const evdev = new Evdev();
+const device = evdev.adoptDevice(workerData.transfer);
+device.on('event', event => {
+  if (event.type === InputCodes.getType('EV_MSC')) parentPort.postMessage(event.value);
+});
+device.enableEvents(true);
+parentPort.on('message', () => {
+  evdev.close();
+  parentPort.close();
+});
+parentPort.postMessage('ready');
+`;
+
+test('a detached device is read by the worker adopting it', async () => {
+  const evdev = new Evdev();
+  const {uinput, device} = await openLoopback(evdev, 'evdevjs test worker');
+  try {
+    const file = device.file;
+    const transfer = device.detach();
+    assert.strictEqual(transfer.file, file);
+    assert.ok(!evdev.devices.includes(device));
+
+    const worker = new Worker(WORKER, {
+      eval: true,
+      workerData: {lib: path.join(__dirname, '../lib/index'), transfer},
+    });
+    const scans: number[] = [];
+    await new Promise<void>((resolve, reject) => {
+      worker.on('error', reject);
+      worker.on('message', message => {
+        if (message === 'ready') {
+          emit(uinput, scanFrames(3));
+          return;
+        }
+        scans.push(message);
+        if (scans.length === 3) resolve();
+      });
+    });
+    assert.deepStrictEqual(scans, [1, 2, 3]);
+
+    worker.postMessage('close');
+    await new Promise(resolve => worker.on('exit', resolve));
+  } finally {
+    uinput.close();
+    evdev.close();
+  }
+});
+
+run();
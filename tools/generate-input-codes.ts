@@ -5,6 +5,9 @@
 //      create an object <Type> = {code: codeName}
 // 3. create EV_TYPES {}
 // 4. create InputCodesMap = Map<EV_TYPE_NAME, Array<EV_CODE, EV_CODE_NAME>>
+//
+// With --cxx a C++ header of constexpr type and code name tables
+// (src/input-code-names.h) is generated instead.
 
 
 
@@ -26,10 +29,6 @@ const HEADER =
  * InputCodes were enerated by the evdevjs generate-input-codes script.
  */`;
 
-const IMPORTS =  `
-const evdevjs = require('bindings')('evdevjs.node');
-`;
-
  const OPEN_NAMESPACE = 
 `
 export namespace InputCodes {
@@ -38,21 +37,50 @@ export namespace InputCodes {
 const NAMESPACE_UTIL_FNS =
 `
 export const InputCodeMap = _InputCodeMap;
+
+// name lookup tables, built once from the declarations above
+const _TypeNames = new Array<EV_TYPE_NAME | undefined>();
+const _CodeNames = new Array<Array<EV_CODE_NAME | undefined> | undefined>();
+const _Types = new Map<string, EV_TYPE_CODE>();
+const _Codes = new Map<string, EV_CODE>();
+const _evdevjs = require('bindings')('evdevjs.node');
+
+for (const [typeKey, typeName] of Object.entries(EV_TYPE)) {
+  const type = Number(typeKey) as EV_TYPE_CODE;
+  _TypeNames[type] = typeName;
+  _Types.set(typeName, type);
+
+  const codeNames = new Array<EV_CODE_NAME | undefined>();
+  for (const [codeKey, codeName] of Object.entries(_InputCodeMap.get(typeName) ?? {})) {
+    const code = Number(codeKey) as EV_CODE;
+    codeNames[code] = codeName as EV_CODE_NAME;
+    if (!_Codes.has(codeName)) _Codes.set(codeName, code);
+  }
+  _CodeNames[type] = codeNames;
+}
  
 export function getTypeName(type: EV_TYPE_CODE): EV_TYPE_NAME {
-  return evdevjs.NameForType(type);
+  return _TypeNames[type] as EV_TYPE_NAME;
 }
 
 export function getType(typeName: EV_TYPE_NAME): EV_TYPE_CODE {
-  return evdevjs.TypeForName(typeName);
+  return (_Types.get(typeName) ?? -1) as EV_TYPE_CODE;
 }
 
+// aliases, e.g., BTN_A or KEY_HANGUEL, are not declared above: libevdev
+// resolves them, once per name
 export function getCode(codeName: EV_CODE_NAME): EV_CODE {
-  return evdevjs.CodeForName(codeName);
+  let code = _Codes.get(codeName);
+  if (code === undefined) {
+    code = _evdevjs.CodeForName(codeName) as EV_CODE;
+    if (code < 0) return -1 as EV_CODE;
+    _Codes.set(codeName, code);
+  }
+  return code;
 }
 
 export function getCodeName(type: EV_TYPE_CODE, code: EV_CODE): EV_CODE_NAME {
-  return evdevjs.NameForCode(type, code);
+  return _CodeNames[type]?.[code] as EV_CODE_NAME;
 }
 `;
 
@@ -162,12 +190,81 @@ function generateMap(types: Array<any>): string {
   return tscode;
 }
 
+const CXX_HEADER =
+`/*
+ * Event type and code names were generated by the evdevjs generate-input-codes script.
+ */
+
+#ifndef INPUT_CODE_NAMES_H_
+#define INPUT_CODE_NAMES_H_
+
+#include <cstdint>
+
+struct InputCodeName {
+  uint16_t code;
+  const char* name;
+};
+
+struct InputTypeNames {
+  uint16_t type;
+  const char* name;
+  const InputCodeName* codes;  // sorted by code
+  uint16_t count;
+  uint16_t first;              // index of codes[0] among all names
+};
+`;
+
+const CXX_FOOTER = `
+#endif  // INPUT_CODE_NAMES_H_
+`;
+
+function generateCxxNames(types: Array<any>): string {
+  // example output
+  // static constexpr InputCodeName EV_SYN_NAMES[] = {
+  //   {0, "SYN_REPORT"},
+  //   ...
+  // };
+  // static constexpr InputTypeNames INPUT_TYPE_NAMES[] = {
+  //   {0, "EV_SYN", EV_SYN_NAMES, 4, 10},
+  //   ...
+  // };
+
+  let cxxcode = '';
+  for (const type of types) {
+    cxxcode += `\nstatic constexpr InputCodeName ${type.name}_NAMES[] = {\n`;
+    const codes = type.codes;  // Array (code, codeName, code, codeName...)
+    for (let i=0; i < codes.length;) {
+      cxxcode += `  {${codes[i++]}, "${codes[i++]}"},\n`;
+    }
+    cxxcode += '};\n';
+  }
+
+  // type names occupy indices [0, INPUT_TYPE_COUNT), code names follow
+  let first = types.length;
+  cxxcode += `\nstatic constexpr uint16_t INPUT_TYPE_COUNT = ${types.length};\n`;
+  cxxcode += '\nstatic constexpr InputTypeNames INPUT_TYPE_NAMES[] = {\n';
+  for (const type of types) {
+    const count = type.codes.length / 2;
+    cxxcode += `  {${type.code}, "${type.name}", ${type.name}_NAMES, ${count}, ${first}},\n`;
+    first += count;
+  }
+  cxxcode += '};\n';
+  cxxcode += `\nstatic constexpr uint16_t INPUT_NAME_COUNT = ${first};\n`;
+
+  return cxxcode;
+}
+
 function main() {
   const types = evdevjs.GetTypesAndCodes() as Array<any>;
+
+  if (process.argv.includes('--cxx')) {
+    console.log(CXX_HEADER + generateCxxNames(types) + CXX_FOOTER);
+    return;
+  }
+
   const inputCodeContent = new Array<string>();
 
   inputCodeContent.push(HEADER);
-  inputCodeContent.push(IMPORTS);
   inputCodeContent.push(OPEN_NAMESPACE);
   inputCodeContent.push(generateEvTypeDeclarations(types));
   for (const type of types) {